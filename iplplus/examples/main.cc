@@ -37,61 +37,25 @@ Region loadImage(string filename) {
 
 
 /**
- * Converts toConvert from Region to Mat. (naive approach)
+ * Converts toConvert from Region to Mat, the pixels of the region become 1.
  */
 cv::Mat convertRegionToMat ( Region toConvert ) {
 
    cv::Mat ret(toConvert.boundingBox().height(), toConvert.boundingBox().width(), cv::DataType<unsigned char>::type);
-
-   for ( int i = 0; i < toConvert.boundingBox().height(); i++ )
-	   for ( int j = 0; j < toConvert.boundingBox().width(); j++ )
-		   ret.at<unsigned char>(i,j) = 0;
-
-   for ( auto & r : toConvert ) {
-	   for ( int i = r.start().x_; i < r.start().x_ + r.len(); ++i ) {
-		   ret.at<unsigned char>(r.start().y_ - toConvert.boundingBox().upperLeft().y_, i - toConvert.boundingBox().upperLeft().x_) = 1;
-	   }
-   }
+   toConvert.toMat(ret, toConvert.boundingBox().upperLeft(), 1, 0);
 
    return ret;
 }
 
 
 /**
- * Converts toConvert from Mat to Region. (naive approach)
- * Since Mat apparently doesn't take track of the image's origin, a region converted to
- * Mat and back to Region afterwards, will be translated by some vector.
+ * Converts toConvert from Mat to Region.
+ * Since Mat doesn't keep track of the image's origin, the pixel (0, 0) of the Mat
+ * becomes the point upperLeft of the Region.
  */
 Region convertMatToRegion ( cv::Mat toConvert, Point<N16> upperLeft ) {
 
-   Region ret;
-   bool runStarted = false;
-   int eroXstart;
-
-   for ( int i = 0; i < toConvert.rows; i++ ) {
-	   for ( int j = 0; j < toConvert.cols; j++ ) {
-		   if (toConvert.at<unsigned char>(i,j) == 0) {
-			   if (runStarted) {
-				   ret.add(Rbo(Point<N16>(eroXstart, i), j - eroXstart));
-			   }
-			   runStarted = false;
-		   } else if (j+1 == toConvert.cols) {
-			   if (runStarted) {
-				   ret.add(Rbo(Point<N16>(eroXstart, i), j - eroXstart + 1));
-			   }
-			   runStarted = false;
-	   	   } else {
-			   if (!runStarted) {
-				   eroXstart = j;
-			   }
-			   runStarted = true;
-	   	   }
-	   }
-   }
-
-   ret.translate(upperLeft);
-
-   return ret;
+   return Region::fromMat(toConvert, 1, 255, upperLeft);
 }
 
 
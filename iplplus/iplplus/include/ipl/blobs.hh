@@ -0,0 +1,150 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Header for ipl::Blobs
+ *
+ ********************************************************************/
+
+#ifndef IPL_BLOBS_HH
+#define IPL_BLOBS_HH
+
+#include "ipl/config.hh"
+
+#include <vector>
+
+#include "ipl/ipltypes.hh"
+#include "ipl/validable.hh"
+#include "ipl/point.hh"
+#include "ipl/region.hh"
+
+IPL_NS_BEGIN
+
+class Executor;
+
+//! The connected components of a Region.
+/*! The components are found on the Rbo's: two Rbo's in adjacent rows belong
+ * to the same blob, if they overlap (4-connectivity) or if they overlap or
+ * touch diagonally (8-connectivity). The Rbo's are merged with a union-find
+ * in one pass over the rows, so the time is linear in the number of Rbo's.
+ *
+ * The blobs are sorted by their first Rbo, i.e. by the topmost row and
+ * then the leftmost column of each blob:
+ * @code
+ * Region const reg(img, 128, 255);
+ * Blobs const blobs(reg.erode2cut(B), Blobs::Connect8);
+ * for (auto & b : blobs)
+ *     board.drawRegion(b);
+ * @endcode
+ * If only the partition is needed, labelRuns() yields the label of each
+ * Rbo without building the Regions.
+ */
+class Blobs : public Validable
+{
+public:
+    //! The neighbourhood of a pixel.
+    enum Connectivity {
+        //! the horizontal and vertical neighbours
+        Connect4 = 4,
+        //! the horizontal, vertical and diagonal neighbours
+        Connect8 = 8
+    };
+
+    //! Iterator over the blobs.
+    typedef std::vector<Region>::const_iterator Iterator;
+
+    /***********************************/
+    //! @name Constructors
+    //@{
+
+    //! ctr, no blobs.
+    Blobs();
+
+    //! ctr, the connected components of @a reg.
+    explicit Blobs(Region const & reg, Connectivity conn = Connect8);
+
+    //! ctr, the connected components of @a reg, labelled in parallel by @a ex.
+    /*! The rows are split into bands, which are labelled independently,
+     * afterwards the blobs are merged along the borders of the bands.
+     */
+    Blobs(Region const & reg, Connectivity conn, Executor & ex);
+    //@}
+
+    /***********************************/
+    //! @name Labelling of the Rbo's
+    //@{
+
+    //! Labels the Rbo's of @a reg.
+    /*! Assigns to the Rbo @em i of @a reg the number @a labels[i] of its
+     * blob, the blobs are numbered as in Blobs.
+     * @return the number of blobs
+     */
+    static N32 labelRuns(Region const & reg, std::vector<N32> & labels,
+                         Connectivity conn = Connect8);
+
+    //! @overload
+    static N32 labelRuns(Region const & reg, std::vector<N32> & labels,
+                         Connectivity conn, Executor & ex);
+    //@}
+
+    /***********************************/
+    //! @name Access
+    //@{
+
+    //! Iterator to the first blob.
+    Iterator begin() const {
+        return blobs_.begin();
+    }
+
+    //! Iterator behind the last blob.
+    Iterator end() const {
+        return blobs_.end();
+    }
+
+    //! Number of blobs.
+    N32 size() const {
+        return blobs_.size();
+    }
+
+    //! Check if there are no blobs.
+    bool empty() const {
+        return blobs_.empty();
+    }
+
+    //! The blob @a i.
+    Region const & operator[](N32 i) const {
+        return blobs_[i];
+    }
+
+    //! The labels of the Rbo's of the Region, see labelRuns().
+    std::vector<N32> const & labels() const {
+        return labels_;
+    }
+
+    //! The number of the blob including @a pt, -1 if there is none.
+    N32 find(PointN16 const & pt) const;
+    //@}
+
+    /***********************************/
+    //! @name Debug Output
+    //@{
+    std::ostream & print(std::ostream & os) const;
+    virtual bool validate() const;
+    //@}
+
+private:
+    //! Builds the blobs of @a reg from the labels.
+    void split(Region const & reg, N32 nrBlobs);
+
+    //! the blobs
+    std::vector<Region> blobs_;
+    //! the labels of the Rbo's
+    std::vector<N32> labels_;
+};
+
+IPL_NS_END
+
+#endif
@@ -0,0 +1,85 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Header for ipl::Executor
+ *
+ ********************************************************************/
+
+#ifndef IPL_EXECUTOR_HH
+#define IPL_EXECUTOR_HH
+
+#include "ipl/config.hh"
+
+#include <functional>
+#include <boost/scoped_ptr.hpp>
+#include <boost/noncopyable.hpp>
+
+#include "ipl/ipltypes.hh"
+
+IPL_NS_BEGIN
+
+class ExecutorImpl;
+
+//! A Pool of Threads for the parallel Algorithms.
+/*! The parallel algorithms of the library split their work into tasks and
+ * pass them to run(). The tasks are executed by the threads of the pool and
+ * by the calling thread, run() returns when all of them are finished.
+ *
+ * Usually the algorithms use the library-wide executor global(), but the
+ * caller may supply its own executor:
+ * @code
+ * Executor ex(4);
+ * Region const reg(img, 128, 255, ex);  // binarization with 4 threads
+ * Region const u = reg.unions(other);   // serial
+ * Region const v = reg.unions(other, Executor::global());
+ * @endcode
+ *
+ * run() may be called concurrently from several threads and also from
+ * within a task.
+ */
+class Executor : private boost::noncopyable
+{
+public:
+    //! ctr
+    /*! Creates an executor with @a nrThreads threads including the calling
+     * thread, i.e. it starts @a nrThreads - 1 threads. If @a nrThreads is 0
+     * the number of hardware threads is used.
+     */
+    explicit Executor(N32 nrThreads = 0);
+
+    //! dtr, waits for the threads
+    ~Executor();
+
+    //! Number of threads executing the tasks, including the calling thread.
+    N32 nrThreads() const;
+
+    //! Execute the tasks @a task(0), ..., @a task(@a nrTasks - 1).
+    /*! Blocks until all tasks are finished. If a task throws an exception,
+     * the remaining tasks are still executed and the first exception is
+     * rethrown.
+     */
+    void run(N32 nrTasks, std::function<void (N32)> const & task);
+
+    //! The library-wide executor.
+    /*! Is created on first use with the number of hardware threads.
+     */
+    static Executor & global();
+
+    //! Replace the library-wide executor by one with @a nrThreads threads.
+    /*! @warning The global executor must not be used by another thread
+     * during this call.
+     */
+    static void setGlobalThreads(N32 nrThreads);
+
+private:
+    //! the implementation
+    boost::scoped_ptr<ExecutorImpl> impl_;
+};
+
+IPL_NS_END
+
+#endif
@@ -0,0 +1,165 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Header for ipl::HybridRegion
+ *
+ ********************************************************************/
+
+#ifndef IPL_HYBRIDREGION_HH
+#define IPL_HYBRIDREGION_HH
+
+#include "ipl/config.hh"
+
+#include <vector>
+#include <cstddef>
+
+#include "ipl/ipltypes.hh"
+#include "ipl/validable.hh"
+#include "ipl/point.hh"
+#include "ipl/region.hh"
+
+IPL_NS_BEGIN
+
+template<typename T> class PictImg;
+
+//! A Region storing every row either as runs or as a bitmap.
+/*! Run-length coding is compact for blobby Regions, but on speckle noise
+ * the runs are one or two pixels long. Therefore every row is stored in the
+ * smaller of two forms:
+ *  - as runs, four bytes per run,
+ *  - as bitmap, one bit per pixel in 64 bit words aligned to multiples of 64
+ *    in x, from the first to the last word containing pixels of the row.
+ *
+ * The set operations combine rows of two bitmaps word by word and merge
+ * rows of two run lists; a run row meeting a bitmap row is converted to bits
+ * for this row. The form of each resulting row is chosen again.
+ * @code
+ * HybridRegion const a(img1, 128, 255), b(img2, 128, 255);  // noisy frames
+ * HybridRegion const both = a.intersect(b);
+ * Region const reg = both.region();
+ * @endcode
+ */
+class HybridRegion : public Validable
+{
+public:
+    /***********************************/
+    //! @name Constructors
+    //@{
+
+    //! ctr, an empty Region.
+    HybridRegion();
+
+    //! ctr, converts @a reg.
+    explicit HybridRegion(Region const & reg);
+
+    //! ctr, binarization of the roi of @a img with the thresholds [@a lo, @a hi].
+    /*! Same as <tt>HybridRegion(Region(img, lo, hi))</tt>, but only one
+     * row is held as Rbo's at a time.
+     */
+    HybridRegion(PictImg<UN8> const & img, N32 lo, N32 hi);
+    //@}
+
+    /***********************************/
+    //! @name Properties
+    //@{
+
+    //! The Region as ordinary Region.
+    Region const region() const;
+
+    //! Check if the Region is empty.
+    bool empty() const {
+        return rows_.empty();
+    }
+
+    //! Number of rows with pixels.
+    N32 nrRows() const {
+        return rows_.size();
+    }
+
+    //! Number of rows stored as bitmap.
+    N32 nrBitmapRows() const;
+
+    //! Number of pixels.
+    N32 area() const;
+
+    //! Number of bytes of the rows.
+    std::size_t size() const;
+
+    //! Check if the Region includes the Point @a pt.
+    bool includes(PointN16 const & pt) const;
+    //@}
+
+    /***********************************/
+    //! @name Set Operations
+    //@{
+
+    //! Union with @a other.
+    HybridRegion const unions(HybridRegion const & other) const;
+
+    //! Intersection with @a other.
+    HybridRegion const intersect(HybridRegion const & other) const;
+
+    //! Difference to @a other.
+    HybridRegion const subtract(HybridRegion const & other) const;
+    //@}
+
+    /***********************************/
+    //! @name Debug Output
+    //@{
+    std::ostream & print(std::ostream & os) const;
+    virtual bool validate() const;
+    //@}
+
+private:
+    //! A run [@a xs_, @a xe_] of a run row.
+    struct Run {
+        N16 xs_;
+        N16 xe_;
+    };
+
+    //! A row with pixels.
+    struct Row {
+        //! the row
+        N32 y_;
+        //! the first word of a bitmap row, noBitmap for a run row
+        N32 word0_;
+        //! index of the first run or word
+        UN32 first_;
+        //! number of runs or words
+        UN32 size_;
+    };
+
+    //! The set operations.
+    enum Op { Union, Intersection, Difference };
+
+    //! Implementation of the set operations.
+    HybridRegion const combine(HybridRegion const & other, Op op) const;
+
+    /*! @name Appending Rows.
+     * The rows must be appended in increasing order, the form of the row is
+     * chosen by its size.
+     */
+    //@{
+    //! Appends the row @a y with the runs [@a first, @a last).
+    void addRuns(N32 y, Run const * first, Run const * last);
+    //! Appends the row @a y with the bitmap [@a first, @a last) starting at word @a word0.
+    void addBits(N32 y, N32 word0, UN64 const * first, UN64 const * last);
+    //! Appends a copy of the row @a row of @a src.
+    void copyRow(HybridRegion const & src, Row const & row);
+    //@}
+
+    //! the rows with pixels, sorted by @a y_
+    std::vector<Row> rows_;
+    //! the runs of all run rows
+    std::vector<Run> runs_;
+    //! the words of all bitmap rows
+    std::vector<UN64> words_;
+};
+
+IPL_NS_END
+
+#endif
@@ -0,0 +1,177 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Header for ipl::LabelledRegion
+ *
+ ********************************************************************/
+
+#ifndef IPL_LABELLEDREGION_HH
+#define IPL_LABELLEDREGION_HH
+
+#include "ipl/config.hh"
+
+#include <vector>
+
+#include "ipl/ipltypes.hh"
+#include "ipl/validable.hh"
+#include "ipl/rbo.hh"
+#include "ipl/region.hh"
+
+IPL_NS_BEGIN
+
+class Blobs;
+
+//! Several objects in one run length encoding.
+/*! Each Rbo carries the label of its object, so Rbo's of different objects
+ * may touch without being merged. The Rbo's are sorted like the Rbo's of a
+ * Region, adjacent Rbo's of the same label are merged.
+ *
+ * The morphological operations treat every object on its own, but do all
+ * of them in one pass over the rows, which avoids the setup of one call per
+ * object:
+ * @code
+ * LabelledRegion const objects(Blobs(reg, Blobs::Connect8));
+ * LabelledRegion const grown = objects.dilate(B);
+ * for (N32 i = 0; i < grown.nrLabels(); ++i)
+ *     board.drawRegion(grown.region(i));
+ * @endcode
+ */
+class LabelledRegion : public Validable
+{
+public:
+    //! Owner of a pixel reached by the dilations of several objects.
+    /*! In any case a pixel keeps its label, if it is one of those reaching
+     * it.
+     */
+    enum Conflict {
+        //! the pixel stays background, which keeps the objects apart
+        ConflictSeparate,
+        //! the pixel belongs to the lowest label reaching it
+        ConflictLowestLabel
+    };
+
+    //! Iterator over the Rbo's.
+    typedef Region::RboIterator RboIterator;
+
+    /***********************************/
+    //! @name Constructors
+    //@{
+
+    //! ctr, no objects.
+    LabelledRegion();
+
+    //! ctr, the blob @em i with label @em i, nrLabels() is the number of blobs.
+    explicit LabelledRegion(Blobs const & blobs);
+
+    //! ctr, the Region @a regions[i] with label @em i.
+    /*! Where the Regions overlap, the lowest label wins. nrLabels() is the
+     * number of Regions.
+     */
+    explicit LabelledRegion(std::vector<Region> const & regions);
+    //@}
+
+    /***********************************/
+    //! @name Access
+    //@{
+
+    //! Appends the Rbo @a rbo of the object @a label.
+    /*! @a rbo must follow the last Rbo without overlapping it.
+     */
+    LabelledRegion & add(Rbo const & rbo, N32 label);
+
+    //! Iterator to the first Rbo.
+    RboIterator begin() const {
+        return rbos_.data();
+    }
+
+    //! Iterator behind the last Rbo.
+    RboIterator end() const {
+        return rbos_.data() + rbos_.size();
+    }
+
+    //! Number of Rbo's.
+    N32 nrRbos() const {
+        return rbos_.size();
+    }
+
+    //! Check if there are no Rbo's.
+    bool empty() const {
+        return rbos_.empty();
+    }
+
+    //! The label of the Rbo @a r.
+    N32 label(RboIterator r) const {
+        return labels_[r - this->begin()];
+    }
+
+    //! The labels of the Rbo's.
+    std::vector<N32> const & labels() const {
+        return labels_;
+    }
+
+    //! The number of labels, more than the highest label of the Rbo's.
+    /*! Objects which vanished, e.g. by an erosion, still count.
+     */
+    N32 nrLabels() const {
+        return nrLabels_;
+    }
+
+    //! All the objects together.
+    Region const region() const;
+
+    //! The object @a label, empty if there is none.
+    Region const region(N32 label) const;
+
+    //! The objects, the Region @em i is the object with label @em i.
+    std::vector<Region> const split() const;
+    //@}
+
+    /***********************************/
+    //! @name Morphology
+    //@{
+
+    //! Dilates each object by @em B.
+    /*! The result is the same as the dilations of the single objects by
+     * @em B, except for the pixels reached by several objects, which are
+     * resolved by @a conflict.
+     *
+     * @param B the structuring element @em B
+     * @param conflict the owner of pixels reached by several objects
+     * @return the dilated objects
+     */
+    LabelledRegion const dilate(Region const & B,
+                                Conflict conflict = ConflictSeparate) const;
+
+    //! Erodes each object by @em B.
+    /*! The result is the same as Region::erode2cut(@a B) of the single
+     * objects, i.e. touching objects don't hold each other up.
+     *
+     * @param B the structuring element @em B
+     * @return the eroded objects
+     */
+    LabelledRegion const erode(Region const & B) const;
+    //@}
+
+    /***********************************/
+    //! @name Debug Output
+    //@{
+    std::ostream & print(std::ostream & os) const;
+    virtual bool validate() const;
+    //@}
+
+private:
+    //! the Rbo's
+    std::vector<Rbo> rbos_;
+    //! the labels of the Rbo's
+    std::vector<N32> labels_;
+    //! the number of labels
+    N32 nrLabels_;
+};
+
+IPL_NS_END
+
+#endif
@@ -0,0 +1,164 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Header for ipl::MappedRegion
+ *
+ ********************************************************************/
+
+#ifndef IPL_MAPPEDREGION_HH
+#define IPL_MAPPEDREGION_HH
+
+#include "ipl/config.hh"
+
+#include <string>
+#include <boost/shared_ptr.hpp>
+
+#include "ipl/ipltypes.hh"
+#include "ipl/validable.hh"
+#include "ipl/point.hh"
+#include "ipl/winp.hh"
+#include "ipl/rbo.hh"
+#include "ipl/region.hh"
+
+IPL_NS_BEGIN
+
+//! A read-only Region in a memory mapped file.
+/*! The Region file is mapped into the address space and its Rbo's are used
+ * in place, nothing is copied on construction. Pages are read on demand and
+ * shared via the page cache by all processes mapping the same file.
+ * Copies of a MappedRegion share the mapping.
+ *
+ * The set operations and clip() run directly on the mapped Rbo's and return
+ * an ordinary Region. rows() copies a band of rows, e.g. to run the
+ * morphology on a large Region band by band:
+ * @code
+ * MappedRegion::save(reg, "mask.rgn");
+ * // ... possibly in another process
+ * MappedRegion const map("mask.rgn");
+ * Region const part = map.intersect(roi);
+ * Region const band = map.rows(1000, 1999).erode2(B);
+ * @endcode
+ *
+ * The file format is described in @ref region_files.
+ */
+class MappedRegion : public Validable
+{
+public:
+    //! Rbo-Iterator.
+    typedef Region::RboIterator RboIterator;
+
+    /***********************************/
+    //! @name Constructors and Files
+    //@{
+
+    //! ctr, maps the Region file @a fn.
+    /*! @throw IoError if the file can't be mapped or isn't a valid Region
+     * file
+     */
+    explicit MappedRegion(std::string const & fn);
+
+    //! Write @a reg as Region file @a fn.
+    /*! @throw IoError if the file can't be written
+     */
+    static void save(Region const & reg, std::string const & fn);
+    //@}
+
+    /***********************************/
+    //! @name Rbo Properties
+    //@{
+
+    //! Iterator to the first Rbo.
+    RboIterator begin() const;
+
+    //! Iterator behind the last Rbo.
+    RboIterator end() const;
+
+    //! Number of Rbo's.
+    N32 nrRbos() const;
+
+    //! Check if the Region is empty.
+    bool empty() const;
+
+    //! Bounding box of the Region.
+    /*! @throw EmptyRegionError if the Region is empty
+     */
+    WinP const & boundingBox() const;
+
+    //! Iterator to the first Rbo of the row @a y.
+    /*! Uses the row index of the file, the result is end() if @a y is
+     * below the Region.
+     */
+    RboIterator rowBegin(N32 y) const;
+
+    //! Iterator behind the last Rbo of the row @a y.
+    RboIterator rowEnd(N32 y) const;
+
+    //! Check if the Region includes the Point @a pt.
+    bool includes(PointN16 const & pt) const;
+    //@}
+
+    /***********************************/
+    //! @name Copies and Set Operations
+    /*! The results are ordinary Regions.
+     */
+    //@{
+
+    //! Copy of the whole Region.
+    Region const region() const;
+
+    //! Copy of the rows [@a y0, @a y1].
+    Region const rows(N32 y0, N32 y1) const;
+
+    //! The Region clipped to @a win.
+    /*! Only the rows of @a win are read.
+     */
+    Region const clip(WinP const & win) const;
+
+    //! Union with @a other.
+    Region const unions(Region const & other) const;
+
+    //! @overload
+    Region const unions(MappedRegion const & other) const;
+
+    //! Intersection with @a other.
+    /*! Only the rows of the bounding box of @a other are read.
+     */
+    Region const intersect(Region const & other) const;
+
+    //! @overload
+    Region const intersect(MappedRegion const & other) const;
+    //@}
+
+    /***********************************/
+    //! @name Debug Output
+    //@{
+    std::ostream & print(std::ostream & os) const;
+
+    //! Validation
+    /*! Checks all Rbo's, i.e. reads the whole file.
+     */
+    virtual bool validate() const;
+    //@}
+
+private:
+    class Impl;
+
+    //! Union of the ranges [@a r, @a rend) and [@a s, @a send).
+    static Region const unions(RboIterator r, RboIterator rend,
+                               RboIterator s, RboIterator send);
+
+    //! Intersection of the ranges [@a r, @a rend) and [@a s, @a send).
+    static Region const intersect(RboIterator r, RboIterator rend,
+                                  RboIterator s, RboIterator send);
+
+    //! the mapping
+    boost::shared_ptr<Impl const> impl_;
+};
+
+IPL_NS_END
+
+#endif
@@ -22,8 +22,13 @@
 #include <type_traits>
 #include <functional>
 #include <algorithm>
+#include <bitset>
 #include "ipl/type_manip.hh"
 
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#endif
+
 IPL_NS_BEGIN
 
 namespace mathli {
@@ -141,6 +146,34 @@ abs(F64 a)
 }
 //@}
 
+/*! @name Bit Functions
+ */
+//@{
+//! Index of the lowest set bit of @a m, which must not be 0.
+inline N32
+lowestBit(UN64 m)
+{
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward64(&i, m);
+    return static_cast<N32>(i);
+#else
+    return __builtin_ctzll(m);
+#endif
+}
+
+//! Number of set bits of @a m.
+inline N32
+bitCount(UN64 m)
+{
+#if defined(_MSC_VER)
+    return static_cast<N32>(std::bitset<64>(m).count());
+#else
+    return __builtin_popcountll(m);
+#endif
+}
+//@}
+
 /*! @name Trigonometric Functions
  * @sa ipl::Angle
  */
@@ -0,0 +1,165 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Header for ipl::PackedMask
+ *
+ ********************************************************************/
+
+#ifndef IPL_PACKEDMASK_HH
+#define IPL_PACKEDMASK_HH
+
+#include "ipl/config.hh"
+
+#include <vector>
+
+#include "ipl/ipltypes.hh"
+#include "ipl/validable.hh"
+#include "ipl/point.hh"
+#include "ipl/winp.hh"
+#include "ipl/region.hh"
+
+IPL_NS_BEGIN
+
+//! A binary image with one bit per pixel.
+/*! The rows of the mask are packed into 64 bit words, the pixel
+ * <em>(x0 + 64 j + k, y)</em> is the bit @em k of the word @em j of the row
+ * @em y. Pixels outside of the mask don't belong to the Region.
+ *
+ * The morphology shifts whole rows and combines them word by word, which
+ * is much faster than the run based algorithms of Region for dense Regions
+ * with many short runs and small structuring elements. The results are the
+ * same as those of Region::erode2cut and Region::dilate:
+ * @code
+ * PackedMask const X(reg);
+ * Region const eroded = X.erode(B).region();   // == reg.erode2cut(B)
+ * @endcode
+ * Region::erode and Region::dilate(Region const &, MorphEngine) choose the
+ * engine automatically, see erosionPreferred() and dilationPreferred().
+ */
+class PackedMask : public Validable
+{
+public:
+    /***********************************/
+    //! @name Constructors
+    //@{
+
+    //! ctr, an empty mask.
+    PackedMask();
+
+    //! ctr, the mask of @a reg in its bounding box.
+    explicit PackedMask(Region const & reg);
+
+    //! ctr, the mask of @a reg in the window @a win.
+    /*! Pixels of @a reg outside of @a win are dropped.
+     */
+    PackedMask(Region const & reg, WinP const & win);
+    //@}
+
+    /***********************************/
+    //! @name Properties
+    //@{
+
+    //! The mask as Region.
+    Region const region() const;
+
+    //! Check if the mask has no pixels at all, not even empty ones.
+    bool empty() const {
+        return width_ == 0 || height_ == 0;
+    }
+
+    //! The upper left corner.
+    PointN16 const upperLeft() const {
+        return PointN16(x0_, y0_);
+    }
+
+    //! Width of the mask.
+    N32 width() const {
+        return width_;
+    }
+
+    //! Height of the mask.
+    N32 height() const {
+        return height_;
+    }
+
+    //! Check if the mask includes the Point @a pt.
+    bool includes(PointN16 const & pt) const;
+    //@}
+
+    /***********************************/
+    //! @name Morphological Operations
+    //@{
+
+    //! Erosion by the structuring element @a B.
+    /*! Same as Region::erode2cut(@a B). For every row of every Rbo of @a B
+     * the mask is eroded by the Rbo's length with O(log length) shifts, then
+     * the shifted rows of all Rbo's are combined.
+     */
+    PackedMask const erode(Region const & B) const;
+
+    //! Dilation by the structuring element @a B.
+    /*! Same as Region::dilate(@a B).
+     */
+    PackedMask const dilate(Region const & B) const;
+
+    //! Check if erode is faster than Region::erode2cut.
+    /*! The runtime of the PackedMask depends on the number of words of the
+     * bounding box of @a X and the number of Rbo's of @a B, the runtime of
+     * Region::erode2cut on the pixels of @a X which may be hits of the
+     * longest Rbo of @a B.
+     */
+    static bool erosionPreferred(Region const & X, Region const & B);
+
+    //! Check if dilate is faster than the run based dilation.
+    /*! The runtime of the PackedMask depends on the number of words of the
+     * bounding box of @a X and the number of Rbo's of @a B, the runtime of
+     * the run based dilation of Region::dilate(Region const &, MorphEngine)
+     * on the number of pairs of Rbo's of @a X and @a B.
+     */
+    static bool dilationPreferred(Region const & X, Region const & B);
+    //@}
+
+    /***********************************/
+    //! @name Debug Output
+    //@{
+    std::ostream & print(std::ostream & os) const;
+    virtual bool validate() const;
+    //@}
+
+private:
+    //! ctr, an empty mask of @a width x @a height pixels at (@a x0, @a y0).
+    PackedMask(N32 x0, N32 y0, N32 width, N32 height);
+
+    //! Implementation of erode and dilate.
+    PackedMask const morph(Region const & B, bool erosion) const;
+
+    //! the first word of the row @a y, relative to the mask
+    UN64 * row(N32 y) {
+        return &bits_[y * stride_];
+    }
+    //! @overload
+    UN64 const * row(N32 y) const {
+        return &bits_[y * stride_];
+    }
+
+    //! the left column
+    N32 x0_;
+    //! the upper row
+    N32 y0_;
+    //! the width
+    N32 width_;
+    //! the height
+    N32 height_;
+    //! the number of words of a row
+    N32 stride_;
+    //! the words of all rows, bits right of the mask are 0
+    std::vector<UN64> bits_;
+};
+
+IPL_NS_END
+
+#endif
@@ -0,0 +1,221 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Header for ipl::PackedRegion
+ *
+ ********************************************************************/
+
+#ifndef IPL_PACKEDREGION_HH
+#define IPL_PACKEDREGION_HH
+
+#include "ipl/config.hh"
+
+#include <vector>
+#include <iterator>
+#include <cstddef>
+
+#include "ipl/ipltypes.hh"
+#include "ipl/validable.hh"
+#include "ipl/point.hh"
+#include "ipl/winp.hh"
+#include "ipl/rbo.hh"
+#include "ipl/region.hh"
+
+IPL_NS_BEGIN
+
+//! A compressed, read-only Region.
+/*! The Rbo's are coded row by row, typically with one or two bytes per Rbo
+ * instead of eight:
+ *  - a Rbo overlapping a Rbo of the row above stores the differences of its
+ *    start and end point to this Rbo, a single byte if both are small,
+ *  - any other Rbo stores the gap to its left neighbour and its length as
+ *    variable length integers.
+ *
+ * The rows are grouped into blocks of #rowsPerBlock rows, which are decoded
+ * independently. The block index gives random access to the rows, e.g. by
+ * rows() and includes().
+ *
+ * The Iterator decodes the Rbo's while advancing. The set operations and
+ * the erosion decode one band of rows at a time and return an ordinary
+ * Region, so the whole Region is never unpacked:
+ * @code
+ * PackedRegion const packed(reg);       // e.g. kept in memory for a long time
+ * Region const part = packed.intersect(roi);
+ * Region const eroded = packed.erode(B);
+ * @endcode
+ */
+class PackedRegion : public Validable
+{
+public:
+    //! Number of rows of a block.
+    static N32 const rowsPerBlock = 32;
+
+    //! Iterator over the Rbo's.
+    /*! A forward iterator, which decodes the rows while advancing.
+     */
+    class Iterator
+    {
+    public:
+        //! @name iterator traits
+        //@{
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Rbo value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef Rbo const * pointer;
+        typedef Rbo const & reference;
+        //@}
+
+        //! ctr, an invalid iterator
+        Iterator();
+
+        //! Dereference
+        Rbo const & operator*() const {
+            return row_[idx_];
+        }
+        //! Dereference
+        Rbo const * operator->() const {
+            return &row_[idx_];
+        }
+        //! Next Rbo, decodes the next rows if necessary.
+        Iterator & operator++();
+        //! Postincrement
+        Iterator operator++(int) {
+            Iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+        //! Equality
+        bool operator==(Iterator const & rhs) const {
+            return nr_ == rhs.nr_;
+        }
+        //! Inequality
+        bool operator!=(Iterator const & rhs) const {
+            return !(*this == rhs);
+        }
+    private:
+        friend class PackedRegion;
+        //! ctr, positioned at the first Rbo of the block @a block or later.
+        Iterator(PackedRegion const * reg, N32 block);
+        //! Decodes the rows until a row with Rbo's is found.
+        void nextRow();
+
+        //! the packed Region
+        PackedRegion const * reg_;
+        //! the code of the next row
+        UN8 const * pos_;
+        //! the next row
+        N32 y_;
+        //! the Rbo's of the actual row
+        std::vector<Rbo> row_;
+        //! the Rbo's of the row above the actual row
+        std::vector<Rbo> prev_;
+        //! index into @a row_
+        std::size_t idx_;
+        //! number of the actual Rbo in the Region
+        N32 nr_;
+    };
+
+    /***********************************/
+    //! @name Constructors
+    //@{
+
+    //! ctr, an empty Region.
+    PackedRegion();
+
+    //! ctr, compresses @a reg.
+    explicit PackedRegion(Region const & reg);
+    //@}
+
+    /***********************************/
+    //! @name Rbo Properties
+    //@{
+
+    //! Iterator to the first Rbo.
+    Iterator begin() const;
+
+    //! Iterator behind the last Rbo.
+    Iterator end() const;
+
+    //! Number of Rbo's.
+    N32 nrRbos() const {
+        return nrRbos_;
+    }
+
+    //! Check if the Region is empty.
+    bool empty() const {
+        return nrRbos_ == 0;
+    }
+
+    //! Bounding box of the Region.
+    /*! @throw EmptyRegionError if the Region is empty
+     */
+    WinP const & boundingBox() const;
+
+    //! Number of bytes of the code and the block index.
+    std::size_t size() const;
+
+    //! Iterator to the first Rbo in row @a y or below.
+    Iterator row(N32 y) const;
+
+    //! Check if the Region includes the Point @a pt.
+    bool includes(PointN16 const & pt) const;
+    //@}
+
+    /***********************************/
+    //! @name Decompression and Operations
+    /*! The results are ordinary Regions.
+     */
+    //@{
+
+    //! The uncompressed Region.
+    Region const region() const;
+
+    //! The rows [@a y0, @a y1] of the Region.
+    Region const rows(N32 y0, N32 y1) const;
+
+    //! Union with @a other.
+    Region const unions(Region const & other) const;
+
+    //! Intersection with @a other.
+    /*! Only the blocks in the rows of @a other are decoded.
+     */
+    Region const intersect(Region const & other) const;
+
+    //! Erosion by the structuring element @a B.
+    /*! Same as <tt>region().erode2cut(B)</tt>, but the Region is decoded
+     * and eroded in bands of rows, see Region::erode2cut(Region const &,
+     * WinP const &).
+     */
+    Region const erode(Region const & B) const;
+    //@}
+
+    /***********************************/
+    //! @name Debug Output
+    //@{
+    std::ostream & print(std::ostream & os) const;
+    virtual bool validate() const;
+    //@}
+
+private:
+    //! Appends the Rbo's of the rows [@a y0, @a y1] to @a rbos.
+    void decode(N32 y0, N32 y1, std::vector<Rbo> & rbos) const;
+
+    //! the code of all rows of the bounding box
+    std::vector<UN8> code_;
+    //! offsets of the blocks into @a code_
+    std::vector<UN32> blocks_;
+    //! number of the Rbo's before the blocks
+    std::vector<N32> firstRbos_;
+    //! the bounding box, if not empty
+    WinP bbox_;
+    //! number of Rbo's
+    N32 nrRbos_;
+};
+
+IPL_NS_END
+
+#endif
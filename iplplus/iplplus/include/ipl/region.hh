@@ -18,6 +18,13 @@
 #include "ipl/config.hh"
 
 #include <vector>
+#include <map>
+#include <string>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <cstddef>
+#include <boost/shared_ptr.hpp>
 #include <boost/serialization/access.hpp>
 #include <boost/serialization/nvp.hpp>
 #include <boost/serialization/vector.hpp>
@@ -32,9 +39,14 @@
 #include "ipl/polygon.hh"
 #include "ipl/rect.hh"
 
+namespace cv {
+class Mat;
+}
+
 IPL_NS_BEGIN
 
 template<typename T> class PictImg;
+class Executor;
 class Circle;
 class Ellipse;
 
@@ -78,7 +90,9 @@ public:
     //! Rbo-Iterator.
     /*! Iterates over all @a Rbo's in the Region.
      */
-    typedef std::vector<Rbo>::const_iterator RboIterator;
+    typedef Rbo const * RboIterator;
+
+    class LazyErosion;
 
     /***********************************/
     //! @name Constructors, Destructor und Zuweisung
@@ -121,6 +135,185 @@ public:
     Region & operator=(Region const & rhs);
     //@}
 
+    /***********************************/
+    /*! @name Generation of many Regions from an Image.
+     * Each of these methods scans the image (resp. its roi) only once and
+     * distributes the runs to the resulting Regions.
+     */
+    //@{
+    //! A closed interval [@em lo, @em hi] of grayvalues.
+    typedef std::pair<N32, N32> Threshold;
+
+    //! Thresholding an image with several intervals.
+    /*! Returns one Region for each interval of @a thresholds, which is the
+     * same as <tt>Region(img, lo, hi)</tt>.
+     * @throw ParameterError if the intervals are not sorted and disjunct.
+     */
+    static std::vector<Region> const fromThresholds(PictImg<UN8> const & img,
+                                                    std::vector<Threshold> const & thresholds);
+    //! @overload
+    static std::vector<Region> const fromThresholds(PictImg<N16> const & img,
+                                                    std::vector<Threshold> const & thresholds);
+
+    //! Split a label image.
+    /*! Returns one Region for each distinct grayvalue of the image @a img,
+     * the key of the map is the grayvalue.
+     */
+    static std::map<N32, Region> const fromLabels(PictImg<UN8> const & img);
+    //! @overload
+    static std::map<N32, Region> const fromLabels(PictImg<N16> const & img);
+    //@}
+
+    /***********************************/
+    /*! @name Thresholding of Image Files.
+     * The image is decoded scanline by scanline and each scanline is
+     * thresholded at once, so the image is never held in memory as a whole.
+     */
+    //@{
+    //! Construct a Region by thresholding the image file @a fn.
+    /*! All the pixel with a grayvalue in the interval [@a lo, @a hi] become
+     * part of the Region. The grayvalues are the ones stored in the file,
+     * i.e. [0, 255] for up to 8 bits per sample (bilevel images have 0 and
+     * 255) and [0, 65535] for 16 bits. Color images are converted to gray
+     * with the same weights as in PictImg::PictImg(std::string const &).
+     *
+     * Supported are PNG and TIFF files (the format is detected by the
+     * content), if the library was built with libpng resp. libtiff.
+     * Interlaced PNG's can't be decoded by scanlines, they are decoded as a
+     * whole. An empty range, @a lo > @a hi, yields an empty Region without
+     * reading the file.
+     * @throw IoError if the file can't be read or has an unsupported format
+     */
+    static Region const fromFile(std::string const & fn, N32 lo, N32 hi);
+    //@}
+
+    /***********************************/
+    /*! @name Bilevel Codes.
+     * The Region is coded as bilevel image of @a width x @a height pixels
+     * with the upper left corner in (0, 0). The pixels of the Region are 1
+     * (the black runs of CCITT), all the others are 0. Pixels outside of
+     * the image are dropped.
+     *
+     * The codes are translated directly from and to the Rbo's, there is no
+     * bitmap in between. The codes are the ones of a single TIFF strip:
+     * CCITT Group 4 (T.6) without EOFB, resp. PackBits with byte aligned
+     * rows.
+     */
+    //@{
+    //! The compressions of bilevel TIFF files.
+    enum BilevelCompression {
+        G4,        //!< CCITT Group 4
+        PackBits   //!< PackBits
+    };
+
+    //! CCITT Group 4 code of the Region.
+    std::vector<UN8> const encodeG4(N32 width, N32 height) const;
+
+    //! Decode a CCITT Group 4 code.
+    /*! @throw IoError if the code is invalid or truncated
+     */
+    static Region const decodeG4(std::vector<UN8> const & code,
+                                 N32 width, N32 height);
+
+    //! PackBits code of the Region.
+    std::vector<UN8> const encodePackBits(N32 width, N32 height) const;
+
+    //! Decode a PackBits code.
+    /*! @throw IoError if the code is truncated
+     */
+    static Region const decodePackBits(std::vector<UN8> const & code,
+                                       N32 width, N32 height);
+
+    //! Save the Region as bilevel TIFF file @a fn.
+    /*! The pixels of the Region are white (1 with photometric
+     * interpretation min-is-black), so <tt>Region::fromFile(fn, 255,
+     * 255)</tt> reads the Region back. Bilevel TIFF files with G4 or
+     * PackBits compression are read without a bitmap by fromFile().
+     * @throw IoError if the file can't be written or the library was built
+     * without libtiff
+     */
+    void saveTiff(std::string const & fn, N32 width, N32 height,
+                  BilevelCompression compression = G4) const;
+    //@}
+
+    /***********************************/
+    /*! @name Raster Buffers.
+     * Conversions from and to images in memory of the caller, e.g. the data
+     * of a cv::Mat, without copying the image. A buffer has @a height rows
+     * of @a width pixels, consecutive rows are @a step bytes apart. The
+     * pixel (0, 0) of the buffer is the point @a origin of the Region, pixels
+     * of the Region outside of the buffer are dropped.
+     *
+     * The thresholding uses the same SIMD scan as Region(PictImg<UN8> const
+     * &, N32, N32), the rendering writes each run with one memset.
+     * @code
+     * cv::Mat mat(480, 640, CV_8UC1);
+     * reg.toMat(mat, PointN16(0, 0));
+     * cv::GaussianBlur(mat, mat, cv::Size(5, 5), 0);
+     * Region const blurred = Region::fromMat(mat, 128, 255);
+     * @endcode
+     */
+    //@{
+    //! Construct a Region by thresholding a buffer of grayvalues.
+    /*! All the pixel with a grayvalue in [@a lo, @a hi] become part of the
+     * Region.
+     * @throw ParameterError if the size is negative
+     */
+    static Region const fromBuffer(UN8 const * data, N32 width, N32 height,
+                                   std::ptrdiff_t step, N32 lo, N32 hi,
+                                   PointN16 const & origin = PointN16(0, 0));
+    //! @overload
+    static Region const fromBuffer(N16 const * data, N32 width, N32 height,
+                                   std::ptrdiff_t step, N32 lo, N32 hi,
+                                   PointN16 const & origin = PointN16(0, 0));
+    //! @overload
+    static Region const fromBuffer(UN16 const * data, N32 width, N32 height,
+                                   std::ptrdiff_t step, N32 lo, N32 hi,
+                                   PointN16 const & origin = PointN16(0, 0));
+
+    //! Construct a Region by thresholding a cv::Mat.
+    /*! Supported are one channel matrices of type CV_8U, CV_16S and CV_16U.
+     * @throw ParameterError for other types
+     */
+    static Region const fromMat(cv::Mat const & mat, N32 lo, N32 hi,
+                                PointN16 const & origin = PointN16(0, 0));
+
+    //! Render the Region into a buffer.
+    /*! The pixels of the Region become @a fg, all other pixels of the buffer
+     * @a bg.
+     * @throw ParameterError if the size is negative
+     */
+    void toBuffer(UN8 * data, N32 width, N32 height, std::ptrdiff_t step,
+                  PointN16 const & origin = PointN16(0, 0),
+                  UN8 fg = 255, UN8 bg = 0) const;
+
+    //! Render the Region into the cv::Mat @a mat.
+    /*! @a mat must be allocated by the caller with one channel of type CV_8U.
+     * @throw ParameterError for other types
+     */
+    void toMat(cv::Mat & mat, PointN16 const & origin = PointN16(0, 0),
+               UN8 fg = 255, UN8 bg = 0) const;
+
+    //! Construct a Region from a packed bilevel buffer.
+    /*! The rows are packed as in PBM files: 8 pixels per byte, the most
+     * significant bit first, a row starts with a new byte. The pixels with
+     * bit 1 become part of the Region.
+     * @throw ParameterError if the size is negative
+     */
+    static Region const fromBits(UN8 const * data, N32 width, N32 height,
+                                 std::ptrdiff_t step,
+                                 PointN16 const & origin = PointN16(0, 0));
+
+    //! Render the Region into a packed bilevel buffer.
+    /*! The packing is the one of fromBits, the pixels of the Region are 1,
+     * all others and the bits behind @a width are 0. A row needs at least
+     * <tt>(width + 7) / 8</tt> bytes.
+     * @throw ParameterError if the size is negative
+     */
+    void toBits(UN8 * data, N32 width, N32 height, std::ptrdiff_t step,
+                PointN16 const & origin = PointN16(0, 0)) const;
+    //@}
+
     /***********************************/
     //! @name Generation from a geometric Primitive.
     //@{
@@ -157,12 +350,12 @@ public:
 
     //! Iterator to the first Rbo of a Region.
     RboIterator begin() const {
-        return rbos_.begin();
+        return rbos_.data();
     }
 
     //! Iterator behind the last Rbo in a Region.
     RboIterator end() const {
-        return rbos_.end();
+        return rbos_.data() + rbos_.size();
     }
 
     //! Number of Rbo's in the Region.
@@ -190,6 +383,123 @@ public:
     bool includes(PointN16 const & pt) const;
     //@}
 
+    /***********************************/
+    /*! @name Shape Features
+     * The features are computed in one pass over the Rbo's with closed sums
+     * per Rbo. Area, center and perimeter are cached, so after any of these
+     * queries the other ones are free until the Region changes.
+     */
+    //@{
+
+    //! Area and second order moments of a Region.
+    /*! The pixels are treated as points, the moments are the central
+     * moments divided by the area.
+     */
+    struct Moments {
+        //! the number of pixels
+        N32 area_;
+        //! the center of gravity
+        PointF64 center_;
+        //! mean of <em>(x - cx)^2</em>
+        F64 m20_;
+        //! mean of <em>(x - cx)(y - cy)</em>
+        F64 m11_;
+        //! mean of <em>(y - cy)^2</em>
+        F64 m02_;
+
+        //! Angle of the major axis to the x-axis, in (-pi/2, pi/2].
+        /*! As y grows downwards, positive angles turn clockwise on the screen.
+         */
+        F64 orientation() const;
+
+        //! Radius of the major axis of the ellipse with the same moments.
+        F64 majorRadius() const;
+
+        //! Radius of the minor axis of the ellipse with the same moments.
+        F64 minorRadius() const;
+    };
+
+    //! Number of pixels, 0 for an empty Region.
+    N32 area() const;
+
+    //! Center of gravity.
+    /*! @throw EmptyRegionError, if Region empty.
+     */
+    PointF64 const & center() const;
+
+    //! Area and center of gravity.
+    /*! @return the area, the center is stored in @a center.
+     * @throw EmptyRegionError, if Region empty.
+     */
+    N32 areaCenter(PointF64 & center) const;
+
+    //! Area, center and second order moments.
+    /*! @throw EmptyRegionError, if Region empty.
+     */
+    Moments const moments() const;
+
+    //! Length of the border between the Region and its complement.
+    /*! Each pixel is a unit square, the perimeter is the number of its edges
+     * not shared with another pixel of the Region. Holes count as well.
+     */
+    F64 perimeter() const;
+
+    //! Number of connected components minus number of holes.
+    /*! @a connectivity 8 (the default) or 4 is the neighbourhood of the
+     * components, holes use the other one. Blobs::Connectivity can be
+     * passed directly.
+     * @throw ParameterError, if @a connectivity is neither 4 nor 8.
+     */
+    N32 eulerNumber(N32 connectivity = 8) const;
+    //@}
+
+    /***********************************/
+    /*! @name Attribute Filters
+     * The filters label the connected components on the Rbo's, see Blobs,
+     * and decide per component on sums over its Rbo's. Unlike an opening
+     * with a structuring element the kept components are not changed.
+     * @a connectivity is 8 (the default) or 4, Blobs::Connectivity can be
+     * passed directly.
+     * @throw ParameterError, if @a connectivity is neither 4 nor 8.
+     */
+    //@{
+
+    //! The features for selectShape.
+    enum ShapeFeature {
+        //! number of pixels
+        ShapeFeatureArea = 1,
+        //! width of the bounding box
+        ShapeFeatureWidth = 2,
+        //! height of the bounding box
+        ShapeFeatureHeight = 3,
+        //! 1 - minor / major radius of the ellipse with the same moments,
+        //! 0 for a circle, 1 for a line
+        ShapeFeatureElongation = 4,
+    };
+
+    //! The @a feature of the whole Region.
+    /*! Evaluated as selectShape() evaluates it per component, so a component
+     * @em c is selected iff <tt>c.shapeFeature(feature)</tt> lies in
+     * [@a min, @a max].
+     * @throw EmptyRegionError, if Region empty.
+     * @throw ParameterError, if @a feature is unknown.
+     */
+    F64 shapeFeature(ShapeFeature feature) const;
+
+    //! The components whose @a feature lies in [@a min, @a max].
+    Region const selectShape(ShapeFeature feature, F64 min, F64 max,
+                             N32 connectivity = 8) const;
+
+    //! Removes the components with less than @a minArea pixels.
+    Region const areaOpen(N32 minArea, N32 connectivity = 8) const;
+
+    //! Fills the holes with less than @a minArea pixels.
+    /*! The holes are the components of the complement, which don't touch
+     * the outside, with the other connectivity.
+     */
+    Region const areaClose(N32 minArea, N32 connectivity = 8) const;
+    //@}
+
     /***********************************/
     /*! @name Geometric Manipulations.
      * This includes affine transformations.
@@ -228,6 +538,17 @@ public:
         StructuringElementLine = 4,
     };
 
+    //! The implementations of erode and dilate.
+    enum MorphEngine {
+        //! the run based algorithms, erode2cut and the union of the runs of
+        //! the object widened by the runs of the structuring element
+        RunEngine,
+        //! the bit-parallel PackedMask
+        PackedEngine,
+        //! the faster one for the Region and the structuring element
+        AutoEngine
+    };
+
     //! Computes the erosion of a Region with structuring element @em B.
     /*! algorithm - erosion - variant 1
      * Calculates the erosion of the given region by structuring element @em B.
@@ -278,6 +599,108 @@ public:
      */
     Region const erode2cut(Region const & B) const;
 
+    //! Computes the erosion of a Region inside a window.
+    /*! Returns the same as erode2cut(@a B) clipped to @a win. Before eroding,
+     * the object is clipped to @a win enlarged by the extent of @em B, so the
+     * erosion-transform is built for the window only and the runtime does not
+     * depend on the size of the whole Region.
+     *
+     * @param B the structuring element @em B
+     * @param win the window, where the erosion is needed
+     * @return the region eroded by @em B and clipped to @a win
+     */
+    Region const erode2cut(Region const & B, WinP const & win) const;
+
+    //! Computes the erosions of a Region by a bank of structuring elements.
+    /*! Returns erode2cut(@a Bs[i]) for every @a i, but the erosion-transform
+     * of the object is built once, large enough for all @a Bs, and the runs
+     * of the object are traversed once. Only the jump-miss/jump-hit tests
+     * are done per structuring element, e.g. for a bank of rotated lines,
+     * see generateLineBank.
+     *
+     * @param Bs the structuring elements
+     * @return the region eroded by each of @a Bs
+     */
+    std::vector<Region> const erode2cut(std::vector<Region> const & Bs) const;
+
+    //! Computes the union of the erosions by a bank of structuring elements.
+    /*! The pixels where at least one of @a Bs fits, from one scan as in
+     * erode2cut(std::vector<Region> const &).
+     *
+     * @param Bs the structuring elements
+     * @return the union of the region eroded by each of @a Bs
+     */
+    Region const erodeUnion(std::vector<Region> const & Bs) const;
+
+    //! Computes the intersection of the erosions by a bank of structuring elements.
+    /*! The pixels where all of @a Bs fit. This is the erosion by the union
+     * of @a Bs, so it needs only one erosion.
+     *
+     * @param Bs the structuring elements
+     * @return the intersection of the region eroded by each of @a Bs
+     */
+    Region const erodeIntersection(std::vector<Region> const & Bs) const;
+
+    //! Computes the rank erosion of a Region with structuring element @em B.
+    /*! A point @em p belongs to the result, if at least @a minCount pixels of
+     * @em B translated by @em p belong to the object. With the area of @em B
+     * as @a minCount this is erode2cut(@a B), with 1 it is the dilation by
+     * the reflected @em B. In between the erosion tolerates noise.
+     *
+     * The coverage of each run of @em B at a point is the difference of two
+     * prefix counts of a row of the object. As the coverage changes by at
+     * most the number of runs of @em B from one point to the next, the scan
+     * jumps over the points which can't reach @a minCount, similar to the
+     * jump-miss theorem of erode2cut, and over the points which can't fall
+     * below it.
+     *
+     * @param B the structuring element @em B
+     * @param minCount the number of pixels of @em B which must be covered
+     * @return the region rank-eroded by @em B
+     * @throw ParameterError, if @a minCount is not positive.
+     */
+    Region const erodeRank(Region const & B, N32 minCount) const;
+
+    //! Computes the rank erosion of a Region by a percentage of @em B.
+    /*! Same as erodeRank(@a B, @em n) with the smallest @em n of at least
+     * @a percent % of the area of @em B.
+     *
+     * @param B the structuring element @em B
+     * @param percent the covered part of @em B, in (0, 100]
+     * @return the region rank-eroded by @em B
+     * @throw ParameterError, if @a percent is out of range.
+     */
+    Region const erodePercentile(Region const & B, F64 percent) const;
+
+    //! Lazily evaluated erosion of a Region with structuring element @em B.
+    /*! Returns the erosion as computed by erode2cut(@a B), but no row of the
+     * result is computed in advance. The jump-miss/jump-hit scan runs only for
+     * the rows that are actually requested, see LazyErosion. The result
+     * refers to this Region, which must outlive it.
+     *
+     * @param B the structuring element @em B
+     * @return the lazy erosion of the Region by @em B
+     */
+    LazyErosion const erode2cutLazy(Region const & B) const;
+
+    //! Check if the structuring element @em B fits into the Region.
+    /*! Same as <tt>!erode2cut(B).empty()</tt>, but the scan of erode2cut stops
+     * at the first hit and no Rbo is generated.
+     *
+     * @param B the structuring element @em B
+     * @return @c true if the erosion by @em B is not empty
+     */
+    bool fits(Region const & B) const;
+
+    //! Area of the erosion by the structuring element @em B.
+    /*! Same as the number of pixels of erode2cut(@a B), but the lengths of the
+     * jump-hit runs are only summed up and no Rbo is generated.
+     *
+     * @param B the structuring element @em B
+     * @return the number of pixels of the erosion by @em B
+     */
+    N32 erodedArea(Region const & B) const;
+
     //! Computes the erosion of a Region with structuring element @em B.
     /*! algorithm - variant 3
      * Calculates the erosion of the given region by structuring element @em B.
@@ -328,6 +751,111 @@ public:
      */
     Region const dilatecut(Region const & B) const;
 
+    //! Computes the erosion of a Region with the chosen engine.
+    /*! The result is the same as erode2cut(@a B). The PackedEngine shifts
+     * and combines the rows of a bitmap of the Region, which is faster for
+     * dense Regions with many short Rbo's and small structuring elements.
+     * The AutoEngine chooses by PackedMask::erosionPreferred.
+     *
+     * @param B the structuring element @em B
+     * @param engine the implementation
+     * @return the region eroded by @em B
+     */
+    Region const erode(Region const & B, MorphEngine engine = AutoEngine) const;
+
+    //! Computes the dilation of a Region with the chosen engine.
+    /*! The result is the same as dilate(@a B), analogous to
+     * erode(Region const &, MorphEngine). The AutoEngine chooses by
+     * PackedMask::dilationPreferred.
+     *
+     * @param B the structuring element @em B
+     * @param engine the implementation
+     * @return the region dilated by @em B
+     */
+    Region const dilate(Region const & B, MorphEngine engine) const;
+
+    //! Computes the dilation of a Region inside a window.
+    /*! Returns the same as dilatecut(@a B) clipped to @a win. Analogous to
+     * erode2cut(Region const &, WinP const &) only the part of the object
+     * within @a win enlarged by the extent of @em B is processed.
+     *
+     * @param B the structuring element @em B
+     * @param win the window, where the dilation is needed
+     * @return the region dilated by @em B and clipped to @a win
+     */
+    Region const dilatecut(Region const & B, WinP const & win) const;
+
+    //! Updates an erosion after a change of the input.
+    /*! Computes the same result as erode2cut(@a B), but reuses the erosion
+     * @a prevEroded of a previous input @a prevX. The rows where the object
+     * and @a prevX differ are found by a run-level diff, only the result rows
+     * within the height of @em B of such a change are recomputed and spliced
+     * into @a prevEroded. The cost therefore scales with the size of the change
+     * and not with the size of the Region.
+     *
+     * @param B the structuring element @em B
+     * @param prevX the previous input
+     * @param prevEroded @a prevX eroded by @em B, i.e. <tt>prevX.erode2cut(B)</tt>
+     * @return the region eroded by @em B
+     * @sa dilatecutUpdate
+     */
+    Region const erode2cutUpdate(Region const & B,
+                                 Region const & prevX,
+                                 Region const & prevEroded) const;
+
+    //! Updates a dilation after a change of the input.
+    /*! This is the counterpart of erode2cutUpdate for dilatecut(@a B).
+     *
+     * @param B the structuring element @em B
+     * @param prevX the previous input
+     * @param prevDilated @a prevX dilated by @em B, i.e. <tt>prevX.dilatecut(B)</tt>
+     * @return the region dilated by @em B
+     * @sa erode2cutUpdate
+     */
+    Region const dilatecutUpdate(Region const & B,
+                                 Region const & prevX,
+                                 Region const & prevDilated) const;
+
+    //! Computes a spatially variant erosion.
+    /*! The zone @a zones[i] is eroded by @a Bs[i], i.e. the result is the
+     * union of erode2cut(@a Bs[i]) clipped to @a zones[i] for every @em i.
+     * The erosion-transform of the object is built once, large enough for
+     * the largest of @a Bs, and each structuring element is scanned only on
+     * the parts of the runs of the object which reach its zone. So the
+     * result has no seams at the borders of the zones, and there is no work
+     * outside of them as with one full erosion per zone.
+     *
+     * @param zones the zones, usually a partition of the image
+     * @param Bs the structuring element of each zone
+     * @return the region eroded zone by zone
+     * @throw ParameterError, if the numbers of zones and structuring elements differ.
+     */
+    Region const erodeZones(std::vector<Region> const & zones,
+                            std::vector<Region> const & Bs) const;
+
+    //! @overload
+    Region const erodeZones(std::vector<WinP> const & zones,
+                            std::vector<Region> const & Bs) const;
+
+    //! Computes a spatially variant dilation.
+    /*! The result is the union of dilate(@a Bs[i]) clipped to @a zones[i]
+     * for every @em i. A point is missing in the dilation, if the reflected
+     * structuring element fits into the complement there, so this is done
+     * by one scan as in erodeZones of the complement within the zones
+     * enlarged by @a Bs.
+     *
+     * @param zones the zones, usually a partition of the image
+     * @param Bs the structuring element of each zone
+     * @return the region dilated zone by zone
+     * @throw ParameterError, if the numbers of zones and structuring elements differ.
+     */
+    Region const dilateZones(std::vector<Region> const & zones,
+                             std::vector<Region> const & Bs) const;
+
+    //! @overload
+    Region const dilateZones(std::vector<WinP> const & zones,
+                             std::vector<Region> const & Bs) const;
+
 
     //! Generates the structuring element of choice.
     /*! Generates the structuring element of choice.
@@ -341,6 +869,47 @@ public:
      */
     static Region const generateStructuringElement(StructuringElement choice, int size);
 
+    //! Generates line-shaped structuring elements of several orientations.
+    /*! The digital line @em i through the origin has the angle
+     * @f$i \cdot 180^\circ / nrOrientations@f$ to the x-axis and its ends at a
+     * distance of @a size from the origin, so the line of angle 0 is the
+     * StructuringElementLine of @a size.
+     *
+     * @param size the half length of the lines
+     * @param nrOrientations the number of lines
+     * @return the lines, in ascending order of their angles
+     */
+    static std::vector<Region> const generateLineBank(int size, int nrOrientations);
+
+    //@}
+
+    /***********************************/
+    /*! @name Distance Transform
+     * The exact Euclidean distance of each pixel of the Region to the
+     * nearest pixel outside. The vertical distances follow from the Rbo's
+     * row by row, then a lower envelope of parabolas per row yields the
+     * squared distances without any rounding.
+     */
+    //@{
+
+    //! Distances to the complement as image.
+    /*! The image covers the bounding box, its pixel (0, 0) is the upper left
+     * corner of the bounding box. Each distance is multiplied by @a scale,
+     * rounded and saturated at 32767. Pixels outside the Region are 0.
+     * @throw EmptyRegionError, if Region empty.
+     */
+    PictImg<N16> const distanceTransform(F64 scale = 1) const;
+
+    //! Erosion by the disk of all points with a distance of at most @a radius to (0, 0).
+    /*! Same as erode2cut with this disk, but the cost does not depend on
+     * @a radius: the pixels with a distance to the complement greater than
+     * @a radius are kept.
+     * @throw ParameterError, if @a radius is negative.
+     */
+    Region const erodeDisk(F64 radius) const;
+
+    //! Erosions by disks of all @a radii, from one distance transform.
+    std::vector<Region> const erodeDisks(std::vector<F64> const & radii) const;
     //@}
 
     /***********************************/
@@ -361,6 +930,44 @@ public:
     //! Computes the Set Difference @a this - @a other.
     Region const subtract(Region const & other) const;
 
+    //! Symmetric Difference of two Regions.
+    /*! Computes the set of points belonging to exactly one of the object and
+     * @a other, i.e. <tt>subtract(other).unions(other.subtract(*this))</tt>.
+     */
+    Region const symmetricDifference(Region const & other) const;
+
+    //! Union of many Regions.
+    /*! Computes the union of all Regions in [@a first, @a last). The Rbo's of
+     * all Regions are merged in one pass with a heap (k-way merge), which is
+     * much faster than a sequence of calls to unions for many Regions.
+     *
+     * The Regions of a forward iterator yielding references are merged in
+     * place. Any other iterator may yield temporaries or reuse its storage,
+     * so its Regions are copied first.
+     */
+    template<typename InputIt>
+    static Region const unionAll(InputIt first, InputIt last) {
+        std::vector<Region> copies;
+        return unionAll(pointers(first, last, copies));
+    }
+
+    //! Union of the Regions pointed to by @a regs.
+    static Region const unionAll(std::vector<Region const *> const & regs);
+
+    //! Intersection of many Regions.
+    /*! Computes the intersection of all Regions in [@a first, @a last) with
+     * the same k-way merge as unionAll. The intersection of no Region is
+     * empty. The Regions are copied as in unionAll.
+     */
+    template<typename InputIt>
+    static Region const intersectAll(InputIt first, InputIt last) {
+        std::vector<Region> copies;
+        return intersectAll(pointers(first, last, copies));
+    }
+
+    //! Intersection of the Regions pointed to by @a regs.
+    static Region const intersectAll(std::vector<Region const *> const & regs);
+
     //! Computes the Set Complement.
     /*! Returns a new region containing the complement of the object. For the
      * complement @a universe is used as base set. If the object is not
@@ -370,6 +977,63 @@ public:
     Region const complement(WinP const * universe = 0) const;
     //@}
 
+    /***********************************/
+    /*! @name Areas of Set Operations.
+     * These methods count the pixels of the result of a set operation without
+     * building the resulting Region. Both Regions are traversed once.
+     */
+    //@{
+    //! Number of pixels of <tt>intersect(other)</tt>.
+    N32 intersectArea(Region const & other) const;
+
+    //! Number of pixels of <tt>unions(other)</tt>.
+    N32 unionArea(Region const & other) const;
+
+    //! Number of pixels belonging to exactly one of the two Regions.
+    /*! This is the Hamming distance between the two Regions as binary masks.
+     */
+    N32 xorArea(Region const & other) const;
+
+    //! Intersection over union.
+    /*! Returns intersectArea(@a other) / unionArea(@a other), or 0 if both
+     * Regions are empty.
+     */
+    F64 iou(Region const & other) const;
+    //@}
+
+    /***********************************/
+    /*! @name Parallel Operations.
+     * These are the same operations as the serial ones, but the Regions are
+     * split into bands of rows, which are processed by the Executor @a ex.
+     * The results of the bands are concatenated, so the result is identical
+     * to the one of the serial operation. Small Regions are processed
+     * serially.
+     */
+    //@{
+    //! Parallel thresholding of an image.
+    Region(PictImg<UN8> const & img,
+           N32 lo,
+           N32 hi,
+           Executor & ex);
+    //! @overload
+    Region(PictImg<N16> const & img,
+           N32 lo,
+           N32 hi,
+           Executor & ex);
+
+    //! Parallel union of two Regions.
+    Region const unions(Region const & other, Executor & ex) const;
+
+    //! Parallel intersection of two Regions.
+    Region const intersect(Region const & other, Executor & ex) const;
+
+    //! Parallel set complement.
+    Region const complement(WinP const * universe, Executor & ex) const;
+
+    //! Parallel clipping to a axis-parallel Window @a win.
+    Region & clip(WinP const & win, Executor & ex);
+    //@}
+
 
     /***********************************/
     //! @name Debug Output
@@ -395,7 +1059,7 @@ private:
     mutable Cache<WinP> bbox_;
 
     //! Area, cached.
-    /*! @see areaCenter
+    /*! @see area, areaCenter
      */
     mutable Cache<N32> area_;
 
@@ -412,6 +1076,13 @@ private:
     //! Recompute the bounding box.
     void computeBbox() const;
 
+    //! Recompute area, center and perimeter, see shape features.
+    /*! Stores the second order moments in @a mom and the Euler numbers for
+     * 4- and 8-connectivity in @a euler4 and @a euler8, if not null.
+     */
+    void computeFeatures(Moments * mom = 0,
+                         N32 * euler4 = 0, N32 * euler8 = 0) const;
+
     //! Invalidates all cached Data.
     void invalidateCaches();
 
@@ -419,8 +1090,115 @@ private:
     template<typename T>
     void createFromPic(PictImg<T> const & img, N32 lo, N32 hi);
 
+    //! Internal Template for parallel Binarization.
+    template<typename T>
+    void createFromPic(PictImg<T> const & img, N32 lo, N32 hi, Executor & ex);
+
+    /*! @name Operations on Ranges of Rbo's.
+     * The Rbo's [@a r, @a rend) and [@a s, @a send) must consist of whole
+     * rows. The resulting Rbo's are appended to @a res.
+     * These are the building blocks of the serial and parallel set operations.
+     */
+    //@{
+    //! Binarization of the scanlines [@a first, @a last) of the roi of @a img.
+    template<typename T>
+    static void binarizeRange(PictImg<T> const & img, N32 lo, N32 hi,
+                              RboIterator first, RboIterator last,
+                              Region & res);
+    static void unionRange(RboIterator r, RboIterator rend,
+                           RboIterator s, RboIterator send,
+                           Region & res);
+    static void intersectRange(RboIterator r, RboIterator rend,
+                               RboIterator s, RboIterator send,
+                               Region & res);
+    //! The complement of [@a r, @a rend) in the rows of @a universe.
+    static void complementRange(RboIterator r, RboIterator rend,
+                                WinP const & universe,
+                                Region & res);
+    static void clipRange(RboIterator r, RboIterator rend,
+                          WinP const & win,
+                          Region & res);
+    //! Append the Rbo's of @a parts to @a res.
+    static void concat(std::vector<Region> const & parts, Region & res);
+    //@}
+
+    //! The Regions [@a first, @a last) for unionAll and intersectAll.
+    /*! Refers to the Regions of a forward iterator yielding references,
+     * else copies them to @a copies and refers to the copies.
+     */
+    template<typename InputIt>
+    static std::vector<Region const *> pointers(InputIt first, InputIt last,
+                                                std::vector<Region> & copies) {
+        typedef std::iterator_traits<InputIt> Traits;
+        return pointers(first, last, copies, std::integral_constant<bool,
+                        std::is_lvalue_reference<typename Traits::reference>::value
+                        && std::is_base_of<std::forward_iterator_tag,
+                                           typename Traits::iterator_category>::value>());
+    }
+    //! @overload
+    template<typename InputIt>
+    static std::vector<Region const *> pointers(InputIt first, InputIt last,
+                                                std::vector<Region> &,
+                                                std::true_type) {
+        std::vector<Region const *> regs;
+        for ( ; first != last; ++first)
+            regs.push_back(&*first);
+        return regs;
+    }
+    //! @overload
+    template<typename InputIt>
+    static std::vector<Region const *> pointers(InputIt first, InputIt last,
+                                                std::vector<Region> & copies,
+                                                std::false_type) {
+        copies.assign(first, last);
+        std::vector<Region const *> regs;
+        for (auto & reg : copies)
+            regs.push_back(&reg);
+        return regs;
+    }
+
+    //! Binarization of the scanline [@a first, @a last) starting at @a start.
+    template<typename T>
+    static void binarizeRow(T const * first, T const * last, N32 lo, N32 hi,
+                            PointN16 const & start,
+                            Region & res);
+
+    //! Implementation of fromBuffer.
+    template<typename T>
+    static Region const thresholdBuffer(T const * data, N32 width, N32 height,
+                                        std::ptrdiff_t step, N32 lo, N32 hi,
+                                        PointN16 const & origin);
+
+    //! The @a width packed bits of fromBits starting at @a first in row @a start.
+    static void unpackRow(UN8 const * first, N32 width,
+                          PointN16 const & start,
+                          Region & res);
+
+    //! @name Decoders for Region::fromFile
+    //@{
+    static void readPng(std::string const & fn, N32 lo, N32 hi, Region & res);
+    static void readTiff(std::string const & fn, N32 lo, N32 hi, Region & res);
+    //@}
+
+    /*! @name Decoders of Bilevel Codes.
+     * Decode the @a height rows of [@a first, @a last) starting in row
+     * @a y0 and append the runs to @a res.
+     */
+    //@{
+    static void decodeG4(UN8 const * first, UN8 const * last,
+                         N32 width, N32 y0, N32 height,
+                         Region & res);
+    static void decodePackBits(UN8 const * first, UN8 const * last,
+                               N32 width, N32 y0, N32 height,
+                               Region & res);
+    //@}
+
     friend class PolygonRegionCreator; // necessary for 'add(Rbo(...))'
     friend class EllipticRegionCreator; // necessary for 'add(Rbo(...))'
+    friend class MappedRegion; // necessary for the operations on ranges
+    friend class PackedRegion; // necessary for the operations on ranges
+    friend class HybridRegion; // necessary for 'binarizeRange'
+    friend class PackedMask; // necessary for 'rbos_.push_back'
 
     /*! @name Serialization
      * @sa @ref serialization
@@ -433,9 +1211,10 @@ private:
     }
     template<typename Archive>
     void load(Archive & ar, UN32 /*version*/) {
-        Region tmp;
-        ar >> boost::serialization::make_nvp(BOOST_PP_STRINGIZE(rbos_), tmp.rbos_);
-        *this = tmp;
+        std::vector<Rbo> tmp;
+        ar >> boost::serialization::make_nvp(BOOST_PP_STRINGIZE(rbos_), tmp);
+        rbos_.swap(tmp);
+        this->invalidateCaches();
     }
     BOOST_SERIALIZATION_SPLIT_MEMBER();
     //@}
@@ -448,18 +1227,143 @@ private:
     struct erosTransPoint;
     struct RetGenerateErosionTransformX;
     struct RetGenerateErosionTransformX2;
+    struct Erode2cutScan;
 
     static RetGenerateSkeletonB const generateSkeletonBtrans(Region B, Point<N16> transVector);
     static RetGenerateSkeletonB const generateSkeletonB(Region B, Point<N16> transVector);
     RetGenerateErosionTransformX const generateErosionTransformX(Region B, N16 lmin) const;
     RetGenerateErosionTransformX const generateErosionTransformX2(Region B, N16 lmin) const;
-    RetGenerateErosionTransformX const generateErosionTransformX2cut(Region B, N16 lmin, N16 lmax) const;
     RetGenerateErosionTransformX const generateErosionTransformXcomp(Region B, N16 lmin) const;
     RetGenerateErosionTransformX const generateErosionTransformXcompcut(Region B, N16 lmin, N16 lmax) const;
     RetGenerateErosionTransformX const generateExtErosionTransformX(Region B, N16 lmin) const;
+    std::vector<Region> const erodeInZones(std::vector<Region> const & zones,
+                                           std::vector<Region> const & Bs) const;
     //@}
 };
 
+//! Lazily evaluated erosion.
+/*! This is the result of Region::erode2cutLazy. The erosion-transform and the
+ * jump-miss/jump-hit scan of Region::erode2cut are evaluated row by row on
+ * demand, so a query pays only for the rows it touches:
+ * - includes() and row() scan a single row,
+ * - intersect() scans only the rows of the other Region,
+ * - the iteration through the Rbo's computes the next row only when the
+ *   previous one is consumed, so the first hit is simply <tt>*begin()</tt>.
+ *
+ * @code
+ * Region::LazyErosion const e = X.erode2cutLazy(B);
+ * auto first = e.begin();
+ * if (first != e.end())
+ *     // B fits into X, the first position is first->start()
+ * @endcode
+ *
+ * The object refers to the eroded Region, which is not copied, so the
+ * Region must outlive the LazyErosion and all its iterators. In particular
+ * the erosion of a temporary Region must not be stored. The rows of the
+ * erosion-transform are allocated when a query reaches them, so the memory
+ * grows with the rows touched and not with the bounding box.
+ *
+ * Copies of a LazyErosion and its iterators share the state, so an iterator
+ * stays valid after the LazyErosion it came from is destroyed. As the state
+ * is shared, a LazyErosion must not be used concurrently from several
+ * threads.
+ */
+class Region::LazyErosion
+{
+    struct Impl;
+public:
+
+    //! Iterator over the Rbo's of the erosion.
+    /*! A forward iterator, which computes the rows of the erosion while
+     * advancing.
+     */
+    class Iterator
+    {
+    public:
+        //! @name iterator traits
+        //@{
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Rbo value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef Rbo const * pointer;
+        typedef Rbo const & reference;
+        //@}
+
+        //! ctr, an iterator equal only to other default constructed ones
+        Iterator();
+
+        //! Dereference
+        Rbo const & operator*() const {
+            return rbos_[idx_];
+        }
+        //! Dereference
+        Rbo const * operator->() const {
+            return &rbos_[idx_];
+        }
+        //! Next Rbo, computes the next rows if necessary.
+        Iterator & operator++();
+        //! Postincrement
+        Iterator operator++(int) {
+            Iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+        //! Equality
+        bool operator==(Iterator const & rhs) const {
+            return row_ == rhs.row_ && idx_ == rhs.idx_;
+        }
+        //! Inequality
+        bool operator!=(Iterator const & rhs) const {
+            return !(*this == rhs);
+        }
+    private:
+        friend class LazyErosion;
+        //! ctr, positioned at the row of the object starting at @a row.
+        Iterator(boost::shared_ptr<Impl> const & impl, RboIterator row);
+        //! Scan the rows starting at @a row_ until we find a hit.
+        void nextHits();
+
+        //! the erosion, shared with the LazyErosion
+        boost::shared_ptr<Impl> impl_;
+        //! first Rbo of the actual row in the eroded Region
+        RboIterator row_;
+        //! behind the last Rbo of the actual row in the eroded Region
+        RboIterator rowEnd_;
+        //! the hits of the actual row
+        std::vector<Rbo> rbos_;
+        //! index into @a rbos_
+        std::size_t idx_;
+    };
+
+    //! ctr
+    /*! Prepares the erosion of @a X by @a B, without computing any row.
+     */
+    LazyErosion(Region const & X, Region const & B);
+
+    //! Iterator to the first Rbo of the erosion.
+    Iterator begin() const;
+
+    //! Iterator behind the last Rbo of the erosion.
+    Iterator end() const;
+
+    //! Computes the row @a y of the erosion and appends its Rbo's to @a rbos.
+    void row(N16 y, std::vector<Rbo> & rbos) const;
+
+    //! Check if the erosion includes the Point @a pt.
+    /*! Only the row of @a pt is scanned, and only up to @a pt.
+     */
+    bool includes(PointN16 const & pt) const;
+
+    //! Intersection with a Region.
+    /*! Only the rows of @a other are computed.
+     */
+    Region const intersect(Region const & other) const;
+
+private:
+    //! the shared state
+    boost::shared_ptr<Impl> impl_;
+};
+
 IPL_NS_END
 
 #endif
@@ -0,0 +1,249 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Implementation of ipl::Blobs
+ *
+ ********************************************************************/
+
+#include "ipl/blobs.hh"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "ipl/executor.hh"
+#include "ipl/iplerr.hh"
+
+using namespace std;
+
+IPL_NS_BEGIN
+
+IPL_ANON_NS_BEGIN
+
+//! Minimal number of Rbo's of a band of the parallel labelling.
+N32 const minRbosPerBand = 4096;
+
+//! Union-find over the indices of the Rbo's.
+/*! The root of a set is its smallest index, so the roots appear in the order
+ * of the first Rbo's of the blobs. Sets of disjoint ranges of indices may be
+ * merged concurrently.
+ */
+class UnionFind
+{
+public:
+    //! ctr, @a n singletons
+    explicit UnionFind(N32 n)
+        : parent_(n) {
+        iota(parent_.begin(), parent_.end(), 0);
+    }
+    //! The root of @a i, with path halving.
+    N32 find(N32 i) {
+        while (parent_[i] != i) {
+            parent_[i] = parent_[parent_[i]];
+            i = parent_[i];
+        }
+        return i;
+    }
+    //! Merges the sets of @a a and @a b.
+    void unite(N32 a, N32 b) {
+        a = this->find(a);
+        b = this->find(b);
+        if (a < b)
+            parent_[b] = a;
+        else if (b < a)
+            parent_[a] = b;
+    }
+private:
+    vector<N32> parent_;
+};
+
+//! Merges the overlapping Rbo's of two adjacent rows.
+/*! The rows are [@a p, @a pend) and [@a c, @a cend) of the Rbo's starting at
+ * @a base. Two Rbo's overlap, if there are at most @a slack pixels between
+ * them in x.
+ */
+void
+connectRows(Region::RboIterator base,
+            Region::RboIterator p, Region::RboIterator pend,
+            Region::RboIterator c, Region::RboIterator cend,
+            N32 slack, UnionFind & uf)
+{
+    while (p != pend && c != cend) {
+        N32 const pe = p->start().x_ + p->len() - 1,
+            ce = c->start().x_ + c->len() - 1;
+        if (p->start().x_ <= ce + slack && c->start().x_ <= pe + slack)
+            uf.unite(p - base, c - base);
+        if (pe < ce)
+            ++p;
+        else
+            ++c;
+    }
+}
+
+//! End of the row starting at @a first.
+inline Region::RboIterator
+rowEnd(Region::RboIterator first, Region::RboIterator last)
+{
+    N32 const y = first->start().y_;
+    while (first != last && first->start().y_ == y)
+        ++first;
+    return first;
+}
+
+//! Merges the Rbo's [@a first, @a last) of whole rows.
+void
+connectBand(Region::RboIterator base,
+            Region::RboIterator first, Region::RboIterator last,
+            N32 slack, UnionFind & uf)
+{
+    Region::RboIterator prev = last, prevEnd = last;
+    while (first != last) {
+        Region::RboIterator const end = rowEnd(first, last);
+        if (prev != last && prev->start().y_ + 1 == first->start().y_)
+            connectRows(base, prev, prevEnd, first, end, slack, uf);
+        prev = first;
+        prevEnd = end;
+        first = end;
+    }
+}
+
+//! Numbers the sets of @a uf in the order of their roots.
+N32
+numberSets(UnionFind & uf, vector<N32> & labels)
+{
+    N32 nr = 0;
+    for (N32 i = 0; i < static_cast<N32>(labels.size()); ++i) {
+        N32 const root = uf.find(i);
+        labels[i] = root == i ? nr++ : labels[root];
+    }
+    return nr;
+}
+
+//! Number of pixels between two neighbouring Rbo's.
+inline N32
+slackOf(Blobs::Connectivity conn)
+{
+    return conn == Blobs::Connect8 ? 1 : 0;
+}
+
+IPL_ANON_NS_END
+
+Blobs::Blobs()
+{}
+
+Blobs::Blobs(Region const & reg, Connectivity conn)
+{
+    this->split(reg, labelRuns(reg, labels_, conn));
+}
+
+Blobs::Blobs(Region const & reg, Connectivity conn, Executor & ex)
+{
+    this->split(reg, labelRuns(reg, labels_, conn, ex));
+}
+
+N32
+Blobs::labelRuns(Region const & reg, std::vector<N32> & labels,
+                 Connectivity conn)
+{
+    IPL_ASSERT_VALID(reg);
+    UnionFind uf(reg.nrRbos());
+    connectBand(reg.begin(), reg.begin(), reg.end(), slackOf(conn), uf);
+    labels.resize(reg.nrRbos());
+    return numberSets(uf, labels);
+}
+
+/*! @internal The bands hold about the same number of Rbo's. Each band
+ * merges only its own Rbo's, so the union-find is shared without locks.
+ * The last row of each band is then merged with the first row of the next
+ * band and the sets are numbered serially.
+ */
+N32
+Blobs::labelRuns(Region const & reg, std::vector<N32> & labels,
+                 Connectivity conn, Executor & ex)
+{
+    IPL_ASSERT_VALID(reg);
+    N32 const n = max<N32>(1, min<N32>(ex.nrThreads(), reg.nrRbos() / minRbosPerBand));
+    if (n == 1)
+        return labelRuns(reg, labels, conn);
+
+    // bands of whole rows
+    vector<Region::RboIterator> bounds(1, reg.begin());
+    for (N32 k = 1; k < n; ++k) {
+        Region::RboIterator const b = rowEnd(reg.begin() + (N64(reg.nrRbos()) * k) / n - 1,
+                                             reg.end());
+        if (b != reg.end() && b > bounds.back())
+            bounds.push_back(b);
+    }
+    bounds.push_back(reg.end());
+    IPLLOG_INFO(IPL_FNC_NAME << " of " << reg << " in " << bounds.size() - 1 << " bands");
+
+    N32 const slack = slackOf(conn);
+    UnionFind uf(reg.nrRbos());
+    ex.run(bounds.size() - 1, [&](N32 k) {
+            connectBand(reg.begin(), bounds[k], bounds[k + 1], slack, uf);
+        });
+    for (size_t k = 1; k + 1 < bounds.size(); ++k) {
+        Region::RboIterator prev = bounds[k] - 1;
+        N32 const y = prev->start().y_;
+        while (prev != bounds[k - 1] && (prev - 1)->start().y_ == y)
+            --prev;
+        if (y + 1 == bounds[k]->start().y_)
+            connectRows(reg.begin(), prev, bounds[k],
+                        bounds[k], rowEnd(bounds[k], bounds[k + 1]), slack, uf);
+    }
+    labels.resize(reg.nrRbos());
+    return numberSets(uf, labels);
+}
+
+void
+Blobs::split(Region const & reg, N32 nrBlobs)
+{
+    blobs_.resize(nrBlobs);
+    vector<N32>::const_iterator l = labels_.begin();
+    for (Region::RboIterator r = reg.begin(); r != reg.end(); ++r, ++l)
+        blobs_[*l].add(*r);
+    IPL_ASSERT_VALID(*this);
+}
+
+N32
+Blobs::find(PointN16 const & pt) const
+{
+    for (size_t i = 0; i < blobs_.size(); ++i)
+        if (blobs_[i].boundingBox().includes(pt) && blobs_[i].includes(pt))
+            return i;
+    return -1;
+}
+
+std::ostream &
+Blobs::print(std::ostream & os) const
+{
+    return os << this->size() << " blobs of " << labels_.size() << " rbos";
+}
+
+/*! @internal The blobs must be valid and not empty and hold all the
+ * labelled Rbo's.
+ */
+bool
+Blobs::validate() const
+{
+    size_t nrRbos = 0;
+    for (size_t i = 0; i < blobs_.size(); ++i) {
+        if (blobs_[i].empty() || !blobs_[i].validate()) {
+            IPLLOG_ERROR(IPL_FNC_NAME << ": invalid blob " << i);
+            return false;
+        }
+        nrRbos += blobs_[i].nrRbos();
+    }
+    if (nrRbos != labels_.size()) {
+        IPLLOG_ERROR(IPL_FNC_NAME << ": " << nrRbos << " rbos in the blobs, "
+                     << labels_.size() << " labels");
+        return false;
+    }
+    return true;
+}
+
+IPL_NS_END
@@ -0,0 +1,207 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Implementation of ipl::Executor
+ *
+ ********************************************************************/
+
+#include "ipl/executor.hh"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include "ipl/iplerr.hh"
+
+using namespace std;
+
+IPL_NS_BEGIN
+
+IPL_ANON_NS_BEGIN
+
+//! A call of Executor::run.
+struct Job {
+    //! ctr
+    Job(N32 n, function<void (N32)> const & t)
+        : task(t), nrTasks(n), next(0), done(0) {
+    }
+    //! the task
+    function<void (N32)> const & task;
+    //! number of tasks
+    N32 const nrTasks;
+    //! next task to start
+    N32 next;
+    //! number of finished tasks
+    N32 done;
+    //! the first exception thrown by a task
+    exception_ptr error;
+    //! signaled when all tasks are finished
+    condition_variable finished;
+};
+
+IPL_ANON_NS_END
+
+//! Implementation of Executor.
+/*! All the bookkeeping is protected by @a mutex_, only the tasks themselves
+ * run unlocked. The tasks of the parallel algorithms are coarse (bands of
+ * rows), so the lock is not contended.
+ */
+class ExecutorImpl
+{
+public:
+    //! ctr, starts @a nrWorkers threads
+    explicit ExecutorImpl(N32 nrWorkers)
+        : stop_(false) {
+        for (N32 i = 0; i < nrWorkers; ++i)
+            workers_.push_back(thread(&ExecutorImpl::work, this));
+    }
+    //! dtr, stops the threads
+    ~ExecutorImpl() {
+        {
+            lock_guard<mutex> lk(mutex_);
+            stop_ = true;
+        }
+        wakeup_.notify_all();
+        for (auto & t : workers_)
+            t.join();
+    }
+    //! number of threads of the pool
+    N32 nrWorkers() const {
+        return workers_.size();
+    }
+    //! Executor::run
+    void run(Job & job) {
+        unique_lock<mutex> lk(mutex_);
+        jobs_.push_back(&job);
+        wakeup_.notify_all();
+        execute(lk, job);
+        job.finished.wait(lk, [&job] { return job.done == job.nrTasks; });
+        if (job.error)
+            rethrow_exception(job.error);
+    }
+private:
+    //! Execute tasks of @a job until all are started; @a lk must be locked.
+    /*! The job is removed from the queue with its last task, so no thread
+     * touches it after it is finished.
+     */
+    void execute(unique_lock<mutex> & lk, Job & job) {
+        while (job.next < job.nrTasks) {
+            N32 const i = job.next++;
+            if (job.next == job.nrTasks)
+                jobs_.erase(find(jobs_.begin(), jobs_.end(), &job));
+            lk.unlock();
+            exception_ptr error;
+            try {
+                job.task(i);
+            } catch (...) {
+                error = current_exception();
+            }
+            lk.lock();
+            if (error && !job.error)
+                job.error = error;
+            if (++job.done == job.nrTasks)
+                job.finished.notify_all();
+        }
+    }
+    //! Main loop of a worker thread.
+    void work() {
+        unique_lock<mutex> lk(mutex_);
+        for (;;) {
+            wakeup_.wait(lk, [this] { return stop_ || !jobs_.empty(); });
+            if (stop_)
+                return;
+            execute(lk, *jobs_.front());
+        }
+    }
+
+    //! the worker threads
+    vector<thread> workers_;
+    //! the jobs with tasks to start
+    deque<Job *> jobs_;
+    //! protects @a jobs_, @a stop_ and the counters of the jobs
+    mutex mutex_;
+    //! signaled on a new job or on stop
+    condition_variable wakeup_;
+    //! stop the workers
+    bool stop_;
+};
+
+/*! @internal The calling thread executes tasks, too, therefore we start
+ * one thread less.
+ */
+Executor::Executor(N32 nrThreads /*= 0*/)
+{
+    if (nrThreads < 0)
+        throw ParameterError(1, IPL_FNC_NAME);
+    if (nrThreads == 0)
+        nrThreads = max<N32>(thread::hardware_concurrency(), 1);
+    impl_.reset(new ExecutorImpl(nrThreads - 1));
+}
+
+Executor::~Executor()
+{
+}
+
+N32
+Executor::nrThreads() const
+{
+    return impl_->nrWorkers() + 1;
+}
+
+void
+Executor::run(N32 nrTasks, function<void (N32)> const & task)
+{
+    if (nrTasks <= 0)
+        return;
+    if (nrTasks == 1 || impl_->nrWorkers() == 0) {
+        exception_ptr error;
+        for (N32 i = 0; i < nrTasks; ++i) {
+            try {
+                task(i);
+            } catch (...) {
+                if (!error)
+                    error = current_exception();
+            }
+        }
+        if (error)
+            rethrow_exception(error);
+        return;
+    }
+    Job job(nrTasks, task);
+    impl_->run(job);
+}
+
+IPL_ANON_NS_BEGIN
+
+//! The library-wide executor.
+boost::shared_ptr<Executor> &
+globalExecutor()
+{
+    static boost::shared_ptr<Executor> ex(new Executor());
+    return ex;
+}
+
+IPL_ANON_NS_END
+
+Executor &
+Executor::global()
+{
+    return *globalExecutor();
+}
+
+void
+Executor::setGlobalThreads(N32 nrThreads)
+{
+    globalExecutor().reset(new Executor(nrThreads));
+}
+
+IPL_NS_END
@@ -0,0 +1,503 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Implementation of ipl::HybridRegion
+ *
+ ********************************************************************/
+
+#include "ipl/hybridregion.hh"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "ipl/pict.hh"
+#include "ipl/iplerr.hh"
+#include "ipl/mathli.hh"
+
+using namespace std;
+
+IPL_NS_BEGIN
+
+IPL_ANON_NS_BEGIN
+
+//! Marks a run row.
+N32 const noBitmap = numeric_limits<N32>::min();
+
+//! Offset of the x coordinates, such that the bit positions are positive.
+N32 const xOffset = 32768;
+
+//! Word of the pixel @a x.
+inline N32
+wordOf(N32 x)
+{
+    return (x + xOffset) >> 6;
+}
+
+//! Position of the pixel @a x in its word.
+inline N32
+bitOf(N32 x)
+{
+    return (x + xOffset) & 63;
+}
+
+//! The x coordinate of the first pixel of the word @a w.
+inline N32
+xOf(N32 w)
+{
+    return w * 64 - xOffset;
+}
+
+//! Check if a row of @a nrRuns runs in @a nrWords words is stored as bitmap.
+inline bool
+bitmapIsSmaller(N32 nrRuns, N32 nrWords)
+{
+    return 2 * nrWords < nrRuns;
+}
+
+//! Sets the pixels [@a xs, @a xe] in the bitmap @a words starting at word @a w0.
+inline void
+setBits(UN64 * words, N32 w0, N32 xs, N32 xe)
+{
+    N32 const ws = wordOf(xs) - w0,
+        we = wordOf(xe) - w0;
+    UN64 const ms = ~UN64(0) << bitOf(xs),
+        me = ~UN64(0) >> (63 - bitOf(xe));
+    if (ws == we) {
+        words[ws] |= ms & me;
+        return;
+    }
+    words[ws] |= ms;
+    fill(words + ws + 1, words + we, ~UN64(0));
+    words[we] |= me;
+}
+
+//! Number of runs in the bitmap [@a first, @a last).
+inline N32
+countRuns(UN64 const * first, UN64 const * last)
+{
+    N32 n = 0;
+    UN64 carry = 0;
+    for (; first != last; ++first) {
+        n += mathli::bitCount(*first & ~(*first << 1 | carry));
+        carry = *first >> 63;
+    }
+    return n;
+}
+
+//! Calls @a f(xs, xe) for the runs of the bitmap [@a first, @a last) starting at word @a w0.
+template<typename F>
+void
+forEachRun(UN64 const * first, UN64 const * last, N32 w0, F f)
+{
+    bool open = false;
+    N32 xs = 0, x = xOf(w0);
+    for (; first != last; ++first, x += 64) {
+        UN64 const v = *first;
+        N32 pos = 0;
+        while (pos < 64) {
+            UN64 const rest = (open ? ~v : v) >> pos;
+            if (rest == 0)
+                break;
+            pos += mathli::lowestBit(rest);
+            if (open)
+                f(xs, x + pos - 1);
+            else
+                xs = x + pos;
+            open = !open;
+        }
+    }
+    if (open)
+        f(xs, x - 1);
+}
+
+//! @name Set Operations of Runs.
+/*! The runs [@a a, @a ae) and [@a b, @a be) are combined and appended to
+ * @a res.
+ */
+//@{
+template<typename Run>
+void
+unionRuns(Run const * a, Run const * ae, Run const * b, Run const * be,
+          vector<Run> & res)
+{
+    while (a != ae || b != be) {
+        Run const & r = (b == be || (a != ae && a->xs_ < b->xs_)) ? *a++ : *b++;
+        if (!res.empty() && r.xs_ <= res.back().xe_ + 1)
+            res.back().xe_ = max(res.back().xe_, r.xe_);
+        else
+            res.push_back(r);
+    }
+}
+
+template<typename Run>
+void
+intersectRuns(Run const * a, Run const * ae, Run const * b, Run const * be,
+              vector<Run> & res)
+{
+    while (a != ae && b != be) {
+        Run const r = { max(a->xs_, b->xs_), min(a->xe_, b->xe_) };
+        if (r.xs_ <= r.xe_)
+            res.push_back(r);
+        if (a->xe_ < b->xe_)
+            ++a;
+        else
+            ++b;
+    }
+}
+
+template<typename Run>
+void
+subtractRuns(Run const * a, Run const * ae, Run const * b, Run const * be,
+             vector<Run> & res)
+{
+    for (; a != ae; ++a) {
+        N32 xs = a->xs_;
+        while (b != be && b->xe_ < xs)
+            ++b;
+        for (Run const * t = b; t != be && t->xs_ <= a->xe_; ++t) {
+            if (t->xs_ > xs) {
+                Run const r = { N16(xs), N16(t->xs_ - 1) };
+                res.push_back(r);
+            }
+            xs = t->xe_ + 1;
+        }
+        if (xs <= a->xe_) {
+            Run const r = { N16(xs), a->xe_ };
+            res.push_back(r);
+        }
+    }
+}
+//@}
+
+IPL_ANON_NS_END
+
+HybridRegion::HybridRegion()
+{}
+
+HybridRegion::HybridRegion(Region const & reg)
+{
+    IPL_ASSERT_VALID(reg);
+    vector<Run> runs;
+    for (auto r = reg.begin(); r != reg.end(); ) {
+        N32 const y = r->start().y_;
+        runs.clear();
+        for (; r != reg.end() && r->start().y_ == y; ++r) {
+            Run const run = { r->start().x_, N16(r->start().x_ + r->len() - 1) };
+            runs.push_back(run);
+        }
+        this->addRuns(y, runs.data(), runs.data() + runs.size());
+    }
+    IPL_ASSERT_VALID(*this);
+}
+
+/*! @internal The scanlines of the roi are binarized row by row into a
+ * temporary Region.
+ */
+HybridRegion::HybridRegion(PictImg<UN8> const & img, N32 lo, N32 hi)
+{
+    IPL_ASSERT_VALID(img);
+    if (lo > hi) {
+        IPLLOG_WARN(IPL_FNC_NAME << " empty binarization range " << PointN16(lo,hi));
+        return;
+    }
+    Region row;
+    vector<Run> runs;
+    for (auto scan = img.rboBegin(); scan != img.rboEnd(); ) {
+        auto last = scan;
+        while (last != img.rboEnd() && last->start().y_ == scan->start().y_)
+            ++last;
+        row.rbos_.clear();
+        Region::binarizeRange(img, lo, hi, scan, last, row);
+        runs.clear();
+        for (auto r = row.begin(); r != row.end(); ++r) {
+            Run const run = { r->start().x_, N16(r->start().x_ + r->len() - 1) };
+            runs.push_back(run);
+        }
+        if (!runs.empty())
+            this->addRuns(scan->start().y_, runs.data(), runs.data() + runs.size());
+        scan = last;
+    }
+    IPL_ASSERT_VALID(*this);
+}
+
+void
+HybridRegion::addRuns(N32 y, Run const * first, Run const * last)
+{
+    if (first == last)
+        return;
+    N32 const w0 = wordOf(first->xs_),
+        nrWords = wordOf((last - 1)->xe_) - w0 + 1;
+    if (bitmapIsSmaller(last - first, nrWords)) {
+        Row const row = { y, w0, UN32(words_.size()), UN32(nrWords) };
+        words_.resize(words_.size() + nrWords, 0);
+        for (; first != last; ++first)
+            setBits(&words_[row.first_], w0, first->xs_, first->xe_);
+        rows_.push_back(row);
+    } else {
+        Row const row = { y, noBitmap, UN32(runs_.size()), UN32(last - first) };
+        runs_.insert(runs_.end(), first, last);
+        rows_.push_back(row);
+    }
+}
+
+void
+HybridRegion::addBits(N32 y, N32 word0, UN64 const * first, UN64 const * last)
+{
+    while (first != last && *first == 0) {
+        ++first;
+        ++word0;
+    }
+    while (first != last && *(last - 1) == 0)
+        --last;
+    if (first == last)
+        return;
+    if (bitmapIsSmaller(countRuns(first, last), last - first)) {
+        Row const row = { y, word0, UN32(words_.size()), UN32(last - first) };
+        words_.insert(words_.end(), first, last);
+        rows_.push_back(row);
+    } else {
+        Row const row = { y, noBitmap, UN32(runs_.size()), 0 };
+        forEachRun(first, last, word0, [this](N32 xs, N32 xe) {
+                Run const run = { N16(xs), N16(xe) };
+                runs_.push_back(run);
+            });
+        rows_.push_back(row);
+        rows_.back().size_ = runs_.size() - row.first_;
+    }
+}
+
+void
+HybridRegion::copyRow(HybridRegion const & src, Row const & row)
+{
+    Row r = row;
+    if (row.word0_ == noBitmap) {
+        r.first_ = runs_.size();
+        runs_.insert(runs_.end(), src.runs_.begin() + row.first_,
+                     src.runs_.begin() + row.first_ + row.size_);
+    } else {
+        r.first_ = words_.size();
+        words_.insert(words_.end(), src.words_.begin() + row.first_,
+                      src.words_.begin() + row.first_ + row.size_);
+    }
+    rows_.push_back(r);
+}
+
+Region const
+HybridRegion::region() const
+{
+    Region reg;
+    for (auto row = rows_.begin(); row != rows_.end(); ++row) {
+        N32 const y = row->y_;
+        if (row->word0_ == noBitmap) {
+            Run const * const first = runs_.data() + row->first_;
+            for (Run const * r = first; r != first + row->size_; ++r)
+                reg.rbos_.push_back(Rbo(PointN16(r->xs_, y), r->xe_ - r->xs_ + 1));
+        } else {
+            UN64 const * const w = words_.data() + row->first_;
+            forEachRun(w, w + row->size_, row->word0_, [&reg, y](N32 xs, N32 xe) {
+                    reg.rbos_.push_back(Rbo(PointN16(xs, y), xe - xs + 1));
+                });
+        }
+    }
+    IPL_ASSERT_VALID(reg);
+    return reg;
+}
+
+N32
+HybridRegion::nrBitmapRows() const
+{
+    N32 n = 0;
+    for (auto row = rows_.begin(); row != rows_.end(); ++row)
+        n += row->word0_ != noBitmap;
+    return n;
+}
+
+N32
+HybridRegion::area() const
+{
+    N32 a = 0;
+    for (auto r = runs_.begin(); r != runs_.end(); ++r)
+        a += r->xe_ - r->xs_ + 1;
+    for (auto w = words_.begin(); w != words_.end(); ++w)
+        a += mathli::bitCount(*w);
+    return a;
+}
+
+std::size_t
+HybridRegion::size() const
+{
+    return rows_.size() * sizeof(Row) + runs_.size() * sizeof(Run)
+        + words_.size() * sizeof(UN64);
+}
+
+bool
+HybridRegion::includes(PointN16 const & pt) const
+{
+    auto const row = lower_bound(rows_.begin(), rows_.end(), pt.y_,
+                                 [](Row const & r, N32 y) { return r.y_ < y; });
+    if (row == rows_.end() || row->y_ != pt.y_)
+        return false;
+    if (row->word0_ != noBitmap) {
+        N32 const w = wordOf(pt.x_) - row->word0_;
+        return w >= 0 && w < N32(row->size_)
+            && (words_[row->first_ + w] >> bitOf(pt.x_) & 1);
+    }
+    Run const * const first = runs_.data() + row->first_;
+    Run const * const r = upper_bound(first, first + row->size_, pt.x_,
+                                      [](N32 x, Run const & s) { return x < s.xs_; });
+    return r != first && pt.x_ <= (r - 1)->xe_;
+}
+
+HybridRegion const
+HybridRegion::unions(HybridRegion const & other) const
+{
+    return this->combine(other, Union);
+}
+
+HybridRegion const
+HybridRegion::intersect(HybridRegion const & other) const
+{
+    return this->combine(other, Intersection);
+}
+
+HybridRegion const
+HybridRegion::subtract(HybridRegion const & other) const
+{
+    return this->combine(other, Difference);
+}
+
+/*! @internal Rows of only one Region are copied or dropped. Two run rows are
+ * merged, in any other case both rows are converted to bitmaps over the
+ * words of the result, which are combined word by word.
+ */
+HybridRegion const
+HybridRegion::combine(HybridRegion const & other, Op op) const
+{
+    IPL_ASSERT_VALID(*this);
+    IPL_ASSERT_VALID(other);
+    HybridRegion res;
+    vector<Run> runs;
+    vector<UN64> a, b;
+    // the words [w0, w1) of the row @a row of @a src
+    auto const toBits = [](HybridRegion const & src, Row const & row,
+                           N32 w0, N32 w1, vector<UN64> & bits) {
+        bits.assign(w1 - w0, 0);
+        if (row.word0_ != noBitmap) {
+            N32 const c0 = max(w0, row.word0_),
+                c1 = min(w1, row.word0_ + N32(row.size_));
+            if (c0 < c1)
+                copy(src.words_.begin() + row.first_ + c0 - row.word0_,
+                     src.words_.begin() + row.first_ + c1 - row.word0_,
+                     bits.begin() + (c0 - w0));
+            return;
+        }
+        Run const * const first = src.runs_.data() + row.first_;
+        for (Run const * t = first; t != first + row.size_; ++t) {
+            N32 const xs = max<N32>(t->xs_, xOf(w0)),
+                xe = min<N32>(t->xe_, xOf(w1) - 1);
+            if (xs <= xe)
+                setBits(bits.data(), w0, xs, xe);
+        }
+    };
+    auto r = rows_.begin(), s = other.rows_.begin();
+    while (r != rows_.end() || s != other.rows_.end()) {
+        if (s == other.rows_.end() || (r != rows_.end() && r->y_ < s->y_)) {
+            if (op != Intersection)
+                res.copyRow(*this, *r);
+            ++r;
+            continue;
+        }
+        if (r == rows_.end() || s->y_ < r->y_) {
+            if (op == Union)
+                res.copyRow(other, *s);
+            ++s;
+            continue;
+        }
+
+        Run const * const ra = runs_.data() + r->first_;
+        Run const * const rb = other.runs_.data() + s->first_;
+        if (r->word0_ == noBitmap && s->word0_ == noBitmap) {
+            runs.clear();
+            if (op == Union)
+                unionRuns(ra, ra + r->size_, rb, rb + s->size_, runs);
+            else if (op == Intersection)
+                intersectRuns(ra, ra + r->size_, rb, rb + s->size_, runs);
+            else
+                subtractRuns(ra, ra + r->size_, rb, rb + s->size_, runs);
+            res.addRuns(r->y_, runs.data(), runs.data() + runs.size());
+        } else {
+            // words [w0, w1) of both rows
+            N32 const aw0 = r->word0_ != noBitmap ? r->word0_ : wordOf(ra->xs_),
+                aw1 = r->word0_ != noBitmap ? aw0 + N32(r->size_)
+                : wordOf(ra[r->size_ - 1].xe_) + 1,
+                bw0 = s->word0_ != noBitmap ? s->word0_ : wordOf(rb->xs_),
+                bw1 = s->word0_ != noBitmap ? bw0 + N32(s->size_)
+                : wordOf(rb[s->size_ - 1].xe_) + 1;
+            N32 const w0 = op == Union ? min(aw0, bw0)
+                : op == Intersection ? max(aw0, bw0) : aw0,
+                w1 = op == Union ? max(aw1, bw1)
+                : op == Intersection ? min(aw1, bw1) : aw1;
+            if (w0 < w1) {
+                toBits(*this, *r, w0, w1, a);
+                toBits(other, *s, w0, w1, b);
+                for (size_t k = 0; k < a.size(); ++k) {
+                    if (op == Union)
+                        a[k] |= b[k];
+                    else if (op == Intersection)
+                        a[k] &= b[k];
+                    else
+                        a[k] &= ~b[k];
+                }
+                res.addBits(r->y_, w0, a.data(), a.data() + a.size());
+            }
+        }
+        ++r;
+        ++s;
+    }
+    IPL_ASSERT_VALID(res);
+    return res;
+}
+
+std::ostream &
+HybridRegion::print(std::ostream & os) const
+{
+    return os << "hybrid region with " << this->nrRows() << " rows, "
+              << this->nrBitmapRows() << " of them bitmaps, in "
+              << this->size() << " bytes";
+}
+
+/*! @internal The rows must be sorted and not empty, the runs of a row sorted
+ * and not adjacent and the bitmaps must not start or end with an empty word.
+ */
+bool
+HybridRegion::validate() const
+{
+    for (auto row = rows_.begin(); row != rows_.end(); ++row) {
+        bool ok = row->size_ > 0
+            && (row == rows_.begin() || (row - 1)->y_ < row->y_);
+        if (row->word0_ == noBitmap) {
+            ok = ok && row->first_ + row->size_ <= runs_.size();
+            for (UN32 k = 0; ok && k < row->size_; ++k) {
+                Run const & r = runs_[row->first_ + k];
+                ok = r.xs_ <= r.xe_
+                    && (k == 0 || runs_[row->first_ + k - 1].xe_ + 1 < r.xs_);
+            }
+        } else {
+            ok = ok && row->first_ + row->size_ <= words_.size()
+                && words_[row->first_] != 0
+                && words_[row->first_ + row->size_ - 1] != 0;
+        }
+        if (!ok) {
+            IPLLOG_ERROR(IPL_FNC_NAME << ": invalid row " << row->y_);
+            return false;
+        }
+    }
+    return true;
+}
+
+IPL_NS_END
@@ -0,0 +1,412 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Implementation of ipl::LabelledRegion
+ *
+ ********************************************************************/
+
+#include "ipl/labelledregion.hh"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "ipl/blobs.hh"
+#include "ipl/iplerr.hh"
+
+using namespace std;
+
+IPL_NS_BEGIN
+
+IPL_ANON_NS_BEGIN
+
+//! The columns [start_, end_] of a row with a label.
+struct Span
+{
+    N32 start_;
+    N32 end_;
+    N32 label_;
+};
+
+//! The Rbo's of a LabelledRegion by rows.
+class Rows
+{
+public:
+    //! ctr, the rows of @a reg.
+    explicit Rows(LabelledRegion const & reg)
+        : base_(reg.begin()), y0_(0) {
+        if (reg.empty())
+            return;
+        y0_ = reg.begin()->start().y_;
+        first_.assign((reg.end() - 1)->start().y_ - y0_ + 2, reg.nrRbos());
+        for (LabelledRegion::RboIterator r = reg.end(); r != reg.begin(); ) {
+            --r;
+            first_[r->start().y_ - y0_] = r - base_;
+        }
+        // empty rows start where the next row starts
+        for (N32 i = first_.size() - 2; i >= 0; --i)
+            first_[i] = min(first_[i], first_[i + 1]);
+    }
+
+    //! The first Rbo of row @a y.
+    LabelledRegion::RboIterator begin(N32 y) const {
+        return base_ + first_[this->index(y)];
+    }
+
+    //! Behind the last Rbo of row @a y.
+    LabelledRegion::RboIterator end(N32 y) const {
+        return base_ + first_[this->index(y + 1)];
+    }
+
+private:
+    //! The index of row @a y in first_, clamped to the rows.
+    N32 index(N32 y) const {
+        return max<N32>(0, min<N32>(y - y0_, first_.size() - 1));
+    }
+
+    //! the first Rbo
+    LabelledRegion::RboIterator base_;
+    //! the first row
+    N32 y0_;
+    //! the index of the first Rbo of each row, and the number of Rbo's
+    vector<N32> first_;
+};
+
+//! Resolves overlapping labelled spans of a row.
+/*! The spans are swept in the order of their starts. The labels covering
+ * the current column are kept with the end of their spans, spans of a label
+ * already covering are merged into it, so each piece up to the next start
+ * or end gets its owner at once.
+ */
+class RowPainter
+{
+public:
+    //! ctr, resolving conflicts by @a conflict.
+    explicit RowPainter(LabelledRegion::Conflict conflict)
+        : conflict_(conflict)
+    {}
+
+    //! Adds a span reaching the columns [@a start, @a end].
+    void add(N32 start, N32 end, N32 label) {
+        Span const s = { start, end, label };
+        spans_.push_back(s);
+    }
+
+    //! Adds the columns [@a start, @a end], which had @a label before.
+    /*! These spans must be added in order.
+     */
+    void addOwn(N32 start, N32 end, N32 label) {
+        Span const s = { start, end, label };
+        own_.push_back(s);
+    }
+
+    //! Appends the resolved spans as row @a y to @a res and clears them.
+    void paint(N32 y, LabelledRegion & res) {
+        sort(spans_.begin(), spans_.end(),
+             [](Span const & a, Span const & b) { return a.start_ < b.start_; });
+        vector<Span>::const_iterator own = own_.begin();
+        N32 x = numeric_limits<N32>::min();
+        for (size_t i = 0; ; ++i) {
+            N32 const next = i < spans_.size() ? spans_[i].start_ : numeric_limits<N32>::max();
+            while (!active_.empty() && x < next) {
+                N32 stop = next, lowest = numeric_limits<N32>::max();
+                for (vector<Span>::const_iterator a = active_.begin(); a != active_.end(); ++a) {
+                    stop = min(stop, a->end_ + 1);
+                    lowest = min(lowest, a->label_);
+                }
+                while (own != own_.end() && own->end_ < x)
+                    ++own;
+                N32 ownLabel = -1;
+                if (own != own_.end() && own->start_ <= x) {
+                    ownLabel = own->label_;
+                    stop = min(stop, own->end_ + 1);
+                } else if (own != own_.end()) {
+                    stop = min(stop, own->start_);
+                }
+                N32 const label = this->owner(ownLabel, lowest);
+                if (label >= 0)
+                    res.add(Rbo(PointN16(x, y), stop - x), label);
+                x = stop;
+                active_.erase(remove_if(active_.begin(), active_.end(),
+                                        [x](Span const & a) { return a.end_ < x; }),
+                              active_.end());
+            }
+            if (i == spans_.size())
+                break;
+            Span const & s = spans_[i];
+            x = max(x, s.start_);
+            vector<Span>::iterator a = active_.begin();
+            while (a != active_.end() && a->label_ != s.label_)
+                ++a;
+            if (a == active_.end())
+                active_.push_back(s);
+            else
+                a->end_ = max(a->end_, s.end_);
+        }
+        spans_.clear();
+        own_.clear();
+    }
+
+private:
+    //! The owner of a piece, -1 if none.
+    /*! @a ownLabel is the label the piece had before, @a lowest the lowest
+     * label covering it.
+     */
+    N32 owner(N32 ownLabel, N32 lowest) const {
+        if (ownLabel >= 0)
+            for (vector<Span>::const_iterator a = active_.begin(); a != active_.end(); ++a)
+                if (a->label_ == ownLabel)
+                    return ownLabel;
+        if (active_.size() == 1 || conflict_ == LabelledRegion::ConflictLowestLabel)
+            return lowest;
+        return -1;
+    }
+
+    //! the resolution of conflicts
+    LabelledRegion::Conflict conflict_;
+    //! the spans of the row
+    vector<Span> spans_;
+    //! the spans of the row before
+    vector<Span> own_;
+    //! the labels covering the current column, with the end of their spans
+    vector<Span> active_;
+};
+
+//! Paints the Regions [@a first, @a last) labelled by their index into @a res.
+void
+paintRegions(vector<Region>::const_iterator first, vector<Region>::const_iterator last,
+             LabelledRegion & res)
+{
+    vector<pair<Rbo, N32> > runs;
+    for (vector<Region>::const_iterator reg = first; reg != last; ++reg)
+        for (Region::RboIterator r = reg->begin(); r != reg->end(); ++r)
+            runs.push_back(make_pair(*r, N32(reg - first)));
+    sort(runs.begin(), runs.end(),
+         [](pair<Rbo, N32> const & a, pair<Rbo, N32> const & b) {
+             return a.first.start().y_ < b.first.start().y_
+                 || (a.first.start().y_ == b.first.start().y_
+                     && a.first.start().x_ < b.first.start().x_);
+         });
+    RowPainter painter(LabelledRegion::ConflictLowestLabel);
+    for (size_t i = 0; i < runs.size(); ) {
+        N32 const y = runs[i].first.start().y_;
+        for ( ; i < runs.size() && runs[i].first.start().y_ == y; ++i) {
+            Rbo const & r = runs[i].first;
+            painter.add(r.start().x_, r.start().x_ + r.len() - 1, runs[i].second);
+        }
+        painter.paint(y, res);
+    }
+}
+
+//! The columns of row @a y where the run (@a bx, @a len) fits into an object.
+void
+fittingSpans(LabelledRegion const & reg, Rows const & rows, N32 y, N32 bx, N32 len,
+             vector<Span> & spans)
+{
+    spans.clear();
+    for (LabelledRegion::RboIterator r = rows.begin(y); r != rows.end(y); ++r)
+        if (r->len() >= len) {
+            Span const s = { r->start().x_ - bx, r->start().x_ + r->len() - len - bx,
+                             reg.label(r) };
+            spans.push_back(s);
+        }
+}
+
+//! Keeps the parts of @a spans covered by spans of the same label in @a other.
+void
+intersectSpans(vector<Span> & spans, vector<Span> const & other, vector<Span> & tmp)
+{
+    tmp.clear();
+    vector<Span>::const_iterator a = spans.begin(), b = other.begin();
+    while (a != spans.end() && b != other.end()) {
+        Span const s = { max(a->start_, b->start_), min(a->end_, b->end_), a->label_ };
+        if (s.start_ <= s.end_ && a->label_ == b->label_)
+            tmp.push_back(s);
+        if (a->end_ < b->end_)
+            ++a;
+        else
+            ++b;
+    }
+    spans.swap(tmp);
+}
+
+IPL_ANON_NS_END
+
+LabelledRegion::LabelledRegion()
+    : nrLabels_(0)
+{}
+
+LabelledRegion::LabelledRegion(Blobs const & blobs)
+    : nrLabels_(0)
+{
+    paintRegions(blobs.begin(), blobs.end(), *this);
+    nrLabels_ = blobs.size();
+    IPL_ASSERT_VALID(*this);
+}
+
+LabelledRegion::LabelledRegion(std::vector<Region> const & regions)
+    : nrLabels_(0)
+{
+    paintRegions(regions.begin(), regions.end(), *this);
+    nrLabels_ = N32(regions.size());
+    IPL_ASSERT_VALID(*this);
+}
+
+LabelledRegion &
+LabelledRegion::add(Rbo const & rbo, N32 label)
+{
+    IPL_ASSERT(rbo.len() > 0 && label >= 0);
+    if (!rbos_.empty() && labels_.back() == label) {
+        Rbo & last = rbos_.back();
+        if (last.start().y_ == rbo.start().y_
+            && last.start().x_ + last.len() == rbo.start().x_) {
+            last = Rbo(last.start(), last.len() + rbo.len());
+            return *this;
+        }
+    }
+    rbos_.push_back(rbo);
+    labels_.push_back(label);
+    nrLabels_ = max(nrLabels_, label + 1);
+    return *this;
+}
+
+Region const
+LabelledRegion::region() const
+{
+    Region res;
+    for (RboIterator r = this->begin(); r != this->end(); ) {
+        Rbo run = *r;
+        for (++r; r != this->end() && r->start().y_ == run.start().y_
+                 && r->start().x_ == run.start().x_ + run.len(); ++r)
+            run = Rbo(run.start(), run.len() + r->len());
+        res.add(run);
+    }
+    return res;
+}
+
+Region const
+LabelledRegion::region(N32 label) const
+{
+    Region res;
+    for (size_t i = 0; i < rbos_.size(); ++i)
+        if (labels_[i] == label)
+            res.add(rbos_[i]);
+    return res;
+}
+
+std::vector<Region> const
+LabelledRegion::split() const
+{
+    vector<Region> res(nrLabels_);
+    for (size_t i = 0; i < rbos_.size(); ++i)
+        res[labels_[i]].add(rbos_[i]);
+    return res;
+}
+
+/*! @internal Row @em y of the dilation gets the rows <em>y - by</em> of the
+ * objects shifted by each run (@em bx, @em by) of @a B and widened by its
+ * length. The pixels of row @em y of the objects themselves are passed as
+ * their own, so they stay with their object.
+ */
+LabelledRegion const
+LabelledRegion::dilate(Region const & B, Conflict conflict) const
+{
+    IPLLOG_INFO(IPL_FNC_NAME << " of " << *this << " by " << B);
+    if (this->empty() || B.empty())
+        return *this;
+
+    Rows const rows(*this);
+    N32 const y0 = this->begin()->start().y_ + B.begin()->start().y_,
+        y1 = (this->end() - 1)->start().y_ + (B.end() - 1)->start().y_;
+    LabelledRegion res;
+    res.nrLabels_ = nrLabels_;
+    RowPainter painter(conflict);
+    for (N32 y = y0; y <= y1; ++y) {
+        for (RboIterator b = B.begin(); b != B.end(); ++b) {
+            N32 const yx = y - b->start().y_;
+            for (RboIterator r = rows.begin(yx); r != rows.end(yx); ++r)
+                painter.add(r->start().x_ + b->start().x_,
+                            r->start().x_ + r->len() + b->start().x_ + b->len() - 2,
+                            this->label(r));
+        }
+        for (RboIterator r = rows.begin(y); r != rows.end(y); ++r)
+            painter.addOwn(r->start().x_, r->start().x_ + r->len() - 1, this->label(r));
+        painter.paint(y, res);
+    }
+    IPL_ASSERT_VALID(res);
+    return res;
+}
+
+/*! @internal A run (@em bx, @em by) of @a B fits at the columns of row
+ * @em y, where it lies within one Rbo of row <em>y + by</em>. Each Rbo is
+ * a whole object in its row, so the erosion of row @em y is the
+ * intersection of these spans of the same label over all runs of @a B.
+ */
+LabelledRegion const
+LabelledRegion::erode(Region const & B) const
+{
+    IPLLOG_INFO(IPL_FNC_NAME << " of " << *this << " by " << B);
+    if (this->empty() || B.empty())
+        return *this;
+
+    Rows const rows(*this);
+    N32 const y0 = this->begin()->start().y_ - B.begin()->start().y_,
+        y1 = (this->end() - 1)->start().y_ - (B.end() - 1)->start().y_;
+    LabelledRegion res;
+    res.nrLabels_ = nrLabels_;
+    vector<Span> spans, other, tmp;
+    for (N32 y = y0; y <= y1; ++y) {
+        RboIterator b = B.begin();
+        fittingSpans(*this, rows, y + b->start().y_, b->start().x_, b->len(), spans);
+        for (++b; b != B.end() && !spans.empty(); ++b) {
+            fittingSpans(*this, rows, y + b->start().y_, b->start().x_, b->len(), other);
+            intersectSpans(spans, other, tmp);
+        }
+        for (vector<Span>::const_iterator s = spans.begin(); s != spans.end(); ++s)
+            res.add(Rbo(PointN16(s->start_, y), s->end_ - s->start_ + 1), s->label_);
+    }
+    IPL_ASSERT_VALID(res);
+    return res;
+}
+
+std::ostream &
+LabelledRegion::print(std::ostream & os) const
+{
+    return os << this->nrRbos() << " rbos of " << nrLabels_ << " labels";
+}
+
+/*! @internal The Rbo's must be sorted and must not overlap, adjacent Rbo's
+ * must have different labels.
+ */
+bool
+LabelledRegion::validate() const
+{
+    if (labels_.size() != rbos_.size()) {
+        IPLLOG_ERROR(IPL_FNC_NAME << ": " << labels_.size() << " labels of "
+                     << rbos_.size() << " rbos");
+        return false;
+    }
+    for (size_t i = 0; i < rbos_.size(); ++i) {
+        if (rbos_[i].len() <= 0 || labels_[i] < 0 || labels_[i] >= nrLabels_) {
+            IPLLOG_ERROR(IPL_FNC_NAME << ": invalid rbo " << i);
+            return false;
+        }
+        if (i == 0 || rbos_[i - 1].start().y_ < rbos_[i].start().y_)
+            continue;
+        N32 const end = rbos_[i - 1].start().x_ + rbos_[i - 1].len();
+        if (rbos_[i - 1].start().y_ > rbos_[i].start().y_
+            || end > rbos_[i].start().x_
+            || (end == rbos_[i].start().x_ && labels_[i - 1] == labels_[i])) {
+            IPLLOG_ERROR(IPL_FNC_NAME << ": rbo " << i << " out of order");
+            return false;
+        }
+    }
+    return true;
+}
+
+IPL_NS_END
@@ -0,0 +1,458 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Implementation of ipl::MappedRegion
+ *
+ ********************************************************************/
+
+#include "ipl/mappedregion.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <vector>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "ipl/iplerr.hh"
+
+using namespace std;
+namespace bip = boost::interprocess;
+
+IPL_NS_BEGIN
+
+IPL_ANON_NS_BEGIN
+
+//! Magic number of a Region file.
+char const fileMagic[8] = { 'I', 'P', 'L', 'R', 'E', 'G', 'N', '\n' };
+
+//! Version of the Region file format.
+UN32 const fileVersion = 1;
+
+//! Size of the header, the row index starts here.
+UN64 const headerSize = 56;
+
+//! Size of a Rbo in a Region file.
+UN32 const rboSize = 8;
+
+// The Rbo's of a little endian file are used in place, so a Rbo must be the
+// start point (x and y as N16) at offset 0 followed by the length (N32) at
+// offset 4. The members are private, so offsetof is not available, but the
+// first member of a standard layout class is at offset 0 and the sizes leave
+// no room for padding in between.
+IPL_STATIC_ASSERT(std::is_standard_layout<PointN16>::value && sizeof(PointN16) == 4,
+                  "PointN16 must be two packed N16");
+IPL_STATIC_ASSERT(std::is_standard_layout<Rbo>::value,
+                  "Rbo must be standard layout to be mapped");
+IPL_STATIC_ASSERT(sizeof(N32) == 4 && sizeof(Rbo) == rboSize,
+                  "Rbo must be the start point followed by the length");
+
+//! Offset of the Rbo's for a row index with @a nrRows rows.
+inline UN64
+rboOffset(UN32 nrRows)
+{
+    return (headerSize + 4 * (UN64(nrRows) + 1) + 7) & ~UN64(7);
+}
+
+//! @name Little endian Numbers
+//@{
+inline UN32
+get32(UN8 const * p)
+{
+    return UN32(p[0]) | UN32(p[1]) << 8 | UN32(p[2]) << 16 | UN32(p[3]) << 24;
+}
+
+inline N16
+get16(UN8 const * p)
+{
+    return static_cast<N16>(p[0] | p[1] << 8);
+}
+
+inline UN64
+get64(UN8 const * p)
+{
+    return UN64(get32(p)) | UN64(get32(p + 4)) << 32;
+}
+
+inline void
+put16(UN8 * p, N16 v)
+{
+    p[0] = UN16(v) & 0xff;
+    p[1] = UN16(v) >> 8;
+}
+
+inline void
+put32(UN8 * p, UN32 v)
+{
+    for (N32 k = 0; k < 4; ++k)
+        p[k] = (v >> 8 * k) & 0xff;
+}
+
+inline void
+put64(UN8 * p, UN64 v)
+{
+    put32(p, UN32(v));
+    put32(p + 4, UN32(v >> 32));
+}
+//@}
+
+//! Write @a n bytes at @a p to @a os.
+inline void
+write(ofstream & os, void const * p, UN64 n)
+{
+    os.write(static_cast<char const *>(p), n);
+}
+
+IPL_ANON_NS_END
+
+/*****************************************************************************/
+// Impl
+
+//! The mapping of a Region file.
+/*! On big endian machines the Rbo's and the row index are converted to a
+ * copy.
+ */
+class MappedRegion::Impl
+{
+public:
+    //! ctr, maps @a fn and checks the header and the row index.
+    explicit Impl(string const & fn);
+
+    //! the file
+    bip::file_mapping file_;
+    //! the mapping of the whole file
+    bip::mapped_region map_;
+    //! the Rbo's
+    RboIterator begin_;
+    //! behind the last Rbo
+    RboIterator end_;
+    //! the first Rbo of the rows firstRow_, ..., firstRow_ + nrRows_
+    UN32 const * index_;
+    //! the first row of the row index
+    N32 firstRow_;
+    //! the number of rows of the row index
+    N32 nrRows_;
+    //! the bounding box, if not empty
+    WinP bbox_;
+#if !defined(IPL_LITTLE_ENDIAN)
+    //! the converted Rbo's
+    vector<Rbo> rbos_;
+    //! the converted row index
+    vector<UN32> rows_;
+#endif
+};
+
+MappedRegion::Impl::Impl(string const & fn)
+{
+    try {
+        bip::file_mapping(fn.c_str(), bip::read_only).swap(file_);
+        bip::mapped_region(file_, bip::read_only).swap(map_);
+    } catch (bip::interprocess_exception const & e) {
+        throw IoError(fn + ": " + e.what());
+    }
+    UN8 const * p = static_cast<UN8 const *>(map_.get_address());
+    UN64 const size = map_.get_size();
+    if (size < headerSize || memcmp(p, fileMagic, sizeof(fileMagic)) != 0)
+        throw IoError(fn + ": not a region file");
+    if (get32(p + 8) != fileVersion || get32(p + 12) != rboSize)
+        throw IoError(fn + ": unsupported region file version");
+
+    UN32 const nrRbos = get32(p + 16);
+    firstRow_ = get32(p + 20);
+    nrRows_ = get32(p + 24);
+    UN64 const indexOffset = get64(p + 40),
+        rbosOffset = get64(p + 48);
+    N32 const x0 = get16(p + 28), y0 = get16(p + 30),
+        x1 = get16(p + 32), y1 = get16(p + 34);
+    if (indexOffset != headerSize
+        || x0 > x1 || y0 > y1
+        || nrRows_ != (nrRbos > 0 ? y1 - y0 + 1 : 0)
+        || (nrRbos > 0 && firstRow_ != y0)
+        || rbosOffset != rboOffset(nrRows_)
+        || size < rbosOffset + UN64(nrRbos) * rboSize)
+        throw IoError(fn + ": corrupt region file header");
+    if (nrRbos > 0)
+        bbox_ = WinP(x0, y0, x1, y1);
+
+#if defined(IPL_LITTLE_ENDIAN)
+    index_ = reinterpret_cast<UN32 const *>(p + indexOffset);
+    begin_ = reinterpret_cast<Rbo const *>(p + rbosOffset);
+#else
+    rows_.resize(nrRows_ + 1);
+    for (N32 k = 0; k <= nrRows_; ++k)
+        rows_[k] = get32(p + indexOffset + 4 * k);
+    rbos_.reserve(nrRbos);
+    for (UN32 k = 0; k < nrRbos; ++k) {
+        UN8 const * r = p + rbosOffset + UN64(k) * rboSize;
+        rbos_.push_back(Rbo(PointN16(get16(r), get16(r + 2)), get32(r + 4)));
+    }
+    index_ = rows_.data();
+    begin_ = rbos_.data();
+#endif
+    end_ = begin_ + nrRbos;
+
+    bool ok = index_[0] == 0 && index_[nrRows_] == nrRbos;
+    for (N32 k = 0; ok && k < nrRows_; ++k)
+        ok = index_[k] <= index_[k+1];
+    if (!ok)
+        throw IoError(fn + ": corrupt row index");
+}
+
+/*****************************************************************************/
+// MappedRegion
+
+MappedRegion::MappedRegion(string const & fn)
+    : impl_(new Impl(fn))
+{
+    IPLLOG_INFO(IPL_FNC_NAME << ": " << fn << " -> " << *this);
+}
+
+/*! @internal The Rbo's are written in the layout of Rbo on little endian
+ * machines, so they are used in place by the mapping.
+ */
+void
+MappedRegion::save(Region const & reg, string const & fn)
+{
+    IPL_ASSERT_VALID(reg);
+    N32 firstRow = 0, nrRows = 0;
+    UN8 header[headerSize] = { 0 };
+    memcpy(header, fileMagic, sizeof(fileMagic));
+    if (!reg.empty()) {
+        WinP const & bb = reg.boundingBox();
+        firstRow = bb.upperLeft().y_;
+        nrRows = bb.lowerRight().y_ - firstRow + 1;
+        put16(header + 28, bb.upperLeft().x_);
+        put16(header + 30, bb.upperLeft().y_);
+        put16(header + 32, bb.lowerRight().x_);
+        put16(header + 34, bb.lowerRight().y_);
+    }
+    put32(header + 8, fileVersion);
+    put32(header + 12, rboSize);
+    put32(header + 16, reg.nrRbos());
+    put32(header + 20, firstRow);
+    put32(header + 24, nrRows);
+    put64(header + 40, headerSize);
+    put64(header + 48, rboOffset(nrRows));
+
+    vector<UN8> index(rboOffset(nrRows) - headerSize, 0);
+    auto r = reg.begin();
+    for (N32 k = 0; k <= nrRows; ++k) {
+        while (r != reg.end() && r->start().y_ < firstRow + k)
+            ++r;
+        put32(&index[4 * k], r - reg.begin());
+    }
+
+    ofstream os(fn.c_str(), ios::binary | ios::trunc);
+    write(os, header, headerSize);
+    write(os, index.data(), index.size());
+#if defined(IPL_LITTLE_ENDIAN)
+    write(os, reg.begin(), UN64(reg.nrRbos()) * rboSize);
+#else
+    vector<UN8> buf;
+    for (r = reg.begin(); r != reg.end(); ++r) {
+        UN8 rec[rboSize];
+        put16(rec, r->start().x_);
+        put16(rec + 2, r->start().y_);
+        put32(rec + 4, r->len());
+        buf.insert(buf.end(), rec, rec + rboSize);
+        if (buf.size() >= 1 << 16 || r + 1 == reg.end()) {
+            write(os, buf.data(), buf.size());
+            buf.clear();
+        }
+    }
+#endif
+    os.close();
+    if (!os)
+        throw IoError("can't write " + fn);
+}
+
+MappedRegion::RboIterator
+MappedRegion::begin() const
+{
+    return impl_->begin_;
+}
+
+MappedRegion::RboIterator
+MappedRegion::end() const
+{
+    return impl_->end_;
+}
+
+N32
+MappedRegion::nrRbos() const
+{
+    return impl_->end_ - impl_->begin_;
+}
+
+bool
+MappedRegion::empty() const
+{
+    return impl_->begin_ == impl_->end_;
+}
+
+WinP const &
+MappedRegion::boundingBox() const
+{
+    if (this->empty())
+        throw EmptyRegionError(string(IPL_FNC_NAME) + ": empty region");
+    return impl_->bbox_;
+}
+
+MappedRegion::RboIterator
+MappedRegion::rowBegin(N32 y) const
+{
+    N32 const k = min(max(y - impl_->firstRow_, 0), impl_->nrRows_);
+    return impl_->begin_ + impl_->index_[k];
+}
+
+MappedRegion::RboIterator
+MappedRegion::rowEnd(N32 y) const
+{
+    return this->rowBegin(y + 1);
+}
+
+bool
+MappedRegion::includes(PointN16 const & pt) const
+{
+    RboIterator const last = this->rowEnd(pt.y_);
+    RboIterator const r = upper_bound(this->rowBegin(pt.y_), last, pt,
+                                      [](PointN16 const & p, Rbo const & s) {
+                                          return p.x_ < s.start().x_;
+                                      });
+    return r != this->rowBegin(pt.y_)
+        && pt.x_ < (r - 1)->start().x_ + (r - 1)->len();
+}
+
+Region const
+MappedRegion::region() const
+{
+    Region reg;
+    reg.rbos_.assign(this->begin(), this->end());
+    IPL_ASSERT_VALID(reg);
+    return reg;
+}
+
+Region const
+MappedRegion::rows(N32 y0, N32 y1) const
+{
+    Region reg;
+    if (y0 <= y1)
+        reg.rbos_.assign(this->rowBegin(y0), this->rowEnd(y1));
+    IPL_ASSERT_VALID(reg);
+    return reg;
+}
+
+Region const
+MappedRegion::clip(WinP const & win) const
+{
+    IPL_ASSERT_VALID(win);
+    Region reg;
+    Region::clipRange(this->rowBegin(win.upperLeft().y_),
+                      this->rowEnd(win.lowerRight().y_),
+                      win, reg);
+    IPL_ASSERT_VALID(reg);
+    return reg;
+}
+
+Region const
+MappedRegion::unions(Region const & other) const
+{
+    return unions(this->begin(), this->end(), other.begin(), other.end());
+}
+
+Region const
+MappedRegion::unions(MappedRegion const & other) const
+{
+    return unions(this->begin(), this->end(), other.begin(), other.end());
+}
+
+Region const
+MappedRegion::intersect(Region const & other) const
+{
+    if (other.empty())
+        return Region();
+    WinP const & bb = other.boundingBox();
+    return intersect(this->rowBegin(bb.upperLeft().y_),
+                     this->rowEnd(bb.lowerRight().y_),
+                     other.begin(), other.end());
+}
+
+Region const
+MappedRegion::intersect(MappedRegion const & other) const
+{
+    if (this->empty() || other.empty())
+        return Region();
+    N32 const y0 = max(this->impl_->firstRow_, other.impl_->firstRow_),
+        y1 = min(this->impl_->firstRow_ + this->impl_->nrRows_,
+                 other.impl_->firstRow_ + other.impl_->nrRows_);
+    return intersect(this->rowBegin(y0), this->rowBegin(y1),
+                     other.rowBegin(y0), other.rowBegin(y1));
+}
+
+Region const
+MappedRegion::unions(RboIterator r, RboIterator rend,
+                     RboIterator s, RboIterator send)
+{
+    Region reg;
+    reg.rbos_.reserve((rend - r) + (send - s));
+    Region::unionRange(r, rend, s, send, reg);
+    IPL_ASSERT_VALID(reg);
+    return reg;
+}
+
+Region const
+MappedRegion::intersect(RboIterator r, RboIterator rend,
+                        RboIterator s, RboIterator send)
+{
+    Region reg;
+    Region::intersectRange(r, rend, s, send, reg);
+    IPL_ASSERT_VALID(reg);
+    return reg;
+}
+
+std::ostream &
+MappedRegion::print(std::ostream & os) const
+{
+    os << "mapped region with " << this->nrRbos() << " rbos";
+    if (!this->empty())
+        os << " and bbox " << impl_->bbox_;
+    return os;
+}
+
+/*! @internal The Rbo's must be ordered and inside of the bounding box, and
+ * the row index must point to the first Rbo of every row.
+ */
+bool
+MappedRegion::validate() const
+{
+    RboIterator const first = this->begin(), last = this->end();
+    for (RboIterator r = first; r != last; ++r) {
+        bool ok = r->len() > 0
+            && impl_->bbox_.includes(r->start())
+            && impl_->bbox_.includes(PointN16(r->start().x_ + r->len() - 1,
+                                              r->start().y_));
+        if (r != first)
+            ok = ok && ((r - 1)->start().y_ < r->start().y_
+                        || (r - 1)->start().x_ + (r - 1)->len() < r->start().x_);
+        if (!ok) {
+            IPLLOG_ERROR(IPL_FNC_NAME << ": invalid rbo " << *r);
+            return false;
+        }
+    }
+    for (N32 k = 0; k < impl_->nrRows_; ++k) {
+        RboIterator const r = first + impl_->index_[k];
+        N32 const y = impl_->firstRow_ + k;
+        if ((r != last && r->start().y_ < y) || (r != first && (r - 1)->start().y_ >= y)) {
+            IPLLOG_ERROR(IPL_FNC_NAME << ": invalid row index of row " << y);
+            return false;
+        }
+    }
+    return true;
+}
+
+IPL_NS_END
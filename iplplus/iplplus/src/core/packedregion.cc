@@ -0,0 +1,444 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Implementation of ipl::PackedRegion
+ *
+ ********************************************************************/
+
+#include "ipl/packedregion.hh"
+
+#include <algorithm>
+#include <vector>
+
+#include "ipl/iplerr.hh"
+
+using namespace std;
+
+IPL_NS_BEGIN
+
+IPL_ANON_NS_BEGIN
+
+//! Number of blocks of a band of PackedRegion::erode.
+N32 const blocksPerBand = 8;
+
+//! @name Variable length Integers
+//@{
+//! Appends @a v with 7 bits per byte to @a code.
+inline void
+putVarint(vector<UN8> & code, UN32 v)
+{
+    while (v >= 0x80) {
+        code.push_back((v & 0x7f) | 0x80);
+        v >>= 7;
+    }
+    code.push_back(v);
+}
+
+//! Appends the signed @a v in zig-zag coding to @a code.
+inline void
+putSignedVarint(vector<UN8> & code, N32 v)
+{
+    putVarint(code, (UN32(v) << 1) ^ UN32(v >> 31));
+}
+
+//! Reads an unsigned integer at @a p.
+inline UN32
+getVarint(UN8 const * & p)
+{
+    UN32 v = 0;
+    for (N32 shift = 0; ; shift += 7) {
+        UN8 const b = *p++;
+        v |= UN32(b & 0x7f) << shift;
+        if (b < 0x80)
+            return v;
+    }
+}
+
+//! Reads a signed integer at @a p.
+inline N32
+getSignedVarint(UN8 const * & p)
+{
+    UN32 const v = getVarint(p);
+    return N32(v >> 1) ^ -N32(v & 1);
+}
+//@}
+
+//! Number of small differences of a predicted Rbo.
+/*! A Rbo with differences of its start and end point to the Rbo above both in
+ * [-5, 5] is stored in a single byte below smallDiffs * smallDiffs.
+ */
+UN32 const smallDiffs = 11;
+
+//! The codes of a row.
+/*! The code of a row is a sequence of these codes, each Rbo of the row is
+ * either predicted from a Rbo of the row above or stored literally.
+ */
+enum RowCode {
+    BigDiffs = smallDiffs * smallDiffs,  //!< predicted, the differences follow
+    Skip,                                //!< skip a Rbo of the row above
+    NewRbo,                              //!< gap and length of a Rbo follow
+    EndOfRow                             //!< end of the row
+};
+
+//! Appends the differences @a ds and @a de of a predicted Rbo to @a code.
+inline void
+putDiffs(vector<UN8> & code, N32 ds, N32 de)
+{
+    UN32 const zs = (UN32(ds) << 1) ^ UN32(ds >> 31),
+        ze = (UN32(de) << 1) ^ UN32(de >> 31);
+    if (zs < smallDiffs && ze < smallDiffs) {
+        code.push_back(zs * smallDiffs + ze);
+    } else {
+        code.push_back(BigDiffs);
+        putSignedVarint(code, ds);
+        putSignedVarint(code, de);
+    }
+}
+
+//! Reads the differences @a ds and @a de of a predicted Rbo with code @a c.
+inline void
+getDiffs(UN32 c, UN8 const * & p, N32 & ds, N32 & de)
+{
+    if (c < BigDiffs) {
+        UN32 const zs = c / smallDiffs, ze = c % smallDiffs;
+        ds = N32(zs >> 1) ^ -N32(zs & 1);
+        de = N32(ze >> 1) ^ -N32(ze & 1);
+    } else {
+        ds = getSignedVarint(p);
+        de = getSignedVarint(p);
+    }
+}
+
+//! End of a Rbo.
+inline N32
+rboEnd(Rbo const & r)
+{
+    return r.start().x_ + r.len();
+}
+
+//! Compares a Rbo with a row.
+struct RowLess {
+    bool operator()(Rbo const & r, N32 y) const {
+        return r.start().y_ < y;
+    }
+};
+
+IPL_ANON_NS_END
+
+N32 const PackedRegion::rowsPerBlock;
+
+/*****************************************************************************/
+// Iterator
+
+PackedRegion::Iterator::Iterator()
+    : reg_(0), pos_(0), y_(0), idx_(0), nr_(0)
+{}
+
+PackedRegion::Iterator::Iterator(PackedRegion const * reg, N32 block)
+    : reg_(reg), pos_(0), y_(0), idx_(0), nr_(reg->nrRbos_)
+{
+    if (block < N32(reg->blocks_.size())) {
+        pos_ = reg->code_.data() + reg->blocks_[block];
+        y_ = reg->bbox_.upperLeft().y_ + block * rowsPerBlock;
+        nr_ = reg->firstRbos_[block];
+        this->nextRow();
+    }
+}
+
+PackedRegion::Iterator &
+PackedRegion::Iterator::operator++()
+{
+    ++nr_;
+    if (++idx_ == row_.size())
+        this->nextRow();
+    return *this;
+}
+
+/*! @internal The Rbo's of a row are predicted from the Rbo's of the row
+ * above, see RowCode. The first row of a block has no row above.
+ */
+void
+PackedRegion::Iterator::nextRow()
+{
+    N32 const x0 = reg_->bbox_.upperLeft().x_,
+        y0 = reg_->bbox_.upperLeft().y_,
+        y1 = reg_->bbox_.lowerRight().y_;
+    idx_ = 0;
+    do {
+        if (y_ > y1) {
+            row_.clear();
+            return;
+        }
+        prev_.swap(row_);
+        row_.clear();
+        if ((y_ - y0) % rowsPerBlock == 0)
+            prev_.clear();
+        auto p = prev_.begin();
+        N32 xe = x0 - 1;
+        for (UN32 c = *pos_++; c != EndOfRow; c = *pos_++) {
+            if (c == Skip) {
+                ++p;
+                continue;
+            }
+            N32 xs, len;
+            if (c == NewRbo) {
+                xs = xe + 1 + getVarint(pos_);
+                len = getVarint(pos_) + 1;
+            } else {
+                N32 ds, de;
+                getDiffs(c, pos_, ds, de);
+                xs = p->start().x_ + ds;
+                len = rboEnd(*p) + de - xs;
+                ++p;
+            }
+            row_.push_back(Rbo(PointN16(xs, y_), len));
+            xe = xs + len;
+        }
+        ++y_;
+    } while (row_.empty());
+}
+
+/*****************************************************************************/
+// PackedRegion
+
+PackedRegion::PackedRegion()
+    : nrRbos_(0)
+{}
+
+PackedRegion::PackedRegion(Region const & reg)
+    : nrRbos_(reg.nrRbos())
+{
+    IPL_ASSERT_VALID(reg);
+    if (reg.empty())
+        return;
+    bbox_ = reg.boundingBox();
+    N32 const x0 = bbox_.upperLeft().x_,
+        y0 = bbox_.upperLeft().y_,
+        y1 = bbox_.lowerRight().y_;
+    code_.reserve(2 * reg.nrRbos() + (y1 - y0 + 1));
+    Region::RboIterator r = reg.begin(), prev = r, prevEnd = r;
+    for (N32 y = y0; y <= y1; ++y) {
+        if ((y - y0) % rowsPerBlock == 0) {
+            blocks_.push_back(code_.size());
+            firstRbos_.push_back(r - reg.begin());
+            prev = prevEnd = r;
+        }
+        Region::RboIterator const first = r;
+        while (r != reg.end() && r->start().y_ == y)
+            ++r;
+        // a Rbo overlapping a Rbo above is predicted from it
+        Region::RboIterator p = prev;
+        N32 xe = x0 - 1;
+        for (Region::RboIterator s = first; s != r; ) {
+            if (p != prevEnd && rboEnd(*p) <= s->start().x_) {
+                code_.push_back(Skip);
+                ++p;
+                continue;
+            }
+            if (p == prevEnd || rboEnd(*s) <= p->start().x_) {
+                code_.push_back(NewRbo);
+                putVarint(code_, s->start().x_ - xe - 1);
+                putVarint(code_, s->len() - 1);
+            } else {
+                putDiffs(code_, s->start().x_ - p->start().x_, rboEnd(*s) - rboEnd(*p));
+                ++p;
+            }
+            xe = rboEnd(*s);
+            ++s;
+        }
+        code_.push_back(EndOfRow);
+        prev = first;
+        prevEnd = r;
+    }
+    code_.shrink_to_fit();
+    IPL_ASSERT_VALID(*this);
+}
+
+PackedRegion::Iterator
+PackedRegion::begin() const
+{
+    return Iterator(this, 0);
+}
+
+PackedRegion::Iterator
+PackedRegion::end() const
+{
+    return Iterator(this, blocks_.size());
+}
+
+WinP const &
+PackedRegion::boundingBox() const
+{
+    if (this->empty())
+        throw EmptyRegionError(string(IPL_FNC_NAME) + ": empty region");
+    return bbox_;
+}
+
+std::size_t
+PackedRegion::size() const
+{
+    return code_.size() + blocks_.size() * sizeof(UN32)
+        + firstRbos_.size() * sizeof(N32);
+}
+
+/*! @internal The iterator starts at the block of @a y and skips the rows
+ * above @a y.
+ */
+PackedRegion::Iterator
+PackedRegion::row(N32 y) const
+{
+    if (this->empty() || y > bbox_.lowerRight().y_)
+        return this->end();
+    N32 const block = max(0, y - bbox_.upperLeft().y_) / rowsPerBlock;
+    Iterator it(this, block), last = this->end();
+    while (it != last && it->start().y_ < y) {
+        it.nr_ += it.row_.size() - it.idx_;
+        it.nextRow();
+    }
+    return it;
+}
+
+bool
+PackedRegion::includes(PointN16 const & pt) const
+{
+    for (Iterator it = this->row(pt.y_), last = this->end();
+         it != last && it->start().y_ == pt.y_ && it->start().x_ <= pt.x_;
+         ++it) {
+        if (pt.x_ < rboEnd(*it))
+            return true;
+    }
+    return false;
+}
+
+void
+PackedRegion::decode(N32 y0, N32 y1, vector<Rbo> & rbos) const
+{
+    for (Iterator it = this->row(y0), last = this->end();
+         it != last && it->start().y_ <= y1;
+         ++it)
+        rbos.push_back(*it);
+}
+
+Region const
+PackedRegion::region() const
+{
+    Region reg;
+    reg.rbos_.reserve(nrRbos_);
+    reg.rbos_.assign(this->begin(), this->end());
+    IPL_ASSERT_VALID(reg);
+    return reg;
+}
+
+Region const
+PackedRegion::rows(N32 y0, N32 y1) const
+{
+    Region reg;
+    this->decode(y0, y1, reg.rbos_);
+    IPL_ASSERT_VALID(reg);
+    return reg;
+}
+
+/*! @internal The blocks are decoded one after the other, and each block is
+ * merged with the Rbo's of @a other in its rows.
+ */
+Region const
+PackedRegion::unions(Region const & other) const
+{
+    IPL_ASSERT_VALID(other);
+    if (this->empty())
+        return other;
+    Region reg;
+    reg.rbos_.reserve(nrRbos_ + other.nrRbos());
+    vector<Rbo> buf;
+    Region::RboIterator s = other.begin();
+    for (N32 y = bbox_.upperLeft().y_; y <= bbox_.lowerRight().y_; y += rowsPerBlock) {
+        buf.clear();
+        this->decode(y, y + rowsPerBlock - 1, buf);
+        Region::RboIterator const send = lower_bound(s, other.end(),
+                                                     y + rowsPerBlock, RowLess());
+        Region::unionRange(buf.data(), buf.data() + buf.size(), s, send, reg);
+        s = send;
+    }
+    reg.rbos_.insert(reg.rbos_.end(), s, other.end());
+    IPL_ASSERT_VALID(reg);
+    return reg;
+}
+
+Region const
+PackedRegion::intersect(Region const & other) const
+{
+    IPL_ASSERT_VALID(other);
+    Region reg;
+    if (this->empty() || other.empty())
+        return reg;
+    N32 const y0 = max<N32>(bbox_.upperLeft().y_, other.boundingBox().upperLeft().y_),
+        y1 = min<N32>(bbox_.lowerRight().y_, other.boundingBox().lowerRight().y_);
+    vector<Rbo> buf;
+    Region::RboIterator s = lower_bound(other.begin(), other.end(), y0, RowLess());
+    for (N32 y = y0; y <= y1; y += rowsPerBlock) {
+        N32 const ye = min(y + rowsPerBlock - 1, y1);
+        buf.clear();
+        this->decode(y, ye, buf);
+        Region::RboIterator const send = lower_bound(s, other.end(), ye + 1, RowLess());
+        Region::intersectRange(buf.data(), buf.data() + buf.size(), s, send, reg);
+        s = send;
+    }
+    IPL_ASSERT_VALID(reg);
+    return reg;
+}
+
+/*! @internal The row @a y of the erosion depends on the rows @a y + @a b.y_
+ * for @a b in @a B, so each band of the erosion is computed from the band
+ * enlarged by the extent of @a B only.
+ */
+Region const
+PackedRegion::erode(Region const & B) const
+{
+    IPL_ASSERT_VALID(B);
+    if (this->empty() || B.empty())
+        return this->region();
+    N32 const by0 = B.boundingBox().upperLeft().y_,
+        by1 = B.boundingBox().lowerRight().y_,
+        y0 = bbox_.upperLeft().y_ - by0,
+        y1 = bbox_.lowerRight().y_ - by1,
+        bandRows = blocksPerBand * rowsPerBlock;
+    Region reg;
+    for (N32 y = y0; y <= y1; y += bandRows) {
+        Region band;
+        this->decode(y + by0, min(y + bandRows - 1, y1) + by1, band.rbos_);
+        Region const eroded = band.erode2cut(B);
+        reg.rbos_.insert(reg.rbos_.end(), eroded.begin(), eroded.end());
+    }
+    reg.invalidateCaches();
+    IPL_ASSERT_VALID(reg);
+    return reg;
+}
+
+std::ostream &
+PackedRegion::print(std::ostream & os) const
+{
+    os << "packed region with " << nrRbos_ << " rbos in " << this->size() << " bytes";
+    if (!this->empty())
+        os << " and bbox " << bbox_;
+    return os;
+}
+
+bool
+PackedRegion::validate() const
+{
+    if (this->empty())
+        return code_.empty() && blocks_.empty();
+    Region const reg = this->region();
+    bool const ok = reg.nrRbos() == nrRbos_
+        && reg.validate()
+        && reg.boundingBox() == bbox_;
+    if (!ok)
+        IPLLOG_ERROR(IPL_FNC_NAME << ": invalid code");
+    return ok;
+}
+
+IPL_NS_END
@@ -31,6 +31,11 @@
 #include "ipl/iplerr.hh"
 #include "ipl/ellipse.hh"
 #include "ipl/range.hh"
+#include "ipl/mathli.hh"
+
+#if defined(__SSE2__)
+#    include <immintrin.h>
+#endif
 
 using namespace std;
 
@@ -181,42 +186,50 @@ Region::clip(WinP const & win)
         return *this;
     }
 
-    vector<Rbo> const tmp(rbos_);
-    rbos_.clear();
-
-    auto r = tmp.begin();
-    auto const e = tmp.end();
-
+    vector<Rbo> tmp;
+    tmp.swap(rbos_);
     try {
-        // upper row
-        while (r != e && r->start().y_ < y0)
-            ++r;
-        IPL_ASSERT(r == e || r->start().y_ >= y0);
-        while(r != e && r->start().y_ <= y1) {
-            IPLLOG_DEBUG("process rbo: " << *r);
-            N32 y = r->start().y_;
-            N32 xs = r->start().x_;
-            N32 xe = xs + r->len() - 1;
-            if (xe < x0 || xs > x1)
-                ; //nothing to do
-            else {
-                xs = max(xs, x0);
-                xe = min(xe, x1);
-                Rbo n(PointN16(xs,y), xe-xs+1);
-                this->add(n);
-                IPLLOG_DEBUG("new rbo: " << n);
-            }
-            ++r;
-        }
-        IPL_ASSERT(r == e || r->start().y_ > y1);
+        clipRange(tmp.data(), tmp.data() + tmp.size(), win, *this);
         this->invalidateCaches();
     } catch(...) {
-        rbos_ = tmp;
+        rbos_.swap(tmp);
         throw;
     }
     return *this;
 }
 
+void
+Region::clipRange(RboIterator r, RboIterator e,
+                  WinP const & win,
+                  Region & res)
+{
+    N32 const x0 = win.upperLeft().x_,
+        y0 = win.upperLeft().y_,
+        x1 = win.lowerRight().x_,
+        y1 = win.lowerRight().y_;
+
+    // upper row
+    while (r != e && r->start().y_ < y0)
+        ++r;
+    IPL_ASSERT(r == e || r->start().y_ >= y0);
+    while(r != e && r->start().y_ <= y1) {
+        IPLLOG_DEBUG("process rbo: " << *r);
+        N32 y = r->start().y_;
+        N32 xs = r->start().x_;
+        N32 xe = xs + r->len() - 1;
+        if (xe < x0 || xs > x1)
+            ; //nothing to do
+        else {
+            xs = max(xs, x0);
+            xe = min(xe, x1);
+            Rbo n(PointN16(xs,y), xe-xs+1);
+            res.add(n);
+            IPLLOG_DEBUG("new rbo: " << n);
+        }
+        ++r;
+    }
+}
+
 std::ostream &
 Region::print(std::ostream & os) const
 {
@@ -277,6 +290,7 @@ Region::add(Rbo const & s)
 {
     IPL_ASSERT(s.len() > 0);
     rbos_.push_back(s);
+    this->invalidateCaches();
     return *this;
 }
 
@@ -318,6 +332,169 @@ Region::invalidateCaches()
     center_.invalidate();
 }
 
+/*****************************************************************************/
+// binarization
+
+IPL_ANON_NS_BEGIN
+
+//! Collects the runs of a binarized scanline.
+/*! The scanline is passed in chunks of up to 64 pixels as bit masks, bit @em k
+ * of a mask is set if the pixel @em k of the chunk belongs to the Region.
+ * A run may span several chunks.
+ */
+class RunCollector
+{
+public:
+    //! ctr, collects into @a reg
+    explicit RunCollector(Region & reg)
+        : reg_(reg), y_(0), start_(0), inRun_(false) {
+    }
+    //! Start a new scanline in row @a y.
+    void row(N32 y) {
+        IPL_ASSERT(!inRun_);
+        y_ = y;
+    }
+    //! The mask @a m of the @a n pixels starting at column @a x.
+    /*! Only the boundaries of the runs are visited, so chunks completely
+     * inside or outside of a run cost a few instructions.
+     */
+    void mask(UN64 m, N32 x, N32 n) {
+        UN64 const all = n == 64 ? ~UN64(0) : (UN64(1) << n) - 1;
+        N32 pos = 0;
+        while (pos < n) {
+            UN64 const rest = ((inRun_ ? ~m : m) & all) >> pos;
+            if (!rest)
+                return;
+            pos += mathli::lowestBit(rest);
+            if (inRun_)
+                reg_.add(Rbo(PointN16(start_, y_), x + pos - start_));
+            else
+                start_ = x + pos;
+            inRun_ = !inRun_;
+        }
+    }
+    //! End of the scanline at column @a x.
+    void end(N32 x) {
+        if (inRun_)
+            reg_.add(Rbo(PointN16(start_, y_), x - start_));
+        inRun_ = false;
+    }
+private:
+    Region & reg_;
+    N32 y_;
+    N32 start_;
+    bool inRun_;
+};
+
+//! Binarize the pixels [@a p, @a last) starting at column @a x.
+/*! A pixel belongs to the Region, if its value is in [@a lo, @a hi], so
+ * there are no runs if @a lo > @a hi.
+ */
+template<typename T>
+void
+binarizeScalar(T const * p, T const * last, N32 lo, N32 hi, N32 x,
+               RunCollector & runs)
+{
+    while (p != last) {
+        N32 const n = std::min<N32>(last - p, 64);
+        UN64 m = 0;
+        for (N32 k = 0; k < n; ++k)
+            if (p[k] >= lo && p[k] <= hi)
+                m |= UN64(1) << k;
+        runs.mask(m, x, n);
+        p += n;
+        x += n;
+    }
+}
+
+//! Binarize the pixels [@a p, @a last) starting at column @a x.
+template<typename T>
+inline void
+binarize(T const * p, T const * last, N32 lo, N32 hi, N32 x,
+         RunCollector & runs)
+{
+    if (lo > hi)
+        return;
+    binarizeScalar(p, last, lo, hi, x, runs);
+}
+
+#if defined(__SSE2__)
+/*! @internal A pixel @em v is in the range iff <tt>min(max(v, lo), hi) == v</tt>,
+ * which holds only for @a lo <= @a hi; else it would accept <tt>v == hi</tt>.
+ * The comparison yields a byte mask, which we compress with movemask to a bit
+ * mask for the RunCollector. With AVX2 we process 32 pixels at once, else 16.
+ */
+inline void
+binarize(UN8 const * p, UN8 const * last, N32 lo, N32 hi, N32 x,
+         RunCollector & runs)
+{
+    if (lo > hi || hi < 0 || lo > 255)
+        return;
+    lo = std::max(lo, 0);
+    hi = std::min(hi, 255);
+#if defined(__AVX2__)
+    __m256i const wlo = _mm256_set1_epi8(static_cast<char>(lo)),
+        whi = _mm256_set1_epi8(static_cast<char>(hi));
+    for ( ; last - p >= 32; p += 32, x += 32) {
+        __m256i const v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p)),
+            c = _mm256_min_epu8(_mm256_max_epu8(v, wlo), whi);
+        runs.mask(static_cast<UN32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, v))), x, 32);
+    }
+#endif
+    __m128i const vlo = _mm_set1_epi8(static_cast<char>(lo)),
+        vhi = _mm_set1_epi8(static_cast<char>(hi));
+    for ( ; last - p >= 16; p += 16, x += 16) {
+        __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p)),
+            c = _mm_min_epu8(_mm_max_epu8(v, vlo), vhi);
+        runs.mask(static_cast<UN32>(_mm_movemask_epi8(_mm_cmpeq_epi8(c, v))), x, 16);
+    }
+    binarizeScalar(p, last, lo, hi, x, runs);
+}
+
+/*! @internal As for UN8, but with signed 16 bit comparisons. The word masks
+ * of two vectors are packed into one byte mask before movemask.
+ */
+inline void
+binarize(N16 const * p, N16 const * last, N32 lo, N32 hi, N32 x,
+         RunCollector & runs)
+{
+    if (lo > hi || hi < numeric_limits<N16>::min()
+        || lo > numeric_limits<N16>::max())
+        return;
+    lo = std::max<N32>(lo, numeric_limits<N16>::min());
+    hi = std::min<N32>(hi, numeric_limits<N16>::max());
+#if defined(__AVX2__)
+    __m256i const wlo = _mm256_set1_epi16(static_cast<N16>(lo)),
+        whi = _mm256_set1_epi16(static_cast<N16>(hi));
+    for ( ; last - p >= 32; p += 32, x += 32) {
+        __m256i const v0 = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p)),
+            v1 = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p + 16)),
+            c0 = _mm256_cmpeq_epi16(_mm256_min_epi16(_mm256_max_epi16(v0, wlo), whi), v0),
+            c1 = _mm256_cmpeq_epi16(_mm256_min_epi16(_mm256_max_epi16(v1, wlo), whi), v1),
+            // packs works per 128 bit lane, restore the order of the pixels
+            c = _mm256_permute4x64_epi64(_mm256_packs_epi16(c0, c1), 0xd8);
+        runs.mask(static_cast<UN32>(_mm256_movemask_epi8(c)), x, 32);
+    }
+#endif
+    __m128i const vlo = _mm_set1_epi16(static_cast<N16>(lo)),
+        vhi = _mm_set1_epi16(static_cast<N16>(hi));
+    for ( ; last - p >= 16; p += 16, x += 16) {
+        __m128i const v0 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p)),
+            v1 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p + 8)),
+            c0 = _mm_cmpeq_epi16(_mm_min_epi16(_mm_max_epi16(v0, vlo), vhi), v0),
+            c1 = _mm_cmpeq_epi16(_mm_min_epi16(_mm_max_epi16(v1, vlo), vhi), v1);
+        runs.mask(static_cast<UN32>(_mm_movemask_epi8(_mm_packs_epi16(c0, c1))), x, 16);
+    }
+    binarizeScalar(p, last, lo, hi, x, runs);
+}
+#endif
+
+IPL_ANON_NS_END
+
+/*! @internal Each scanline of the roi is binarized in chunks, the SIMD
+ * variants of binarize compare 16 or 32 pixels at once and yield a bit mask.
+ * The RunCollector then jumps from boundary to boundary of the runs.
+ */
 template<typename T>
 void
 Region::createFromPic(PictImg<T> const & img,
@@ -332,34 +509,233 @@ Region::createFromPic(PictImg<T> const & img,
         IPL_ASSERT_VALID(*this);
         return;
     }
-    auto scan = img.rboBegin();
-    auto scanLast = img.rboEnd();
-
-    for ( ; scan != scanLast; ++scan) {
-        auto first = img.begin(scan);
-        auto last = img.end(scan);
-        auto i = first;
-        typename PictImg<T>::ConstIterator blobStart;
-        do {
-            while (i != last &&
-                   (*i < lo || *i > hi))
-                ++i;
-            if (i == last)
-                break;
-            IPL_ASSERT(i < last);
-            blobStart = i;
-            while (i != last &&
-                   (*i >= lo && *i <= hi))
-                ++i;
-            this->add(Rbo(PointN16(scan->start().x_+(blobStart-first),
-                                   scan->start().y_),
-                          i - blobStart));
-        } while(i != last);
-    }
+    binarizeRange(img, lo, hi, img.rboBegin(), img.rboEnd(), *this);
     IPLLOG_INFO(IPL_FNC_NAME << ": -> " << *this);
     IPL_ASSERT_VALID(*this);
 }
 
+template<typename T>
+void
+Region::binarizeRange(PictImg<T> const & img, N32 lo, N32 hi,
+                      RboIterator first, RboIterator last,
+                      Region & res)
+{
+    RunCollector runs(res);
+    for (auto scan = first; scan != last; ++scan) {
+        runs.row(scan->start().y_);
+        binarize(img.begin(scan), img.end(scan), lo, hi, scan->start().x_, runs);
+        runs.end(scan->start().x_ + scan->len());
+    }
+}
+
+template void Region::binarizeRange(PictImg<UN8> const &, N32, N32,
+                                    RboIterator, RboIterator, Region &);
+template void Region::binarizeRange(PictImg<N16> const &, N32, N32,
+                                    RboIterator, RboIterator, Region &);
+template void Region::createFromPic(PictImg<UN8> const &, N32, N32);
+template void Region::createFromPic(PictImg<N16> const &, N32, N32);
+
+template<typename T>
+void
+Region::binarizeRow(T const * first, T const * last, N32 lo, N32 hi,
+                    PointN16 const & start,
+                    Region & res)
+{
+    RunCollector runs(res);
+    runs.row(start.y_);
+    binarize(first, last, lo, hi, start.x_, runs);
+    runs.end(start.x_ + (last - first));
+}
+
+template void Region::binarizeRow(UN8 const *, UN8 const *, N32, N32,
+                                  PointN16 const &, Region &);
+template void Region::binarizeRow(N16 const *, N16 const *, N32, N32,
+                                  PointN16 const &, Region &);
+template void Region::binarizeRow(UN16 const *, UN16 const *, N32, N32,
+                                  PointN16 const &, Region &);
+
+/*! @internal Eight bytes are gathered into a word with the first byte in
+ * the lowest bits, then the bits of each byte are reversed, so the bit
+ * @em k of the word is the pixel @em k as for the RunCollector.
+ */
+void
+Region::unpackRow(UN8 const * first, N32 width,
+                  PointN16 const & start,
+                  Region & res)
+{
+    RunCollector runs(res);
+    runs.row(start.y_);
+    for (N32 x = 0; x < width; x += 64, first += 8) {
+        N32 const n = std::min<N32>(width - x, 64);
+        UN64 m = 0;
+        for (N32 k = 0; k < (n + 7) / 8; ++k)
+            m |= UN64(first[k]) << (8 * k);
+        m = (m >> 1 & 0x5555555555555555ULL) | (m & 0x5555555555555555ULL) << 1;
+        m = (m >> 2 & 0x3333333333333333ULL) | (m & 0x3333333333333333ULL) << 2;
+        m = (m >> 4 & 0x0f0f0f0f0f0f0f0fULL) | (m & 0x0f0f0f0f0f0f0f0fULL) << 4;
+        runs.mask(m, start.x_ + x, n);
+    }
+    runs.end(start.x_ + width);
+}
+
+IPL_ANON_NS_BEGIN
+
+//! The label of pixels belonging to none of the Regions.
+N32 const noLabel = numeric_limits<N32>::min();
+
+//! Split the scanlines of the roi of @a img into runs of equal labels.
+/*! @a label maps a grayvalue to a label, @a add(label, rbo) is called for
+ * every maximal run of the same label, except for noLabel.
+ */
+template<typename T, typename Label, typename Add>
+void
+splitRuns(PictImg<T> const & img, Label label, Add add)
+{
+    for (auto scan = img.rboBegin(); scan != img.rboEnd(); ++scan) {
+        auto const first = img.begin(scan),
+            last = img.end(scan);
+        auto p = first;
+        while (p != last) {
+            auto const start = p;
+            T const v = *p;
+            N32 const l = label(v);
+            // pixels with the same grayvalue have the same label
+            while (++p != last && (*p == v || label(*p) == l))
+                ;
+            if (l != noLabel)
+                add(l, Rbo(PointN16(scan->start().x_ + (start - first),
+                                    scan->start().y_),
+                           p - start));
+        }
+    }
+}
+
+//! Label of a grayvalue: the index of the interval containing it.
+class ThresholdLabel
+{
+public:
+    //! ctr, @a thresholds must be sorted and disjunct
+    explicit ThresholdLabel(vector<Region::Threshold> const & thresholds)
+        : thresholds_(thresholds) {
+    }
+    //! call-operator
+    N32 operator()(N32 v) const {
+        auto t = upper_bound(thresholds_.begin(), thresholds_.end(),
+                             Region::Threshold(v, numeric_limits<N32>::max()));
+        if (t == thresholds_.begin() || (--t)->second < v)
+            return noLabel;
+        return t - thresholds_.begin();
+    }
+private:
+    vector<Region::Threshold> const & thresholds_;
+};
+
+//! Label of a grayvalue by a lookup table.
+class LutLabel
+{
+public:
+    //! ctr
+    explicit LutLabel(vector<N32> const & lut)
+        : lut_(lut) {
+    }
+    //! call-operator
+    N32 operator()(UN8 v) const {
+        return lut_[v];
+    }
+private:
+    vector<N32> const & lut_;
+};
+
+//! Check if the intervals @a thresholds are sorted and disjunct.
+bool
+validThresholds(vector<Region::Threshold> const & thresholds)
+{
+    for (auto t = thresholds.begin(); t != thresholds.end(); ++t) {
+        if (t->first > t->second
+            || (t != thresholds.begin() && (t-1)->second >= t->first))
+            return false;
+    }
+    return true;
+}
+
+//! Distribute the runs of @a img to one Region per label.
+template<typename T, typename Label>
+vector<Region> const
+labelRegions(PictImg<T> const & img, N32 nr, Label label)
+{
+    vector<Region> regs(nr);
+    splitRuns(img, label, [&regs](N32 l, Rbo const & r) {
+        regs[l].add(r);
+    });
+    return regs;
+}
+
+//! Distribute the runs of @a img to one Region per grayvalue.
+template<typename T>
+map<N32, Region> const
+valueRegions(PictImg<T> const & img)
+{
+    map<N32, Region> regs;
+    auto last = regs.end();
+    splitRuns(img, [](N32 v) { return v; },
+              [&regs, &last](N32 l, Rbo const & r) {
+                  if (last == regs.end() || last->first != l)
+                      last = regs.insert(make_pair(l, Region())).first;
+                  last->second.add(r);
+              });
+    return regs;
+}
+
+IPL_ANON_NS_END
+
+/*! @internal For 8 bit images the intervals are precomputed in a lookup
+ * table.
+ */
+vector<Region> const
+Region::fromThresholds(PictImg<UN8> const & img,
+                       vector<Threshold> const & thresholds)
+{
+    IPL_ASSERT_VALID(img);
+    IPLLOG_INFO(IPL_FNC_NAME << " with " << thresholds.size() << " intervals");
+    if (!validThresholds(thresholds))
+        throw ParameterError(2, IPL_FNC_NAME);
+    vector<N32> lut(256);
+    ThresholdLabel const label(thresholds);
+    for (N32 v = 0; v < 256; ++v)
+        lut[v] = label(v);
+    return labelRegions(img, thresholds.size(), LutLabel(lut));
+}
+
+/*! @internal The interval of a pixel is found by a binary search, but only
+ * if its grayvalue differs from the one at the start of the actual run.
+ */
+vector<Region> const
+Region::fromThresholds(PictImg<N16> const & img,
+                       vector<Threshold> const & thresholds)
+{
+    IPL_ASSERT_VALID(img);
+    IPLLOG_INFO(IPL_FNC_NAME << " with " << thresholds.size() << " intervals");
+    if (!validThresholds(thresholds))
+        throw ParameterError(2, IPL_FNC_NAME);
+    return labelRegions(img, thresholds.size(), ThresholdLabel(thresholds));
+}
+
+map<N32, Region> const
+Region::fromLabels(PictImg<UN8> const & img)
+{
+    IPL_ASSERT_VALID(img);
+    IPLLOG_INFO(IPL_FNC_NAME);
+    return valueRegions(img);
+}
+
+map<N32, Region> const
+Region::fromLabels(PictImg<N16> const & img)
+{
+    IPL_ASSERT_VALID(img);
+    IPLLOG_INFO(IPL_FNC_NAME);
+    return valueRegions(img);
+}
+
 /*****************************************************************************/
 
 
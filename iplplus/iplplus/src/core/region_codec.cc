@@ -0,0 +1,708 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  CCITT Group 4 and PackBits codes of Regions
+ *
+ ********************************************************************/
+
+#include "ipl/region.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(IPL_HAVE_TIFF)
+#    include <tiffio.h>
+#endif
+
+#include "ipl/iplerr.hh"
+
+using namespace std;
+
+IPL_NS_BEGIN
+
+IPL_ANON_NS_BEGIN
+
+//! @name Code Tables of T.4
+//@{
+//! terminating codes of the white runs 0, ..., 63
+char const * const whiteTerm[64] = {
+    "00110101", "000111", "0111", "1000", "1011", "1100", "1110", "1111",
+    "10011", "10100", "00111", "01000", "001000", "000011", "110100", "110101",
+    "101010", "101011", "0100111", "0001100", "0001000", "0010111", "0000011",
+    "0000100", "0101000", "0101011", "0010011", "0100100", "0011000",
+    "00000010", "00000011", "00011010", "00011011", "00010010", "00010011",
+    "00010100", "00010101", "00010110", "00010111", "00101000", "00101001",
+    "00101010", "00101011", "00101100", "00101101", "00000100", "00000101",
+    "00001010", "00001011", "01010010", "01010011", "01010100", "01010101",
+    "00100100", "00100101", "01011000", "01011001", "01011010", "01011011",
+    "01001010", "01001011", "00110010", "00110011", "00110100"
+};
+
+//! make up codes of the white runs 64, 128, ..., 1728
+char const * const whiteMakeUp[27] = {
+    "11011", "10010", "010111", "0110111", "00110110", "00110111", "01100100",
+    "01100101", "01101000", "01100111", "011001100", "011001101", "011010010",
+    "011010011", "011010100", "011010101", "011010110", "011010111",
+    "011011000", "011011001", "011011010", "011011011", "010011000",
+    "010011001", "010011010", "011000", "010011011"
+};
+
+//! terminating codes of the black runs 0, ..., 63
+char const * const blackTerm[64] = {
+    "0000110111", "010", "11", "10", "011", "0011", "0010", "00011", "000101",
+    "000100", "0000100", "0000101", "0000111", "00000100", "00000111",
+    "000011000", "0000010111", "0000011000", "0000001000", "00001100111",
+    "00001101000", "00001101100", "00000110111", "00000101000", "00000010111",
+    "00000011000", "000011001010", "000011001011", "000011001100",
+    "000011001101", "000001101000", "000001101001", "000001101010",
+    "000001101011", "000011010010", "000011010011", "000011010100",
+    "000011010101", "000011010110", "000011010111", "000001101100",
+    "000001101101", "000011011010", "000011011011", "000001010100",
+    "000001010101", "000001010110", "000001010111", "000001100100",
+    "000001100101", "000001010010", "000001010011", "000000100100",
+    "000000110111", "000000111000", "000000100111", "000000101000",
+    "000001011000", "000001011001", "000000101011", "000000101100",
+    "000001011010", "000001100110", "000001100111"
+};
+
+//! make up codes of the black runs 64, 128, ..., 1728
+char const * const blackMakeUp[27] = {
+    "0000001111", "000011001000", "000011001001", "000001011011",
+    "000000110011", "000000110100", "000000110101", "0000001101100",
+    "0000001101101", "0000001001010", "0000001001011", "0000001001100",
+    "0000001001101", "0000001110010", "0000001110011", "0000001110100",
+    "0000001110101", "0000001110110", "0000001110111", "0000001010010",
+    "0000001010011", "0000001010100", "0000001010101", "0000001011010",
+    "0000001011011", "0000001100100", "0000001100101"
+};
+
+//! make up codes of both colors for the runs 1792, 1856, ..., 2560
+char const * const extMakeUp[13] = {
+    "00000001000", "00000001100", "00000001101", "000000010010",
+    "000000010011", "000000010100", "000000010101", "000000010110",
+    "000000010111", "000000011100", "000000011101", "000000011110",
+    "000000011111"
+};
+//@}
+
+//! The coding modes of T.6.
+enum Mode {
+    Pass,
+    Horizontal,
+    Vertical     //!< Vertical + 3 + d is the mode V(d)
+};
+
+//! Codes of the modes, the vertical modes for d = -3, ..., 3.
+char const * const modeCodes[9] = {
+    "0001", "001",
+    "0000010", "000010", "010", "1", "011", "000011", "0000011"
+};
+
+//! A code word.
+struct Code {
+    Code() : bits(0), len(0) {
+    }
+    UN32 bits;
+    N32 len;
+};
+
+//! Entry of a decoding table.
+struct Entry {
+    Entry() : value(0), len(0) {
+    }
+    N16 value;
+    N16 len;    //!< 0 for an invalid code
+};
+
+//! Number of bits of the lookup of the decoding tables, the longest code.
+N32 const lookupBits = 13;
+
+//! The coding and decoding tables.
+/*! Are built once from the code strings.
+ */
+class CodeTables
+{
+public:
+    //! The tables.
+    static CodeTables const & get() {
+        static CodeTables const tables;
+        return tables;
+    }
+    //! Terminating codes of the color @a black.
+    Code const & term(bool black, N32 run) const {
+        return term_[black][run];
+    }
+    //! Make up code of the color @a black for a multiple of 64 up to 2560.
+    Code const & makeUp(bool black, N32 run) const {
+        return makeUp_[black][run / 64];
+    }
+    Code const & mode(N32 m) const {
+        return mode_[m];
+    }
+    //! Decoding table of the runs of color @a black.
+    Entry const & run(bool black, UN32 bits) const {
+        return run_[black][bits];
+    }
+    //! Decoding table of the modes.
+    Entry const & mode(UN32 bits) const {
+        return modeLookup_[bits];
+    }
+private:
+    CodeTables()
+        : modeLookup_(1 << lookupBits) {
+        for (N32 c = 0; c < 2; ++c) {
+            run_[c].resize(1 << lookupBits);
+            term_[c].resize(64);
+            makeUp_[c].resize(41);
+            for (N32 r = 0; r < 64; ++r)
+                add(c ? blackTerm[r] : whiteTerm[r], r, term_[c][r], run_[c]);
+            for (N32 k = 0; k < 27; ++k)
+                add(c ? blackMakeUp[k] : whiteMakeUp[k], 64 * (k+1),
+                    makeUp_[c][k+1], run_[c]);
+            for (N32 k = 0; k < 13; ++k)
+                add(extMakeUp[k], 1792 + 64 * k, makeUp_[c][28+k], run_[c]);
+        }
+        mode_.resize(9);
+        for (N32 m = 0; m < 9; ++m)
+            add(modeCodes[m], m, mode_[m], modeLookup_);
+    }
+    //! Add @a code with @a value to the tables.
+    static void add(char const * code, N32 value, Code & enc, vector<Entry> & dec) {
+        enc.len = strlen(code);
+        for (char const * c = code; *c; ++c)
+            enc.bits = (enc.bits << 1) | (*c == '1');
+        UN32 const first = enc.bits << (lookupBits - enc.len),
+            last = (enc.bits + 1) << (lookupBits - enc.len);
+        for (UN32 i = first; i < last; ++i) {
+            dec[i].value = value;
+            dec[i].len = enc.len;
+        }
+    }
+
+    vector<Code> term_[2];
+    vector<Code> makeUp_[2];
+    vector<Code> mode_;
+    vector<Entry> run_[2];
+    vector<Entry> modeLookup_;
+};
+
+//! Writes codes MSB first.
+class BitWriter
+{
+public:
+    explicit BitWriter(vector<UN8> & out)
+        : out_(out), acc_(0), n_(0) {
+    }
+    void put(Code const & c) {
+        acc_ = (acc_ << c.len) | c.bits;
+        n_ += c.len;
+        while (n_ >= 8) {
+            n_ -= 8;
+            out_.push_back(static_cast<UN8>(acc_ >> n_));
+        }
+    }
+    //! Pad to a whole byte with 0's.
+    void flush() {
+        if (n_)
+            out_.push_back(static_cast<UN8>(acc_ << (8 - n_)));
+        n_ = 0;
+    }
+private:
+    vector<UN8> & out_;
+    UN64 acc_;
+    N32 n_;
+};
+
+//! Reads codes MSB first.
+/*! Beyond the end there are 0's, which are invalid codes resp. the
+ * beginning of them.
+ */
+class BitReader
+{
+public:
+    BitReader(UN8 const * first, UN8 const * last)
+        : p_(first), last_(last), acc_(0), n_(0), over_(0) {
+    }
+    //! The next @a n bits.
+    UN32 peek(N32 n) {
+        while (n_ < n) {
+            acc_ <<= 8;
+            if (p_ != last_)
+                acc_ |= *p_++;
+            else
+                over_ += 8;
+            n_ += 8;
+        }
+        return static_cast<UN32>(acc_ >> (n_ - n)) & ((UN32(1) << n) - 1);
+    }
+    void skip(N32 n) {
+        n_ -= n;
+    }
+    //! Read bits beyond the end?
+    bool truncated() const {
+        return over_ > n_;
+    }
+private:
+    UN8 const * p_;
+    UN8 const * last_;
+    UN64 acc_;
+    N32 n_;
+    N32 over_;
+};
+
+//! Changing elements of a row.
+/*! The positions where the color changes, the first one is a change from
+ * white to black. Three elements @a width at the end stand for the end of
+ * the row, so the coder never has to check the size.
+ */
+class Changes
+{
+public:
+    explicit Changes(N32 width)
+        : width_(width) {
+        clear();
+    }
+    //! Start a new row.
+    void clear() {
+        pos_.clear();
+    }
+    //! Append the run [@a xs, @a xe), must be right of the last run.
+    void addRun(N32 xs, N32 xe) {
+        xs = max<N32>(xs, 0);
+        xe = min<N32>(xe, width_);
+        if (xs >= xe)
+            return;
+        if (!pos_.empty() && pos_.back() == xs)
+            pos_.back() = xe;
+        else {
+            pos_.push_back(xs);
+            pos_.push_back(xe);
+        }
+    }
+    //! Append the end of row sentinels.
+    void close() {
+        if (!pos_.empty() && pos_.back() == width_)
+            pos_.pop_back();
+        pos_.insert(pos_.end(), 3, width_);
+    }
+    N32 operator[](N32 i) const {
+        return pos_[i];
+    }
+    N32 width() const {
+        return width_;
+    }
+    void swap(Changes & other) {
+        pos_.swap(other.pos_);
+    }
+private:
+    N32 width_;
+    vector<N32> pos_;
+};
+
+//! Find @a b1 on the reference line @a ref.
+/*! @a i is the first changing element right of @a a0, which is updated.
+ * @a b1 is the first changing element right of @a a0 with the opposite color
+ * of @a color (0: white, 1: black).
+ */
+inline N32
+findB1(Changes const & ref, N32 a0, N32 color, N32 & i)
+{
+    while (ref[i] <= a0 && ref[i] < ref.width())
+        ++i;
+    return i + ((i & 1) != color);
+}
+
+//! Append the code of a run of @a len pixels of color @a black.
+void
+putRun(BitWriter & bits, CodeTables const & tables, bool black, N32 len)
+{
+    while (len >= 2560 + 64) {
+        bits.put(tables.makeUp(black, 2560));
+        len -= 2560;
+    }
+    if (len >= 64) {
+        bits.put(tables.makeUp(black, len));
+        len %= 64;
+    }
+    bits.put(tables.term(black, len));
+}
+
+//! Read a run of color @a black.
+N32
+getRun(BitReader & bits, CodeTables const & tables, bool black)
+{
+    N32 len = 0;
+    for (;;) {
+        Entry const & e = tables.run(black, bits.peek(lookupBits));
+        if (!e.len)
+            throw IoError("invalid run length code in G4 data");
+        bits.skip(e.len);
+        len += e.value;
+        if (e.value < 64)
+            return len;
+    }
+}
+
+//! T.6 coding of the row @a cur with the reference row @a ref.
+void
+encodeRow(Changes const & ref, Changes const & cur,
+          BitWriter & bits, CodeTables const & tables)
+{
+    N32 const width = cur.width();
+    N32 a0 = -1, color = 0, i = 0, k = 0;
+    while (a0 < width) {
+        N32 const j = findB1(ref, a0, color, i),
+            b1 = ref[j],
+            b2 = ref[j+1];
+        while (cur[k] <= a0 && cur[k] < width)
+            ++k;
+        N32 const a1 = cur[k];
+        if (b2 < a1) {
+            bits.put(tables.mode(Pass));
+            a0 = b2;
+        } else if (a1 - b1 >= -3 && a1 - b1 <= 3) {
+            bits.put(tables.mode(Vertical + 3 + a1 - b1));
+            a0 = a1;
+            color = !color;
+        } else {
+            N32 const a2 = cur[k+1];
+            bits.put(tables.mode(Horizontal));
+            putRun(bits, tables, color, a1 - max<N32>(a0, 0));
+            putRun(bits, tables, !color, a2 - a1);
+            a0 = a2;
+        }
+    }
+}
+
+//! T.6 decoding of the row @a cur with the reference row @a ref.
+void
+decodeRow(Changes const & ref, Changes & cur,
+          BitReader & bits, CodeTables const & tables)
+{
+    N32 const width = cur.width();
+    N32 a0 = -1, color = 0, i = 0, start = 0;
+    cur.clear();
+    while (a0 < width) {
+        N32 const j = findB1(ref, a0, color, i),
+            b1 = ref[j],
+            b2 = ref[j+1];
+        Entry const & e = tables.mode(bits.peek(lookupBits));
+        if (!e.len)
+            throw IoError("invalid mode code in G4 data");
+        bits.skip(e.len);
+        N32 a1;
+        switch (e.value) {
+        case Pass:
+            a0 = b2;
+            continue;
+        case Horizontal: {
+            N32 const r1 = getRun(bits, tables, color);
+            a1 = max<N32>(a0, 0) + r1;
+            N32 const a2 = a1 + getRun(bits, tables, !color);
+            if (a2 > width)
+                throw IoError("run beyond the end of the row in G4 data");
+            if (color)
+                cur.addRun(start, a1);
+            else
+                cur.addRun(a1, a2);
+            a0 = a2;
+            start = a2;
+            continue;
+        }
+        default:
+            a1 = b1 + e.value - Vertical - 3;
+            if (a1 < max<N32>(a0, 0) || a1 > width)
+                throw IoError("invalid vertical mode in G4 data");
+            if (color)
+                cur.addRun(start, a1);
+            start = a1;
+            a0 = a1;
+            color = !color;
+        }
+    }
+    cur.close();
+    if (bits.truncated())
+        throw IoError("truncated G4 data");
+}
+
+//! Collects the pixels of a bilevel row.
+class RowRuns
+{
+public:
+    explicit RowRuns(N32 width)
+        : changes_(width), x_(0), black_(false), start_(0) {
+    }
+    //! Append @a n pixels of color @a black.
+    void span(bool black, N32 n) {
+        if (black != black_) {
+            if (black_)
+                changes_.addRun(start_, x_);
+            start_ = x_;
+            black_ = black;
+        }
+        x_ += n;
+    }
+    //! Append the 8 pixels of the byte @a b.
+    void byte(UN8 b) {
+        if (b == 0 || b == 0xff)
+            span(b, 8);
+        else
+            for (N32 k = 7; k >= 0; --k)
+                span((b >> k) & 1, 1);
+    }
+    //! Finish the row, returns its changing elements.
+    Changes const & finish() {
+        span(false, 0);
+        changes_.close();
+        x_ = 0;
+        return changes_;
+    }
+    //! Start the next row.
+    void clear() {
+        changes_.clear();
+    }
+private:
+    Changes changes_;
+    N32 x_;
+    bool black_;
+    N32 start_;
+};
+
+//! PackBits coding of the bytes [@a p, @a last).
+void
+packBits(UN8 const * p, UN8 const * last, vector<UN8> & out)
+{
+    while (p != last) {
+        // repeated bytes
+        UN8 const * q = p + 1;
+        while (q != last && *q == *p && q - p < 128)
+            ++q;
+        if (q - p >= 2) {
+            out.push_back(static_cast<UN8>(1 - (q - p)));
+            out.push_back(*p);
+            p = q;
+            continue;
+        }
+        // literal bytes up to the next repetition
+        q = p + 1;
+        while (q != last && q - p < 128 && (q + 1 == last || *q != *(q+1)))
+            ++q;
+        out.push_back(static_cast<UN8>(q - p - 1));
+        out.insert(out.end(), p, q);
+        p = q;
+    }
+}
+
+//! Check the size of a bilevel image.
+void
+checkSize(N32 width, N32 height, char const * fnc)
+{
+    N32 const maxSize = 1 << 15;
+    if (width <= 0 || width > maxSize)
+        throw ParameterError(1, fnc);
+    if (height <= 0 || height > maxSize)
+        throw ParameterError(2, fnc);
+}
+
+IPL_ANON_NS_END
+
+/*! @internal The changing elements of T.6 are the boundaries of the Rbo's,
+ * so each row is coded from the Rbo's and the ones of the previous row.
+ */
+std::vector<UN8> const
+Region::encodeG4(N32 width, N32 height) const
+{
+    IPL_ASSERT_VALID(*this);
+    checkSize(width, height, IPL_FNC_NAME);
+    CodeTables const & tables = CodeTables::get();
+    vector<UN8> code;
+    BitWriter bits(code);
+    Changes ref(width), cur(width);
+    ref.close();
+    auto r = this->begin();
+    auto const e = this->end();
+    while (r != e && r->start().y_ < 0)
+        ++r;
+    for (N32 y = 0; y < height; ++y) {
+        cur.clear();
+        for ( ; r != e && r->start().y_ == y; ++r)
+            cur.addRun(r->start().x_, r->start().x_ + r->len());
+        cur.close();
+        encodeRow(ref, cur, bits, tables);
+        ref.swap(cur);
+    }
+    bits.flush();
+    return code;
+}
+
+Region const
+Region::decodeG4(std::vector<UN8> const & code, N32 width, N32 height)
+{
+    checkSize(width, height, IPL_FNC_NAME);
+    Region res;
+    decodeG4(code.empty() ? 0 : &code[0], code.empty() ? 0 : &code[0] + code.size(),
+             width, 0, height, res);
+    IPL_ASSERT_VALID(res);
+    return res;
+}
+
+void
+Region::decodeG4(UN8 const * first, UN8 const * last,
+                 N32 width, N32 y0, N32 height,
+                 Region & res)
+{
+    CodeTables const & tables = CodeTables::get();
+    BitReader bits(first, last);
+    Changes ref(width), cur(width);
+    ref.close();
+    for (N32 y = y0; y < y0 + height; ++y) {
+        decodeRow(ref, cur, bits, tables);
+        for (N32 k = 0; cur[k] < width; k += 2)
+            res.add(Rbo(PointN16(cur[k], y), cur[k+1] - cur[k]));
+        ref.swap(cur);
+    }
+}
+
+/*! @internal The bytes of each row are set span by span from the Rbo's.
+ */
+std::vector<UN8> const
+Region::encodePackBits(N32 width, N32 height) const
+{
+    IPL_ASSERT_VALID(*this);
+    checkSize(width, height, IPL_FNC_NAME);
+    N32 const rowBytes = (width + 7) / 8;
+    vector<UN8> code, row(rowBytes);
+    auto r = this->begin();
+    auto const e = this->end();
+    while (r != e && r->start().y_ < 0)
+        ++r;
+    for (N32 y = 0; y < height; ++y) {
+        fill(row.begin(), row.end(), 0);
+        for ( ; r != e && r->start().y_ == y; ++r) {
+            N32 const xs = max<N32>(r->start().x_, 0),
+                xe = min<N32>(r->start().x_ + r->len(), width);
+            for (N32 x = xs; x < xe; ) {
+                if (x % 8 == 0 && xe - x >= 8) {
+                    N32 const n = (xe - x) / 8;
+                    memset(&row[x / 8], 0xff, n);
+                    x += 8 * n;
+                } else {
+                    row[x / 8] |= 0x80 >> (x % 8);
+                    ++x;
+                }
+            }
+        }
+        packBits(&row[0], &row[0] + rowBytes, code);
+    }
+    return code;
+}
+
+Region const
+Region::decodePackBits(std::vector<UN8> const & code, N32 width, N32 height)
+{
+    checkSize(width, height, IPL_FNC_NAME);
+    Region res;
+    decodePackBits(code.empty() ? 0 : &code[0],
+                   code.empty() ? 0 : &code[0] + code.size(),
+                   width, 0, height, res);
+    IPL_ASSERT_VALID(res);
+    return res;
+}
+
+/*! @internal Repeated bytes 0x00 and 0xff are whole spans, only the other
+ * bytes are split into pixels. Packets crossing the end of a row are
+ * accepted.
+ */
+void
+Region::decodePackBits(UN8 const * p, UN8 const * last,
+                       N32 width, N32 y0, N32 height,
+                       Region & res)
+{
+    N32 const rowBytes = (width + 7) / 8;
+    RowRuns row(width);
+    N32 y = y0, x = 0;
+    auto emit = [&]() {
+        Changes const & c = row.finish();
+        for (N32 k = 0; c[k] < width; k += 2)
+            res.add(Rbo(PointN16(c[k], y), c[k+1] - c[k]));
+        row.clear();
+        x = 0;
+        ++y;
+    };
+    while (y < y0 + height) {
+        if (p == last)
+            throw IoError("truncated PackBits data");
+        N32 const n = static_cast<signed char>(*p++);
+        if (n == -128)
+            continue;
+        if (n >= 0) {
+            if (last - p < n + 1)
+                throw IoError("truncated PackBits data");
+            for (UN8 const * q = p + n + 1; p != q && y < y0 + height; ++p) {
+                row.byte(*p);
+                if (++x == rowBytes)
+                    emit();
+            }
+        } else {
+            if (p == last)
+                throw IoError("truncated PackBits data");
+            UN8 const b = *p++;
+            for (N32 k = 1 - n; k > 0 && y < y0 + height; ) {
+                N32 const m = min(k, rowBytes - x);
+                if (b == 0 || b == 0xff)
+                    row.span(b, 8 * m);
+                else
+                    for (N32 i = 0; i < m; ++i)
+                        row.byte(b);
+                k -= m;
+                x += m;
+                if (x == rowBytes)
+                    emit();
+            }
+        }
+    }
+}
+
+/*! @internal The code is written as a single strip with
+ * TIFFWriteRawStrip, libtiff only writes the directory.
+ */
+void
+Region::saveTiff(std::string const & fn, N32 width, N32 height,
+                 BilevelCompression compression /*= G4*/) const
+{
+    IPLLOG_INFO(IPL_FNC_NAME << ": " << *this << " to " << fn);
+    checkSize(width, height, IPL_FNC_NAME);
+#if defined(IPL_HAVE_TIFF)
+    vector<UN8> code = compression == G4
+        ? this->encodeG4(width, height)
+        : this->encodePackBits(width, height);
+    TIFF * tif = TIFFOpen(fn.c_str(), "w");
+    if (!tif)
+        throw IoError("can't open " + fn);
+    TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, UN32(width));
+    TIFFSetField(tif, TIFFTAG_IMAGELENGTH, UN32(height));
+    TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, 1);
+    TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, 1);
+    TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_MINISBLACK);
+    TIFFSetField(tif, TIFFTAG_FILLORDER, FILLORDER_MSB2LSB);
+    TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+    TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, UN32(height));
+    TIFFSetField(tif, TIFFTAG_COMPRESSION,
+                 compression == G4 ? COMPRESSION_CCITTFAX4 : COMPRESSION_PACKBITS);
+    bool const ok = TIFFWriteRawStrip(tif, 0, code.empty() ? 0 : &code[0],
+                                      code.size()) >= 0;
+    TIFFClose(tif);
+    if (!ok)
+        throw IoError("can't write " + fn);
+#else
+    (void)compression;
+    throw IoError(fn + ": library built without tiff support");
+#endif
+}
+
+IPL_NS_END
@@ -0,0 +1,215 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Euclidean distance transform of a Region
+ *
+ ********************************************************************/
+
+#include "ipl/region.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "ipl/pict.hh"
+#include "ipl/iplerr.hh"
+
+using namespace std;
+
+IPL_NS_BEGIN
+
+IPL_ANON_NS_BEGIN
+
+//! @a a / @a b rounded down, for @a b > 0.
+inline N64
+floorDiv(N64 a, N64 b)
+{
+    return a >= 0 ? a / b : -((b - 1 - a) / b);
+}
+
+//! Squared distances along a row to the samples @a g.
+/*! Computes <em>d2[u] = min_i (u - i)^2 + g[i]^2</em> for all @em u in
+ * [0, @a m) by the lower envelope of the parabolas of the samples
+ * (A. Meijster et al., A General Algorithm for Computing Distance Transforms
+ * in Linear Time, 2000). @a s and @a t are scratch buffers of length @a m.
+ */
+void
+envelope(N32 const * g, N32 m, N32 * d2, N32 * s, N32 * t)
+{
+    auto f = [g](N64 x, N32 i) {
+        return (x - i) * (x - i) + N64(g[i]) * g[i];
+    };
+    auto sep = [g](N64 i, N64 u) {
+        return floorDiv(u * u - i * i + N64(g[u]) * g[u] - N64(g[i]) * g[i],
+                        2 * (u - i));
+    };
+    N32 q = 0;
+    s[0] = 0;
+    t[0] = 0;
+    for (N32 u = 1; u < m; ++u) {
+        while (q >= 0 && f(t[q], s[q]) > f(t[q], u))
+            --q;
+        if (q < 0) {
+            q = 0;
+            s[0] = u;
+        } else {
+            N64 const w = 1 + sep(s[q], u);
+            if (w < m) {
+                ++q;
+                s[q] = u;
+                t[q] = w;
+            }
+        }
+    }
+    for (N32 u = m - 1; u >= 0; --u) {
+        d2[u] = f(u, s[q]);
+        if (u == t[q])
+            --q;
+    }
+}
+
+//! Squared distances of the pixels of @a reg to its complement.
+/*! @a d2 holds the rows of the bounding box @a bb of @a reg with a column
+ * of the complement on both sides, i.e. the pixel (x, y) is at
+ * <em>(y - y0) (w + 2) + x - x0 + 1</em>. Pixels outside of @a reg are 0.
+ */
+void
+squaredDistances(Region const & reg, WinP const & bb, vector<N32> & d2)
+{
+    N32 const x0 = bb.upperLeft().x_,
+        y0 = bb.upperLeft().y_,
+        h = bb.lowerRight().y_ - y0 + 1,
+        stride = bb.lowerRight().x_ - x0 + 3;
+
+    // vertical distances, top down and bottom up, only within the Rbo's
+    d2.assign(N64(stride) * h, 0);
+    for (Region::RboIterator r = reg.begin(); r != reg.end(); ++r) {
+        N32 const y = r->start().y_ - y0;
+        N32 * p = &d2[N64(y) * stride + r->start().x_ - x0 + 1];
+        if (y == 0) {
+            fill_n(p, r->len(), 1);
+        } else {
+            N32 const * above = p - stride;
+            for (N32 k = 0; k < r->len(); ++k)
+                p[k] = above[k] + 1;
+        }
+    }
+    for (Region::RboIterator r = reg.end(); r != reg.begin(); ) {
+        --r;
+        N32 const y = r->start().y_ - y0;
+        N32 * p = &d2[N64(y) * stride + r->start().x_ - x0 + 1];
+        if (y == h - 1) {
+            fill_n(p, r->len(), 1);
+        } else {
+            N32 const * below = p + stride;
+            for (N32 k = 0; k < r->len(); ++k)
+                p[k] = min(p[k], below[k] + 1);
+        }
+    }
+
+    // horizontal: the pixels next to an Rbo are outside, so the samples
+    // beyond them are never nearer and each Rbo is done on its own
+    vector<N32> line(stride), s(stride), t(stride);
+    for (Region::RboIterator r = reg.begin(); r != reg.end(); ++r) {
+        N32 * p = &d2[N64(r->start().y_ - y0) * stride + r->start().x_ - x0];
+        envelope(p, r->len() + 2, &line[0], &s[0], &t[0]);
+        copy(line.begin() + 1, line.begin() + r->len() + 1, p + 1);
+    }
+}
+
+//! Appends the pixels of @a reg with a squared distance above @a t to @a res.
+void
+threshold(Region const & reg, WinP const & bb, vector<N32> const & d2,
+          N64 t, Region & res)
+{
+    N32 const x0 = bb.upperLeft().x_,
+        y0 = bb.upperLeft().y_,
+        stride = bb.lowerRight().x_ - x0 + 3;
+    for (Region::RboIterator r = reg.begin(); r != reg.end(); ++r) {
+        N32 const xs = r->start().x_,
+            y = r->start().y_,
+            len = r->len();
+        N32 const * d = &d2[N64(y - y0) * stride + xs - x0 + 1];
+        for (N32 k = 0; k < len; ) {
+            while (k < len && d[k] <= t)
+                ++k;
+            N32 const ks = k;
+            while (k < len && d[k] > t)
+                ++k;
+            if (k > ks)
+                res.add(Rbo(PointN16(xs + ks, y), k - ks));
+        }
+    }
+}
+
+//! The largest squared distance within a disk of radius @a radius.
+N64
+squaredRadius(F64 radius, char const * fnc)
+{
+    if (!(radius >= 0))
+        throw ParameterError(1, string(fnc) + ": negative radius");
+    return static_cast<N64>(floor(radius * radius));
+}
+
+IPL_ANON_NS_END
+
+PictImg<N16> const
+Region::distanceTransform(F64 scale) const
+{
+    IPLLOG_INFO(IPL_FNC_NAME << " of " << *this);
+    WinP const & bb = this->boundingBox();
+    vector<N32> d2;
+    squaredDistances(*this, bb, d2);
+    PictImg<N16> img(bb.lowerRight().x_ - bb.upperLeft().x_ + 1,
+                     bb.lowerRight().y_ - bb.upperLeft().y_ + 1);
+    PictImg<N16>::Iterator p = img.begin();
+    for (N32 y = 0; y < img.height(); ++y) {
+        vector<N32>::const_iterator d = d2.begin() + N64(y) * (img.width() + 2) + 1;
+        for (N32 x = 0; x < img.width(); ++x, ++d, ++p)
+            *p = static_cast<N16>(min(floor(scale * sqrt(F64(*d)) + 0.5), 32767.0));
+    }
+    return img;
+}
+
+/*! @internal A pixel survives the erosion, if no pixel of the complement is
+ * within the disk around it. Distances are square roots of integers, so
+ * comparing the squared distance with the floor of the squared radius is
+ * exact.
+ */
+Region const
+Region::erodeDisk(F64 radius) const
+{
+    IPLLOG_INFO(IPL_FNC_NAME << " " << radius << " of " << *this);
+    N64 const t = squaredRadius(radius, IPL_FNC_NAME);
+    Region res;
+    if (this->empty())
+        return res;
+    vector<N32> d2;
+    squaredDistances(*this, this->boundingBox(), d2);
+    threshold(*this, this->boundingBox(), d2, t, res);
+    IPL_ASSERT_VALID(res);
+    return res;
+}
+
+std::vector<Region> const
+Region::erodeDisks(std::vector<F64> const & radii) const
+{
+    IPLLOG_INFO(IPL_FNC_NAME << " " << radii.size() << " radii of " << *this);
+    vector<Region> res(radii.size());
+    for (size_t i = 0; i < radii.size(); ++i)
+        squaredRadius(radii[i], IPL_FNC_NAME);
+    if (this->empty())
+        return res;
+    vector<N32> d2;
+    squaredDistances(*this, this->boundingBox(), d2);
+    for (size_t i = 0; i < radii.size(); ++i)
+        threshold(*this, this->boundingBox(), d2,
+                  squaredRadius(radii[i], IPL_FNC_NAME), res[i]);
+    return res;
+}
+
+IPL_NS_END
@@ -0,0 +1,375 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Shape features and attribute filters of a Region
+ *
+ ********************************************************************/
+
+#include "ipl/region.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "ipl/blobs.hh"
+#include "ipl/iplerr.hh"
+
+using namespace std;
+
+IPL_NS_BEGIN
+
+IPL_ANON_NS_BEGIN
+
+//! Sums over the Rbo's of a Region.
+/*! The coordinates are relative to an origin near the Region, which keeps
+ * the sums small and the central moments accurate far from (0, 0).
+ */
+struct RunSums
+{
+    RunSums()
+        : area_(0), sx_(0), sy_(0), sxx_(0), sxy_(0), syy_(0),
+          runs_(0), overlap_(0), adj4_(0), adj8_(0)
+    {}
+
+    //! Adds the Rbo of length @a n starting at the relative point (@a x, @a y).
+    void addRun(N64 x, N64 y, N64 n) {
+        // sum of x and x^2 for x in [x, x + n)
+        N64 const s1 = n * x + n * (n - 1) / 2,
+            s2 = n * x * x + x * n * (n - 1) + (n - 1) * n * (2 * n - 1) / 6;
+        area_ += n;
+        sx_ += s1;
+        sy_ += n * y;
+        sxx_ += s2;
+        sxy_ += y * s1;
+        syy_ += n * y * y;
+        ++runs_;
+    }
+
+    //! Adds the contacts of the rows [@a p, @a pend) and [@a c, @a cend).
+    /*! The rows must be adjacent. Every pair of Rbo's which overlaps or
+     * touches diagonally is visited once.
+     */
+    void addRows(Region::RboIterator p, Region::RboIterator pend,
+                 Region::RboIterator c, Region::RboIterator cend) {
+        while (p != pend && c != cend) {
+            N32 const pe = p->start().x_ + p->len() - 1,
+                ce = c->start().x_ + c->len() - 1,
+                common = min(pe, ce) - max<N32>(p->start().x_, c->start().x_) + 1;
+            if (common > 0) {
+                overlap_ += common;
+                ++adj4_;
+            }
+            if (common >= 0)
+                ++adj8_;
+            if (pe < ce)
+                ++p;
+            else
+                ++c;
+        }
+    }
+
+    //! The moments, the sums are relative to (@a ox, @a oy).
+    Region::Moments const moments(N32 ox, N32 oy) const {
+        F64 const a = area_,
+            cx = sx_ / a,
+            cy = sy_ / a;
+        Region::Moments mom;
+        mom.area_ = area_;
+        mom.center_ = PointF64(ox + cx, oy + cy);
+        mom.m20_ = sxx_ / a - cx * cx;
+        mom.m11_ = sxy_ / a - cx * cy;
+        mom.m02_ = syy_ / a - cy * cy;
+        return mom;
+    }
+
+    //! the number of pixels
+    N64 area_;
+    //! sum of x
+    N64 sx_;
+    //! sum of y
+    N64 sy_;
+    //! sum of x^2
+    N64 sxx_;
+    //! sum of x*y
+    N64 sxy_;
+    //! sum of y^2
+    N64 syy_;
+    //! the number of Rbo's
+    N64 runs_;
+    //! the number of pixels with a pixel below
+    N64 overlap_;
+    //! the number of 4-connected pairs of Rbo's
+    N64 adj4_;
+    //! the number of 8-connected pairs of Rbo's
+    N64 adj8_;
+};
+
+//! Sums over the Rbo's of a component, relative to its first Rbo.
+struct BlobSums : public RunSums
+{
+    BlobSums()
+        : ox_(0), oy_(0), minX_(0), maxX_(0), maxY_(0)
+    {}
+
+    //! Adds the Rbo @a r.
+    void add(Rbo const & r) {
+        N32 const x = r.start().x_,
+            y = r.start().y_;
+        if (runs_ == 0) {
+            ox_ = x;
+            oy_ = y;
+            minX_ = x;
+            maxX_ = x;
+        }
+        this->addRun(x - ox_, y - oy_, r.len());
+        minX_ = min(minX_, x);
+        maxX_ = max(maxX_, x + r.len() - 1);
+        maxY_ = y;
+    }
+
+    //! the start of the first Rbo, also the top row
+    N32 ox_, oy_;
+    //! the bounding box without the top row
+    N32 minX_, maxX_, maxY_;
+};
+
+//! Checks and converts the connectivity 4 or 8 of a caller @a fnc.
+Blobs::Connectivity
+connectivityOf(N32 connectivity, char const * fnc)
+{
+    if (connectivity != 4 && connectivity != 8)
+        throw ParameterError(1, string(fnc) + ": connectivity must be 4 or 8");
+    return static_cast<Blobs::Connectivity>(connectivity);
+}
+
+//! Labels the components of @a reg and sums over the Rbo's of each one.
+vector<BlobSums>
+sumBlobs(Region const & reg, vector<N32> & labels, Blobs::Connectivity conn)
+{
+    vector<BlobSums> sums(Blobs::labelRuns(reg, labels, conn));
+    vector<N32>::const_iterator l = labels.begin();
+    for (Region::RboIterator r = reg.begin(); r != reg.end(); ++r, ++l)
+        sums[*l].add(*r);
+    return sums;
+}
+
+//! The Rbo's of @a reg whose component is marked in @a keep.
+Region
+selectBlobs(Region const & reg, vector<N32> const & labels, vector<bool> const & keep)
+{
+    Region res;
+    vector<N32>::const_iterator l = labels.begin();
+    for (Region::RboIterator r = reg.begin(); r != reg.end(); ++r, ++l)
+        if (keep[*l])
+            res.add(*r);
+    return res;
+}
+
+//! The @a feature of the component summed up in @a s.
+F64
+featureOf(BlobSums const & s, Region::ShapeFeature feature)
+{
+    switch (feature) {
+    case Region::ShapeFeatureArea:
+        return s.area_;
+    case Region::ShapeFeatureWidth:
+        return s.maxX_ - s.minX_ + 1;
+    case Region::ShapeFeatureHeight:
+        return s.maxY_ - s.oy_ + 1;
+    case Region::ShapeFeatureElongation: {
+        Region::Moments const mom = s.moments(s.ox_, s.oy_);
+        F64 const ra = mom.majorRadius();
+        return ra > 0 ? 1 - mom.minorRadius() / ra : 0;
+    }
+    }
+    throw ParameterError(2, IPL_FNC_NAME);
+}
+
+IPL_ANON_NS_END
+
+F64
+Region::Moments::orientation() const
+{
+    return 0.5 * atan2(2 * m11_, m20_ - m02_);
+}
+
+F64
+Region::Moments::majorRadius() const
+{
+    F64 const d = sqrt((m20_ - m02_) * (m20_ - m02_) + 4 * m11_ * m11_);
+    return sqrt(2 * (m20_ + m02_ + d));
+}
+
+F64
+Region::Moments::minorRadius() const
+{
+    F64 const d = sqrt((m20_ - m02_) * (m20_ - m02_) + 4 * m11_ * m11_);
+    return sqrt(max(0.0, 2 * (m20_ + m02_ - d)));
+}
+
+/*! @internal The perimeter follows from the sums: each Rbo has two vertical
+ * edges, and each pixel a top and a bottom edge unless it touches a pixel
+ * above or below. The Rbo's and their contacts form a graph whose cycles
+ * are the holes, so the Euler number is the number of Rbo's minus the
+ * number of contacts.
+ */
+void
+Region::computeFeatures(Moments * mom, N32 * euler4, N32 * euler8) const
+{
+    IPLLOG_INFO(IPL_FNC_NAME << " for " << *this);
+    IPL_ASSERT_VALID(*this);
+    RunSums s;
+    if (!this->empty()) {
+        N32 const ox = this->begin()->start().x_,
+            oy = this->begin()->start().y_;
+        RboIterator prev = this->end(), prevEnd = this->end();
+        for (RboIterator r = this->begin(); r != this->end(); ) {
+            N32 const y = r->start().y_;
+            RboIterator const row = r;
+            for ( ; r != this->end() && r->start().y_ == y; ++r)
+                s.addRun(r->start().x_ - ox, y - oy, r->len());
+            if (prev != this->end() && prev->start().y_ + 1 == y)
+                s.addRows(prev, prevEnd, row, r);
+            prev = row;
+            prevEnd = r;
+        }
+
+        Moments const m = s.moments(ox, oy);
+        center_.update(m.center_);
+        if (mom)
+            *mom = m;
+    }
+    area_.update(s.area_);
+    perimeter_.update(2 * (s.runs_ + s.area_ - s.overlap_));
+    if (euler4)
+        *euler4 = s.runs_ - s.adj4_;
+    if (euler8)
+        *euler8 = s.runs_ - s.adj8_;
+}
+
+N32
+Region::area() const
+{
+    if (!area_.upToDate())
+        this->computeFeatures();
+    return area_.get();
+}
+
+PointF64 const &
+Region::center() const
+{
+    if (this->empty())
+        throw EmptyRegionError(string(IPL_FNC_NAME) + ": empty region");
+    if (!center_.upToDate())
+        this->computeFeatures();
+    return center_.get();
+}
+
+N32
+Region::areaCenter(PointF64 & center) const
+{
+    center = this->center();
+    return this->area();
+}
+
+Region::Moments const
+Region::moments() const
+{
+    if (this->empty())
+        throw EmptyRegionError(string(IPL_FNC_NAME) + ": empty region");
+    Moments mom;
+    this->computeFeatures(&mom);
+    return mom;
+}
+
+F64
+Region::perimeter() const
+{
+    if (!perimeter_.upToDate())
+        this->computeFeatures();
+    return perimeter_.get();
+}
+
+N32
+Region::eulerNumber(N32 connectivity) const
+{
+    connectivityOf(connectivity, IPL_FNC_NAME);
+    N32 euler4 = 0, euler8 = 0;
+    this->computeFeatures(0, &euler4, &euler8);
+    return connectivity == 4 ? euler4 : euler8;
+}
+
+F64
+Region::shapeFeature(ShapeFeature feature) const
+{
+    if (feature < ShapeFeatureArea || feature > ShapeFeatureElongation)
+        throw ParameterError(1, IPL_FNC_NAME);
+    if (this->empty())
+        throw EmptyRegionError(string(IPL_FNC_NAME) + ": empty region");
+    BlobSums sums;
+    for (RboIterator r = this->begin(); r != this->end(); ++r)
+        sums.add(*r);
+    return featureOf(sums, feature);
+}
+
+Region const
+Region::selectShape(ShapeFeature feature, F64 min, F64 max, N32 connectivity) const
+{
+    IPLLOG_INFO(IPL_FNC_NAME << " " << feature << " in " << PointF64(min, max)
+                << " of " << *this);
+    Blobs::Connectivity const conn = connectivityOf(connectivity, IPL_FNC_NAME);
+    if (feature < ShapeFeatureArea || feature > ShapeFeatureElongation)
+        throw ParameterError(1, IPL_FNC_NAME);
+    vector<N32> labels;
+    vector<BlobSums> const sums = sumBlobs(*this, labels, conn);
+    vector<bool> keep(sums.size());
+    for (size_t i = 0; i < sums.size(); ++i) {
+        F64 const f = featureOf(sums[i], feature);
+        keep[i] = f >= min && f <= max;
+    }
+    Region const res = selectBlobs(*this, labels, keep);
+    IPL_ASSERT_VALID(res);
+    return res;
+}
+
+Region const
+Region::areaOpen(N32 minArea, N32 connectivity) const
+{
+    return this->selectShape(ShapeFeatureArea, minArea,
+                             numeric_limits<F64>::max(), connectivity);
+}
+
+/*! @internal The complement is taken in the bounding box grown by one
+ * pixel, so all of the outside is one component touching the border.
+ */
+Region const
+Region::areaClose(N32 minArea, N32 connectivity) const
+{
+    IPLLOG_INFO(IPL_FNC_NAME << " " << minArea << " of " << *this);
+    Blobs::Connectivity const conn = connectivityOf(connectivity, IPL_FNC_NAME);
+    if (this->empty())
+        return *this;
+    WinP const & bb = this->boundingBox();
+    WinP const universe(bb.upperLeft().x_ - 1, bb.upperLeft().y_ - 1,
+                        bb.lowerRight().x_ + 1, bb.lowerRight().y_ + 1);
+    Region const background = this->complement(&universe);
+    vector<N32> labels;
+    vector<BlobSums> const sums =
+        sumBlobs(background, labels,
+                 conn == Blobs::Connect8 ? Blobs::Connect4 : Blobs::Connect8);
+    vector<bool> keep(sums.size());
+    for (size_t i = 0; i < sums.size(); ++i)
+        keep[i] = sums[i].area_ < minArea
+            && sums[i].oy_ > universe.upperLeft().y_
+            && sums[i].maxY_ < universe.lowerRight().y_
+            && sums[i].minX_ > universe.upperLeft().x_
+            && sums[i].maxX_ < universe.lowerRight().x_;
+    return this->unions(selectBlobs(background, labels, keep));
+}
+
+IPL_NS_END
@@ -0,0 +1,565 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Thresholding of image files into Regions
+ *
+ ********************************************************************/
+
+#include "ipl/region.hh"
+
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+#if defined(IPL_HAVE_PNG)
+#    include <png.h>
+#endif
+#if defined(IPL_HAVE_TIFF)
+#    include <tiffio.h>
+#endif
+
+#include "ipl/iplerr.hh"
+#include "ipl/mathli.hh"
+
+using namespace std;
+
+IPL_NS_BEGIN
+
+IPL_ANON_NS_BEGIN
+
+//! Check the size @a w x @a h of the image @a fn.
+/*! The coordinates of a Region are N16.
+ */
+void
+checkSize(string const & fn, N32 w, N32 h)
+{
+    N32 const maxSize = numeric_limits<N16>::max() + 1;
+    if (w > maxSize || h > maxSize) {
+        ostringstream os;
+        os << fn << ": image of " << w << "x" << h << " is too large for a Region";
+        throw IoError(os.str());
+    }
+}
+
+//! Gray value of a RGB pixel.
+/*! The weights are the same as in PictImg::PictImg(std::string const &).
+ */
+template<typename T>
+inline T
+gray(N32 r, N32 g, N32 b)
+{
+    return static_cast<T>(mathli::roundF(0.299 * r + 0.587 * g + 0.114 * b));
+}
+
+//! The formats of Region::fromFile.
+enum Format {
+    PngFormat,
+    TiffFormat,
+    UnknownFormat
+};
+
+//! Detect the format of @a fn by its magic number.
+Format
+detectFormat(string const & fn)
+{
+    ifstream is(fn.c_str(), ios::binary);
+    if (!is)
+        throw IoError("can't open " + fn);
+    char sig[8] = { 0 };
+    is.read(sig, sizeof(sig));
+    if (is.gcount() == 8 && memcmp(sig, "\x89PNG\r\n\x1a\n", 8) == 0)
+        return PngFormat;
+    if (is.gcount() >= 4 && (memcmp(sig, "II*\0", 4) == 0
+                             || memcmp(sig, "MM\0*", 4) == 0))
+        return TiffFormat;
+    return UnknownFormat;
+}
+
+#if defined(IPL_HAVE_PNG)
+
+//! Error handler of libpng.
+/*! Keeps the message and jumps back to the setjmp of the PngReader. Only
+ * libpng's own stack frames are skipped.
+ */
+void
+pngError(png_structp png, png_const_charp msg)
+{
+    char * err = static_cast<char *>(png_get_error_ptr(png));
+    strncpy(err, msg, 255);
+    err[255] = 0;
+    png_longjmp(png, 1);
+}
+
+//! Warning handler of libpng: ignore.
+void
+pngWarning(png_structp, png_const_charp)
+{
+}
+
+//! Decoder of a PNG file by rows.
+/*! All the transformations are done by libpng except the conversion of RGB
+ * to gray, which is done by gray().
+ */
+class PngReader
+{
+public:
+    //! ctr, reads the header of @a fn
+    explicit PngReader(string const & fn)
+        : fn_(fn), file_(fopen(fn.c_str(), "rb")), png_(0), info_(0) {
+        err_[0] = 0;
+        if (!file_)
+            throw IoError("can't open " + fn);
+        png_ = png_create_read_struct(PNG_LIBPNG_VER_STRING, err_,
+                                      pngError, pngWarning);
+        if (png_)
+            info_ = png_create_info_struct(png_);
+        if (!png_ || !info_) {
+            destroy();
+            throw IoError(fn + ": can't create png decoder");
+        }
+        if (!readHeader()) {
+            destroy();
+            throw IoError(fn + ": " + err_);
+        }
+    }
+    //! dtr
+    ~PngReader() {
+        destroy();
+    }
+    N32 width() const {
+        return width_;
+    }
+    N32 height() const {
+        return height_;
+    }
+    //! 8 or 16
+    N32 bitDepth() const {
+        return bitDepth_;
+    }
+    bool interlaced() const {
+        return interlaced_;
+    }
+    //! Pass the gray values of each row @a y to @a sink(row, y).
+    template<typename T, typename Sink>
+    void rows(Sink sink) {
+        vector<T> gray;
+        if (!interlaced_) {
+            vector<T> raw(width_ * channels_);
+            for (N32 y = 0; y < height_; ++y) {
+                check(readRow(reinterpret_cast<png_bytep>(&raw[0])));
+                sink(toGray(&raw[0], gray), y);
+            }
+        } else {
+            vector<T> image(N64(width_) * channels_ * height_);
+            vector<png_bytep> rows(height_);
+            for (N32 y = 0; y < height_; ++y)
+                rows[y] = reinterpret_cast<png_bytep>(&image[N64(width_) * channels_ * y]);
+            check(readImage(&rows[0]));
+            for (N32 y = 0; y < height_; ++y)
+                sink(toGray(&image[N64(width_) * channels_ * y], gray), y);
+        }
+    }
+private:
+    //! Setup of the transformations.
+    bool readHeader() {
+        if (setjmp(png_jmpbuf(png_)))
+            return false;
+        png_init_io(png_, file_);
+        png_read_info(png_, info_);
+        N32 const colorType = png_get_color_type(png_, info_);
+        if (colorType == PNG_COLOR_TYPE_PALETTE)
+            png_set_palette_to_rgb(png_);
+        if (colorType == PNG_COLOR_TYPE_GRAY && png_get_bit_depth(png_, info_) < 8)
+            png_set_expand_gray_1_2_4_to_8(png_);
+        if (colorType & PNG_COLOR_MASK_ALPHA)
+            png_set_strip_alpha(png_);
+#if defined(IPL_LITTLE_ENDIAN)
+        if (png_get_bit_depth(png_, info_) == 16)
+            png_set_swap(png_);
+#endif
+        interlaced_ = png_set_interlace_handling(png_) > 1;
+        png_read_update_info(png_, info_);
+        width_ = png_get_image_width(png_, info_);
+        height_ = png_get_image_height(png_, info_);
+        bitDepth_ = png_get_bit_depth(png_, info_);
+        channels_ = png_get_channels(png_, info_);
+        return true;
+    }
+    bool readRow(png_bytep row) {
+        if (setjmp(png_jmpbuf(png_)))
+            return false;
+        png_read_row(png_, row, 0);
+        return true;
+    }
+    bool readImage(png_bytepp rows) {
+        if (setjmp(png_jmpbuf(png_)))
+            return false;
+        png_read_image(png_, rows);
+        return true;
+    }
+    void check(bool ok) const {
+        if (!ok)
+            throw IoError(fn_ + ": " + err_);
+    }
+    //! Gray values of the @a row with @a channels_ samples per pixel.
+    template<typename T>
+    T const * toGray(T const * row, vector<T> & buf) const {
+        if (channels_ == 1)
+            return row;
+        buf.resize(width_);
+        for (N32 x = 0; x < width_; ++x, row += channels_)
+            buf[x] = channels_ < 3 ? row[0] : gray<T>(row[0], row[1], row[2]);
+        return &buf[0];
+    }
+    void destroy() {
+        if (png_)
+            png_destroy_read_struct(&png_, info_ ? &info_ : 0, 0);
+        png_ = 0;
+        info_ = 0;
+        if (file_)
+            fclose(file_);
+        file_ = 0;
+    }
+
+    string const fn_;
+    FILE * file_;
+    png_structp png_;
+    png_infop info_;
+    char err_[256];
+    N32 width_;
+    N32 height_;
+    N32 bitDepth_;
+    N32 channels_;
+    bool interlaced_;
+};
+
+#endif // IPL_HAVE_PNG
+
+#if defined(IPL_HAVE_TIFF)
+
+//! Decoder of a TIFF file by rows.
+/*! Stripped images are read by scanlines, tiled images by rows of tiles.
+ * Supported are 1, 2, 4, 8 and 16 bits per sample with the photometric
+ * interpretations gray, palette and RGB in contiguous planar configuration.
+ */
+class TiffReader
+{
+public:
+    //! ctr, reads the header of @a fn
+    explicit TiffReader(string const & fn)
+        : fn_(fn), tif_(0), tileWidth_(0), tileHeight_(0),
+          bits_(1), spp_(1), photometric_(PHOTOMETRIC_MINISBLACK),
+          compression_(COMPRESSION_NONE), runCoded_(false),
+          red_(0), green_(0), blue_(0) {
+        //shut up warnings about unknown tags
+        TIFFSetWarningHandler(0);
+        tif_ = TIFFOpen(fn.c_str(), "r");
+        if (!tif_)
+            throw IoError("can't open " + fn);
+        try {
+            readHeader();
+        } catch (...) {
+            TIFFClose(tif_);
+            throw;
+        }
+    }
+    //! dtr
+    ~TiffReader() {
+        TIFFClose(tif_);
+    }
+    N32 width() const {
+        return width_;
+    }
+    N32 height() const {
+        return height_;
+    }
+    //! 16 if the gray values have 16 bits, else 8.
+    N32 bitDepth() const {
+        return bits_ == 16 && photometric_ != PHOTOMETRIC_PALETTE ? 16 : 8;
+    }
+    //! Bilevel strips with G4 or PackBits, which Region decodes itself.
+    bool runCoded() const {
+        return runCoded_;
+    }
+    bool g4() const {
+        return compression_ == COMPRESSION_CCITTFAX4;
+    }
+    //! Grayvalue of the 1 bits of a bilevel image.
+    N32 oneValue() const {
+        return photometric_ == PHOTOMETRIC_MINISWHITE ? 0 : 255;
+    }
+    //! Pass the raw strips to @a sink(first, last, y0, nrRows).
+    template<typename Sink>
+    void strips(Sink sink) {
+        UN32 rowsPerStrip = height_;
+        UN16 fillOrder = FILLORDER_MSB2LSB;
+        TIFFGetFieldDefaulted(tif_, TIFFTAG_ROWSPERSTRIP, &rowsPerStrip);
+        TIFFGetFieldDefaulted(tif_, TIFFTAG_FILLORDER, &fillOrder);
+        vector<UN8> code;
+        for (N32 s = 0, y0 = 0; y0 < height_; ++s, y0 += rowsPerStrip) {
+            N64 const size = TIFFRawStripSize(tif_, s);
+            if (size < 0)
+                throw IoError(fn_ + ": invalid strip");
+            code.resize(size + 1);
+            if (TIFFReadRawStrip(tif_, s, &code[0], size) < 0)
+                throw IoError(fn_ + ": can't read strip");
+            if (fillOrder == FILLORDER_LSB2MSB)
+                TIFFReverseBits(&code[0], size);
+            sink(&code[0], &code[0] + size, y0,
+                 min<N32>(rowsPerStrip, height_ - y0));
+        }
+    }
+    //! Pass the gray values of each row @a y to @a sink(row, y).
+    template<typename T, typename Sink>
+    void rows(Sink sink) {
+        vector<T> gray(width_);
+        if (!TIFFIsTiled(tif_)) {
+            vector<UN8> raw(TIFFScanlineSize(tif_));
+            for (N32 y = 0; y < height_; ++y) {
+                if (TIFFReadScanline(tif_, &raw[0], y, 0) < 0)
+                    throw IoError(fn_ + ": can't read scanline");
+                sink(toGray(&raw[0], gray), y);
+            }
+            return;
+        }
+        N32 const across = (width_ + tileWidth_ - 1) / tileWidth_;
+        N64 const tileSize = TIFFTileSize(tif_),
+            tileRowSize = TIFFTileRowSize(tif_);
+        vector<UN8> tiles(tileSize * across), raw(tileRowSize * across);
+        for (N32 ty = 0; ty < height_; ty += tileHeight_) {
+            for (N32 k = 0; k < across; ++k)
+                if (TIFFReadTile(tif_, &tiles[tileSize * k], k * tileWidth_, ty, 0, 0) < 0)
+                    throw IoError(fn_ + ": can't read tile");
+            for (N32 y = ty; y < min(ty + tileHeight_, height_); ++y) {
+                for (N32 k = 0; k < across; ++k)
+                    memcpy(&raw[tileRowSize * k],
+                           &tiles[tileSize * k + tileRowSize * (y - ty)],
+                           tileRowSize);
+                sink(toGray(&raw[0], gray), y);
+            }
+        }
+    }
+private:
+    void readHeader() {
+        UN32 w = 0, h = 0;
+        UN16 bits = 1, spp = 1, planar = PLANARCONFIG_CONTIG;
+        if (!TIFFGetField(tif_, TIFFTAG_IMAGEWIDTH, &w)
+            || !TIFFGetField(tif_, TIFFTAG_IMAGELENGTH, &h))
+            throw IoError(fn_ + ": no image size");
+        TIFFGetFieldDefaulted(tif_, TIFFTAG_BITSPERSAMPLE, &bits);
+        TIFFGetFieldDefaulted(tif_, TIFFTAG_SAMPLESPERPIXEL, &spp);
+        TIFFGetFieldDefaulted(tif_, TIFFTAG_PLANARCONFIG, &planar);
+        UN16 photometric = spp < 3 ? PHOTOMETRIC_MINISBLACK : PHOTOMETRIC_RGB;
+        TIFFGetField(tif_, TIFFTAG_PHOTOMETRIC, &photometric);
+        width_ = w;
+        height_ = h;
+        bits_ = bits;
+        spp_ = spp;
+        photometric_ = photometric;
+        if (TIFFIsTiled(tif_)) {
+            UN32 tw = 0, th = 0;
+            TIFFGetField(tif_, TIFFTAG_TILEWIDTH, &tw);
+            TIFFGetField(tif_, TIFFTAG_TILELENGTH, &th);
+            tileWidth_ = tw;
+            tileHeight_ = th;
+            if (tileWidth_ <= 0 || tileHeight_ <= 0)
+                throw IoError(fn_ + ": invalid tile size");
+        }
+        if ((bits_ != 1 && bits_ != 2 && bits_ != 4 && bits_ != 8 && bits_ != 16)
+            || (spp_ > 1 && planar != PLANARCONFIG_CONTIG)
+            || (photometric_ != PHOTOMETRIC_MINISBLACK
+                && photometric_ != PHOTOMETRIC_MINISWHITE
+                && photometric_ != PHOTOMETRIC_PALETTE
+                && photometric_ != PHOTOMETRIC_RGB)
+            || (photometric_ == PHOTOMETRIC_RGB && spp_ < 3)) {
+            ostringstream os;
+            os << fn_ << ": unsupported tiff with " << bits_ << " bits, "
+               << spp_ << " samples, planar config " << planar
+               << " and photometric " << photometric_;
+            throw IoError(os.str());
+        }
+        UN16 compression = COMPRESSION_NONE;
+        UN32 t6Options = 0;
+        TIFFGetFieldDefaulted(tif_, TIFFTAG_COMPRESSION, &compression);
+        compression_ = compression;
+        if (compression_ == COMPRESSION_CCITTFAX4)
+            TIFFGetField(tif_, TIFFTAG_GROUP4OPTIONS, &t6Options);
+        runCoded_ = bits_ == 1 && spp_ == 1 && !TIFFIsTiled(tif_)
+            && (photometric_ == PHOTOMETRIC_MINISWHITE
+                || photometric_ == PHOTOMETRIC_MINISBLACK)
+            && ((compression_ == COMPRESSION_CCITTFAX4
+                 && !(t6Options & GROUP4OPT_UNCOMPRESSED))
+                || compression_ == COMPRESSION_PACKBITS);
+        if (photometric_ == PHOTOMETRIC_PALETTE
+            && (bits_ == 16
+                || !TIFFGetField(tif_, TIFFTAG_COLORMAP, &red_, &green_, &blue_)))
+            throw IoError(fn_ + ": invalid palette");
+    }
+    //! The sample @a i of the @a row.
+    N32 sample(UN8 const * row, N32 i) const {
+        switch (bits_) {
+        case 8:
+            return row[i];
+        case 16:
+            return reinterpret_cast<UN16 const *>(row)[i];
+        default:
+            N32 const bit = i * bits_;
+            return (row[bit / 8] >> (8 - bits_ - bit % 8)) & ((1 << bits_) - 1);
+        }
+    }
+    //! The sample @a i of the @a row scaled to 8 resp. 16 bits.
+    N32 value(UN8 const * row, N32 i) const {
+        N32 const maxValue = (1 << bits_) - 1;
+        N32 v = sample(row, i);
+        if (photometric_ == PHOTOMETRIC_MINISWHITE)
+            v = maxValue - v;
+        return bits_ < 8 ? v * 255 / maxValue : v;
+    }
+    //! Gray values of the @a row.
+    template<typename T>
+    T const * toGray(UN8 const * row, vector<T> & buf) const {
+        if (spp_ == 1 && bits_ == 8 * sizeof(T)
+            && photometric_ == PHOTOMETRIC_MINISBLACK)
+            return reinterpret_cast<T const *>(row);
+        for (N32 x = 0; x < width_; ++x) {
+            if (photometric_ == PHOTOMETRIC_PALETTE) {
+                N32 const i = sample(row, x * spp_);
+                buf[x] = gray<T>(red_[i] >> 8, green_[i] >> 8, blue_[i] >> 8);
+            } else if (spp_ >= 3) {
+                buf[x] = gray<T>(value(row, x * spp_), value(row, x * spp_ + 1),
+                                 value(row, x * spp_ + 2));
+            } else {
+                buf[x] = value(row, x * spp_);
+            }
+        }
+        return &buf[0];
+    }
+
+    string const fn_;
+    TIFF * tif_;
+    N32 width_;
+    N32 height_;
+    N32 tileWidth_;
+    N32 tileHeight_;
+    N32 bits_;
+    N32 spp_;
+    N32 photometric_;
+    N32 compression_;
+    bool runCoded_;
+    UN16 * red_;
+    UN16 * green_;
+    UN16 * blue_;
+};
+
+#endif // IPL_HAVE_TIFF
+
+IPL_ANON_NS_END
+
+/*! @internal Each decoded row is passed directly to Region::binarizeRow.
+ */
+Region const
+Region::fromFile(string const & fn, N32 lo, N32 hi)
+{
+    IPLLOG_INFO(IPL_FNC_NAME << ": " << fn << " with [" << lo << ", " << hi << "]");
+    Region res;
+    if (lo > hi) {
+        IPLLOG_WARN(IPL_FNC_NAME << " empty binarization range " << PointN16(lo,hi));
+        return res;
+    }
+    switch (detectFormat(fn)) {
+    case PngFormat:
+        readPng(fn, lo, hi, res);
+        break;
+    case TiffFormat:
+        readTiff(fn, lo, hi, res);
+        break;
+    default:
+        throw IoError(fn + ": unknown image format");
+    }
+    IPLLOG_INFO(IPL_FNC_NAME << ": -> " << res);
+    IPL_ASSERT_VALID(res);
+    return res;
+}
+
+void
+Region::readPng(string const & fn, N32 lo, N32 hi, Region & res)
+{
+#if defined(IPL_HAVE_PNG)
+    PngReader png(fn);
+    N32 const w = png.width();
+    checkSize(fn, w, png.height());
+    if (png.interlaced()) {
+        IPLLOG_WARN(fn << " is interlaced, it is decoded as a whole");
+    }
+    if (png.bitDepth() == 16) {
+        png.rows<UN16>([&](UN16 const * p, N32 y) {
+                binarizeRow(p, p + w, lo, hi, PointN16(0, y), res);
+            });
+    } else {
+        png.rows<UN8>([&](UN8 const * p, N32 y) {
+                binarizeRow(p, p + w, lo, hi, PointN16(0, y), res);
+            });
+    }
+#else
+    (void)lo;
+    (void)hi;
+    (void)res;
+    throw IoError(fn + ": library built without png support");
+#endif
+}
+
+void
+Region::readTiff(string const & fn, N32 lo, N32 hi, Region & res)
+{
+#if defined(IPL_HAVE_TIFF)
+    TiffReader tif(fn);
+    N32 const w = tif.width();
+    checkSize(fn, w, tif.height());
+    if (tif.runCoded()) {
+        // the runs of 1 bits are decoded, the threshold selects them or
+        // their complement
+        N32 const one = tif.oneValue(),
+            zero = 255 - one;
+        bool const in1 = lo <= one && one <= hi,
+            in0 = lo <= zero && zero <= hi;
+        WinP const frame(0, 0, w - 1, tif.height() - 1);
+        if (in0 && in1) {
+            res = Region(frame);
+        } else if (in0 || in1) {
+            tif.strips([&](UN8 const * first, UN8 const * last, N32 y0, N32 rows) {
+                    if (tif.g4())
+                        decodeG4(first, last, w, y0, rows, res);
+                    else
+                        decodePackBits(first, last, w, y0, rows, res);
+                });
+            if (in0)
+                res = res.complement(&frame);
+        }
+        return;
+    }
+    if (tif.bitDepth() == 16) {
+        tif.rows<UN16>([&](UN16 const * p, N32 y) {
+                binarizeRow(p, p + w, lo, hi, PointN16(0, y), res);
+            });
+    } else {
+        tif.rows<UN8>([&](UN8 const * p, N32 y) {
+                binarizeRow(p, p + w, lo, hi, PointN16(0, y), res);
+            });
+    }
+#else
+    (void)lo;
+    (void)hi;
+    (void)res;
+    throw IoError(fn + ": library built without tiff support");
+#endif
+}
+
+IPL_NS_END
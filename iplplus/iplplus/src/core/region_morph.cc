@@ -20,8 +20,12 @@
 #include <algorithm>
 #include <iostream>
 #include "ipl/timer.hh"
+#include "ipl/iplerr.hh"
+#include "ipl/mathli.hh"
 #include <ios>
 #include <string>
+#include <vector>
+#include <boost/scoped_ptr.hpp>
 
 using namespace std;
 
@@ -113,6 +117,54 @@ Region const Region::generateStructuringElement(StructuringElement choice, int s
 }
 
 
+/**
+ * Generates line-shaped structuring elements of several orientations.
+ * Every line is rasterized along its major axis from (-dx, -dy) to (dx, dy), the points of
+ * one row are consecutive and form a run.
+ *
+ * @param size the half length of the lines
+ * @param nrOrientations the number of lines
+ * @return the lines, in ascending order of their angles
+ */
+vector<Region> const Region::generateLineBank(int size, int nrOrientations) {
+	if (size <= 0) {
+		throw ParameterError(1, IPL_FNC_NAME);
+	}
+	if (nrOrientations <= 0) {
+		throw ParameterError(2, IPL_FNC_NAME);
+	}
+
+	vector<Region> lines;
+	for (int i = 0; i < nrOrientations; ++i) {
+		F64 const angle = mathli::Pi * i / nrOrientations;
+		int const dx = mathli::roundF(size * mathli::cos(angle)),
+			dy = mathli::roundF(size * mathli::sin(angle)),
+			n = max(abs(dx), abs(dy));
+		vector<Point<N16> > points;
+		for (int t = -n; t <= n; ++t) {
+			points.push_back(Point<N16>(mathli::roundF(F64(t) * dx / n), mathli::roundF(F64(t) * dy / n)));
+		}
+		sort(points.begin(), points.end(), [](Point<N16> const & a, Point<N16> const & b) {
+			return a.y_ < b.y_ || (a.y_ == b.y_ && a.x_ < b.x_);
+		});
+		points.erase(unique(points.begin(), points.end()), points.end());
+
+		Region B;
+		for (size_t k = 0; k < points.size(); ) { // runs of consecutive points in a row
+			size_t e = k + 1;
+			while (e < points.size() && points[e].y_ == points[k].y_ && points[e].x_ == points[e-1].x_ + 1) {
+				++e;
+			}
+			B.add(Rbo(points[k], e - k));
+			k = e;
+		}
+		lines.push_back(B);
+	}
+
+	return lines;
+}
+
+
 /**
  * determines the points of the skeleton of B including their erosion-transform values and
  * the length of the shortest run within B.
@@ -253,51 +305,352 @@ Region::RetGenerateErosionTransformX const Region::generateErosionTransformX2(Re
 
 
 /**
- * constructs X_{L_min} (drops all runs that are shorter than lmin) and generates the erosion transform of X_{L_min} where X
- * is the given region.
- * @param B structuring element (needed, to determine the size of the erosion-transform-array)
- * @param lmin length of shortest run within B
- * @param lmax length of longest run within B
- * @return X_{cut}, the erosion transform of X_{L_min} with A and A^t, the value by which X_{L_min} got translated
+ * the jump-miss/jump-hit scan of erode2cut.
+ * The erosion transform of X_{L_min} with A and A^t is stored in rows of the same width
+ * as the array of erode2cut, but a row of it is only allocated and computed when a scanned
+ * run of X_{cut} needs it. Therefore scanning a few rows of X costs only those rows of the
+ * erosion transform.
+ * A bank of structuring elements shares the array and the traversal of X, only the
+ * jump-miss/jump-hit tests are done per structuring element.
  */
-Region::RetGenerateErosionTransformX const Region::generateErosionTransformX2cut(Region B, N16 lmin, N16 lmax) const {
+struct Region::Erode2cutScan {
+	/**
+	 * the skeleton of one structuring element B
+	 */
+	struct Kernel {
+		explicit Kernel(Region const & B);
 
-	N16 j, j2, ycoord;
-	RetGenerateErosionTransformX erosionTransformX;
-	Point<N16> tr;
+		N16 lmin; /**< length of shortest run within B */
+		N16 lmax; /**< length of longest run within B */
+		Point<N16> origTranslate; /**< B got translated by this value */
+		Point<N16> extent; /**< width and height of the bounding box of B */
+		vector<erosTransPoint> skeletonB; /**< skeleton of B plus their erosion-transform-values */
+		vector<N16> skeletonRows; /**< the distinct rows of the skeleton of B */
+	};
+
+	Erode2cutScan(Region const & X, Region const & B);
+	Erode2cutScan(Region const & X, vector<Region> const & Bs);
+
+	static Point<N16> maxExtent(vector<Kernel> const & kernels);
+
+	void init();
+
+	void prepareRow(N16 ycoord);
+
+	template<typename Hit>
+	bool scanRun(Kernel const & k, Rbo const & r, Hit hit);
+
+	template<typename Hit>
+	bool scan(RboIterator first, RboIterator last, Hit hit);
+
+	template<typename Hit>
+	bool scanRow(N32 y, Hit hit);
+
+	template<typename Hit>
+	bool scanPart(size_t i, Rbo const & r, Hit hit);
+
+	template<typename BankHit>
+	void scanBank(RboIterator first, RboIterator last, BankHit hit);
+
+	Region const & X; /**< the region to be eroded; must outlive the scan */
+	vector<Kernel> kernels; /**< the structuring elements, one for erode2cut */
+	N16 lmin; /**< length of shortest run within all structuring elements */
+	Point<N16> translation; /**< X got translated by this value within the erosion-transform-array */
+	N32 rowWidth; /**< width of a row of the erosion-transform-array */
+	vector<vector<N16> > erosTransXlmin; /**< rows of erosion-transform-values of X_{L_min} with A and A^t interleaved, empty until computed */
+};
+
+
+IPL_ANON_NS_BEGIN
+
+/**
+ * compares the row of a run with a row
+ */
+struct RowCompare {
+	bool operator()(Rbo const & r, N32 y) const {
+		return r.start().y_ < y;
+	}
+	bool operator()(N32 y, Rbo const & r) const {
+		return y < r.start().y_;
+	}
+};
+
+/**
+ * @return the runs of reg in row y
+ */
+pair<Region::RboIterator, Region::RboIterator> rowRange(Region const & reg, N32 y) {
+	return equal_range(reg.begin(), reg.end(), y, RowCompare());
+}
+
+/**
+ * @return the first run of reg in row y or below
+ */
+Region::RboIterator firstRow(Region const & reg, N32 y) {
+	return lower_bound(reg.begin(), reg.end(), y, RowCompare());
+}
+
+IPL_ANON_NS_END
+
+
+/**
+ * prepares the skeleton of B. B must not be empty.
+ * @param B the structuring element B
+ */
+Region::Erode2cutScan::Kernel::Kernel(Region const & B)
+	: lmin(0), lmax(0) {
+
+	for (auto & r : B) { // visits every run within B
+		if (r.len() > lmax) {
+			lmax = r.len();
+			origTranslate = -Point<N16>(r.start().x_ + r.len() - 1, r.start().y_); // this vector will be used to translate B such that the structuring
+																				 //  element contains its origin
+		}
+	}
+
+	RetGenerateSkeletonB skelB = generateSkeletonB(B,origTranslate);
+	lmin = skelB.lmin;
+	skeletonB.assign(skelB.skeletonB.begin(), skelB.skeletonB.end());
+	for (auto & s : skeletonB) {
+		skeletonRows.push_back(s.point.y_);
+	}
+	skeletonRows.erase(unique(skeletonRows.begin(), skeletonRows.end()), skeletonRows.end()); // B is sorted by rows
 
-	// -> creates the needed 2-dimensional array to store the erosion-transform of X
-	WinP Xbbox = this->boundingBox();
 	WinP Bbbox = B.boundingBox();
-	tr.x_ = -Xbbox.upperLeft().x_ + Bbbox.width();
-	tr.y_ = -Xbbox.upperLeft().y_ + Bbbox.height();
-	PictImageN16 Xlmin(2*(Xbbox.width() + 2*(Bbbox.width()+1)), Xbbox.height() + 2*(Bbbox.height()+1));
-	erosionTransformX.erosTransXlmin = Xlmin;
-	erosionTransformX.erosTransXlmin.fill(0); // initializes the erosion-transform of X with zeros.
-	// <-
+	extent = Point<N16>(Bbbox.width(), Bbbox.height());
+}
 
-	for (auto & r : *this) {
-		if (r.len() >= lmin) { // run r of X is longer than or equal to minimum sequence in B
-			j = 1;
-			j2 = r.len();
-			ycoord = r.start().y_ + tr.y_;
-			for (int i = r.start().x_ + tr.x_; i < r.start().x_ + tr.x_ + r.len(); ++i) {
+
+/**
+ * prepares the skeleton of B and the erosion-transform-array of X. X and B must not be empty.
+ * @param X the region to be eroded
+ * @param B the structuring element B
+ */
+Region::Erode2cutScan::Erode2cutScan(Region const & X, Region const & B)
+	: X(X), kernels(1, Kernel(B)),
+	  rowWidth(2*(X.boundingBox().width() + 2*(kernels.front().extent.x_+1))),
+	  erosTransXlmin(X.boundingBox().height() + 2*(kernels.front().extent.y_+1)) {
+	init();
+}
+
+
+/**
+ * prepares the skeletons of all structuring elements Bs and one erosion-transform-array of X,
+ * which is large enough for each of them. X and the Bs must not be empty.
+ * @param X the region to be eroded
+ * @param Bs the structuring elements
+ */
+Region::Erode2cutScan::Erode2cutScan(Region const & X, vector<Region> const & Bs)
+	: X(X), kernels(Bs.begin(), Bs.end()),
+	  rowWidth(2*(X.boundingBox().width() + 2*(maxExtent(kernels).x_+1))),
+	  erosTransXlmin(X.boundingBox().height() + 2*(maxExtent(kernels).y_+1)) {
+	init();
+}
+
+
+/**
+ * @return the largest width and height of the structuring elements
+ */
+Point<N16> Region::Erode2cutScan::maxExtent(vector<Kernel> const & kernels) {
+	Point<N16> extent(0, 0);
+	for (auto & k : kernels) {
+		extent.x_ = max(extent.x_, k.extent.x_);
+		extent.y_ = max(extent.y_, k.extent.y_);
+	}
+	return extent;
+}
+
+
+/**
+ * sets up the translation of X into the erosion-transform-array, which is large enough for
+ * the largest structuring element. A smaller lmin than needed by a structuring element
+ * only keeps more runs of X, which miss anyway.
+ */
+void Region::Erode2cutScan::init() {
+
+	lmin = 32767;
+	for (auto & k : kernels) {
+		lmin = min(lmin, k.lmin);
+	}
+
+	WinP Xbbox = X.boundingBox();
+	Point<N16> const extent = maxExtent(kernels);
+	translation.x_ = -Xbbox.upperLeft().x_ + extent.x_;
+	translation.y_ = -Xbbox.upperLeft().y_ + extent.y_;
+}
+
+
+/**
+ * allocates and computes the row ycoord of the erosion transform of X_{L_min}, if not done yet.
+ * @param ycoord row within the erosion-transform-array
+ */
+void Region::Erode2cutScan::prepareRow(N16 ycoord) {
+
+	vector<N16> & row = erosTransXlmin[ycoord];
+	if (!row.empty()) {
+		return;
+	}
+	row.assign(rowWidth, 0); // initializes the row of the erosion-transform with zeros.
+
+	auto runs = rowRange(X, ycoord - translation.y_);
+	for (auto r = runs.first; r != runs.second; ++r) {
+		if (r->len() >= lmin) { // run r of X is longer than or equal to minimum sequence in B
+			N16 j = 1;
+			N16 j2 = r->len();
+			for (int i = r->start().x_ + translation.x_; i < r->start().x_ + translation.x_ + r->len(); ++i) {
 			// fills the erosion-transform-array with values
-				erosionTransformX.erosTransXlmin(i<<1, ycoord) = j;
-				erosionTransformX.erosTransXlmin((i<<1) + 1, ycoord) = j2;
+				row[i<<1] = j;
+				row[(i<<1) + 1] = j2;
 				j++;
 				j2--;
 			}
+		}
+	}
+}
+
+
+/**
+ * applies the Jump-Miss- and Jump-Hit-Theorem for the structuring element k to the run r of X.
+ * The rows of the erosion transform needed by k must be prepared.
+ * @param k the structuring element
+ * @param r the run of X to be scanned
+ * @param hit called with every run of the erosion, returns false to stop the scan
+ * @return false if the scan got stopped by hit
+ */
+template<typename Hit>
+bool Region::Erode2cutScan::scanRun(Kernel const & k, Rbo const & r, Hit hit) {
+
+	bool breakl;
+	int xcoord;
+	N16 Diff, minDist, xend, ycoord;
+	vector<erosTransPoint>::const_iterator iterSkelB;
+
+	ycoord = r.start().y_ + translation.y_;
+	xcoord = r.start().x_ + translation.x_ + (k.lmax - 1); // basically a horizontal run-index pointing at the point to be investigated
+	xend = r.start().x_ + translation.x_ + r.len() - 1; // rightmost pixel of the current run
+	while (xcoord <= xend) { // we are investigating the pixel at xcoord as long as it is contained in the current run
+		breakl = false;
+		iterSkelB = k.skeletonB.begin();
+		while ((!breakl) && iterSkelB != k.skeletonB.end()) {
+			// the pixel h := (xcoord, ycoord) is contained in X eroded by B iff f^A_B(s) <= f^X_B(s + h) for all s in S^A_B.
+			while ((xcoord <= xend) && ((Diff = iterSkelB->erosTrans - erosTransXlmin[iterSkelB->point.y_ + ycoord][(iterSkelB->point.x_ + xcoord)<<1]) > 0)) { // Jump-And-Miss
+			    // this loop is entered in case there's a miss according to the jump-miss-theorem
+				breakl = true; // a miss occured
+				xcoord = xcoord + Diff; // checks for more misses within the current line
+			}
+			iterSkelB++;
+		}
+
+		if (!breakl) {
+			minDist = 32767; // minDist is set to maximum value;
+			for (auto & s : k.skeletonB) {
+				minDist = min(minDist,erosTransXlmin[s.point.y_ + ycoord][((s.point.x_ + xcoord)<<1)+1]); // this variable is needed to apply the jump-hit-theorem
+			}
 
-			if (r.len() >= lmax) {
-				erosionTransformX.Xlmin.add(Rbo(Point<N16>(r.start().x_ + tr.x_ + (lmax - 1), ycoord), r.len() - (lmax - 1))); // add current run to X_{cut}
+			// apply jump-hit-theorem; since the structuring element got translated by origTranslate,
+			// also the eroded run needs to be translated by the same vector.
+			if (!hit(Rbo(Point<N16>(xcoord - translation.x_ + k.origTranslate.x_, r.start().y_ + k.origTranslate.y_), minDist))) {
+				return false;
 			}
+			xcoord = xcoord + minDist + 1; // our next eroded run starts at xcoord or >xcoord
 		}
 	}
 
-	erosionTransformX.translation = tr;
+	return true;
+}
 
-	return erosionTransformX;
+
+/**
+ * applies the Jump-Miss- and Jump-Hit-Theorem to the runs [first, last) of X.
+ * Every run of the erosion is passed to hit in its final position; if hit returns false the scan stops.
+ * @param first first run of X to be scanned
+ * @param last behind the last run of X to be scanned
+ * @param hit called with every run of the erosion, returns false to stop the scan
+ * @return false if the scan got stopped by hit
+ */
+template<typename Hit>
+bool Region::Erode2cutScan::scan(RboIterator first, RboIterator last, Hit hit) {
+
+	Kernel const & k = kernels.front();
+	for ( ; first != last; ++first) {
+		if (first->len() < k.lmax) { // the run is not contained in X_{cut}
+			continue;
+		}
+		N16 const ycoord = first->start().y_ + translation.y_;
+		for (auto dy : k.skeletonRows) {
+			prepareRow(ycoord + dy);
+		}
+		if (!scanRun(k, *first, hit)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/**
+ * applies the Jump-Miss- and Jump-Hit-Theorem to the runs of X, which contribute to the row y of the erosion.
+ * @param y row of the erosion
+ * @param hit called with every run of the erosion in row y, returns false to stop the scan
+ * @return false if the scan got stopped by hit
+ */
+template<typename Hit>
+bool Region::Erode2cutScan::scanRow(N32 y, Hit hit) {
+	auto runs = rowRange(X, y - kernels.front().origTranslate.y_);
+	return scan(runs.first, runs.second, hit);
+}
+
+
+/**
+ * applies the Jump-Miss- and Jump-Hit-Theorem for the structuring element i to the run r of X, or to a part of it.
+ * A hit at a pixel of X only depends on the erosion transform, so scanning a part of a run yields exactly
+ * the runs of the erosion starting within that part.
+ * @param i the index of the structuring element
+ * @param r the run of X or a part of it
+ * @param hit called with every run of the erosion, returns false to stop the scan
+ * @return false if the scan got stopped by hit
+ */
+template<typename Hit>
+bool Region::Erode2cutScan::scanPart(size_t i, Rbo const & r, Hit hit) {
+
+	Kernel const & k = kernels[i];
+	if (r.len() < k.lmax) { // the run is not contained in X_{cut}
+		return true;
+	}
+	N16 const ycoord = r.start().y_ + translation.y_;
+	for (auto dy : k.skeletonRows) { // rows shared with other structuring elements are computed once
+		prepareRow(ycoord + dy);
+	}
+	return scanRun(k, r, hit);
+}
+
+
+/**
+ * applies the Jump-Miss- and Jump-Hit-Theorem for all structuring elements to the runs [first, last) of X.
+ * Each run of X is visited once, the rows of the erosion transform needed by any structuring element
+ * are prepared once for all of them.
+ * @param first first run of X to be scanned
+ * @param last behind the last run of X to be scanned
+ * @param hit called with the index of the structuring element and every run of its erosion
+ */
+template<typename BankHit>
+void Region::Erode2cutScan::scanBank(RboIterator first, RboIterator last, BankHit hit) {
+
+	N16 lmaxMin = 32767;
+	for (auto & k : kernels) {
+		lmaxMin = min(lmaxMin, k.lmax);
+	}
+	for ( ; first != last; ++first) {
+		if (first->len() < lmaxMin) { // the run is not contained in any X_{cut}
+			continue;
+		}
+		for (size_t i = 0; i < kernels.size(); ++i) {
+			scanPart(i, *first, [&hit, i](Rbo const & r) {
+				hit(i, r);
+				return true;
+			});
+		}
+	}
 }
 
 
@@ -759,7 +1112,7 @@ Region const Region::erode1(Region const & B) const {
  * of X_{L_min} with A aswell as with A^t. With this preprocessing-steps it is possible
  * to apply the Jump-Miss- and Jump-Hit-Theorem in the final step.
  *
- * uses: generateSkeletonB(), generateErosionTransformX2cut()
+ * uses: generateSkeletonB(), generateErosionTransformX2()
  *
  * @param B the structuring element B
  * @return the region eroded by B
@@ -864,85 +1217,444 @@ Region const Region::erode2cut(Region const & B) const {
 		return *this;
 	}
 
-	bool breakl;
-	int xcoord;
-	N16 Diff, minDist, xend, lmax;
-	Point<N16> origTranslate;
-	list<erosTransPoint>::iterator iterSkelB;
 	Region erodedImage;
+	Erode2cutScan(*this, B).scan(this->begin(), this->end(), [&erodedImage](Rbo const & r) {
+		erodedImage.add(r);
+		return true;
+	});
 
-//	FILE *eOut = fopen("erode2.dat","a");															// Time-Measurement: should be commented in release
-//	Timer tm;																						//
-//	UN32 duration;
+	return erodedImage;
+}
 
-	lmax = 0; // initializing L_max with minimum value
 
-	for (auto & r : B) { // visits every run within B
-		if (r.len() > lmax) {
-			lmax = r.len();
-			origTranslate = -Point<N16>(r.start().x_ + r.len() - 1, r.start().y_); // this vector will be used to translate B such that the structuring
-																				 //  element contains its origin
+/**
+ * erodes by all structuring elements in one scan of X.
+ * Empty structuring elements are left out of the scan, their erosion is X as in erode2cut.
+ *
+ * uses: Erode2cutScan
+ *
+ * @param Bs the structuring elements
+ * @return the region eroded by each of Bs
+ */
+vector<Region> const Region::erode2cut(vector<Region> const & Bs) const {
+
+	vector<Region> erodedImages(Bs.size());
+	vector<Region> bank;
+	vector<size_t> bankIndex; // the index of each structuring element of the bank within Bs
+	for (size_t i = 0; i < Bs.size(); ++i) {
+		if (this->empty() || Bs[i].empty()) {
+			erodedImages[i] = *this;
+		} else {
+			bank.push_back(Bs[i]);
+			bankIndex.push_back(i);
 		}
 	}
+	if (bank.empty()) {
+		return erodedImages;
+	}
 
-	// -> preprocessing skeleton of B and erosion-transform of X plus some additional information
-//    tm.tic(); // Time-Measurement: should be commented in release
-	RetGenerateSkeletonB skelB = generateSkeletonB(B,origTranslate);
-//    duration = tm.toc();				// Time-Measurement: should be commented in release
-//    fprintf(eOut, "\t%u", duration);	//
-//
-//    tm.tic(); // Time-Measurement: should be commented in release
-	RetGenerateErosionTransformX erosTransX = generateErosionTransformX2cut(B,skelB.lmin,lmax);
-//    duration = tm.toc();				// Time-Measurement: should be commented in release
-//    fprintf(eOut, "\t%u", duration);	//
-	// <-
+	Erode2cutScan(*this, bank).scanBank(this->begin(), this->end(), [&erodedImages, &bankIndex](size_t k, Rbo const & r) {
+		erodedImages[bankIndex[k]].add(r);
+	});
 
-//    tm.tic(); // Time-Measurement: should be commented in release
-	Region Xlmin = erosTransX.Xlmin; // X_{L_min} as RLE image
-	list<erosTransPoint> skeletonB = skelB.skeletonB; // skeleton of B plus their erosion-transform-values as list
+	return erodedImages;
+}
 
-	for (auto & r : Xlmin) {
-		xcoord = r.start().x_; // basically a horizontal run-index pointing at the point to be investigated
-		xend = r.start().x_ + r.len() - 1; // rightmost pixel of the current run
-		while (xcoord <= xend) { // we are investigating the pixel at xcoord as long as it is contained in the current run
-			breakl = false;
-			iterSkelB = skeletonB.begin();
-			while ((!breakl) && iterSkelB != skeletonB.end()) {
-				// the pixel h := (xcoord, r->start().y) is contained in X eroded by B iff f^A_B(s) <= f^X_B(s + h) for all s in S^A_B.
-				while ((xcoord <= xend) && ((Diff = iterSkelB->erosTrans - erosTransX.erosTransXlmin((iterSkelB->point.x_ + xcoord)<<1, iterSkelB->point.y_ + r.start().y_)) > 0)) { // Jump-And-Miss
-				    // this loop is entered in case there's a miss according to the jump-miss-theorem
-					breakl = true; // a miss occured
-					xcoord = xcoord + Diff; // checks for more misses within the current line
+
+/**
+ * @param Bs the structuring elements
+ * @return the union of the region eroded by each of Bs
+ */
+Region const Region::erodeUnion(vector<Region> const & Bs) const {
+	vector<Region> const erodedImages = this->erode2cut(Bs);
+	return unionAll(erodedImages.begin(), erodedImages.end());
+}
+
+
+/**
+ * X eroded by B1 intersected with X eroded by B2 equals X eroded by the union of B1 and B2.
+ *
+ * @param Bs the structuring elements
+ * @return the intersection of the region eroded by each of Bs
+ */
+Region const Region::erodeIntersection(vector<Region> const & Bs) const {
+	if (Bs.empty()) {
+		return *this;
+	}
+	return this->erode2cut(unionAll(Bs.begin(), Bs.end()));
+}
+
+
+/**
+ * erodes every zone by its own structuring element in one scan of X.
+ * The output row of a run of X and a structuring element is fixed by the translation of the
+ * structuring element, so a row of X is scanned only by the structuring elements whose output
+ * row meets the bounding box of their zone, and a run only in the part whose hits may start
+ * within the columns of the zone. The hits are clipped to the runs of the zone.
+ *
+ * uses: Erode2cutScan
+ *
+ * @param zones the zones
+ * @param Bs the structuring element of each zone
+ * @return the region eroded by Bs[i] and clipped to zones[i] for each i
+ */
+vector<Region> const Region::erodeInZones(vector<Region> const & zones, vector<Region> const & Bs) const {
+
+	if (zones.size() != Bs.size()) {
+		throw ParameterError(2, string(IPL_FNC_NAME) + ": not one structuring element per zone");
+	}
+
+	vector<Region> erodedZones(zones.size());
+	vector<Region> bank;
+	vector<size_t> bankIndex; // the index of each structuring element of the bank within Bs
+	for (size_t i = 0; i < Bs.size(); ++i) {
+		if (this->empty() || zones[i].empty()) {
+			continue;
+		}
+		if (Bs[i].empty()) {
+			erodedZones[i] = this->intersect(zones[i]);
+		} else {
+			bank.push_back(Bs[i]);
+			bankIndex.push_back(i);
+		}
+	}
+	if (bank.empty()) {
+		return erodedZones;
+	}
+
+	Erode2cutScan scanner(*this, bank);
+	// the part of X, where the runs may have hits within the bounding box of the zone, for each structuring element
+	struct ScanWindow {
+		N32 x0, y0, x1, y1;
+	};
+	vector<ScanWindow> windows;
+	for (size_t k = 0; k < bank.size(); ++k) {
+		Erode2cutScan::Kernel const & kernel = scanner.kernels[k];
+		WinP const & zoneBox = zones[bankIndex[k]].boundingBox();
+		ScanWindow const w = { zoneBox.upperLeft().x_ - kernel.origTranslate.x_ - (kernel.lmax - 1), // hits are tested lmax - 1 behind the start of a run
+							   zoneBox.upperLeft().y_ - kernel.origTranslate.y_,
+							   zoneBox.lowerRight().x_ - kernel.origTranslate.x_,
+							   zoneBox.lowerRight().y_ - kernel.origTranslate.y_ };
+		windows.push_back(w);
+	}
+
+	vector<size_t> active; // the structuring elements scanning the current row of X
+	vector<pair<RboIterator, RboIterator> > zoneRows; // the runs of their zones in their output rows
+	for (auto first = this->begin(); first != this->end(); ) {
+		N32 const y = first->start().y_;
+		active.clear();
+		zoneRows.clear();
+		for (size_t k = 0; k < windows.size(); ++k) {
+			if (windows[k].y0 <= y && y <= windows[k].y1) {
+				active.push_back(k);
+				zoneRows.push_back(rowRange(zones[bankIndex[k]], y + scanner.kernels[k].origTranslate.y_));
+			}
+		}
+		for ( ; first != this->end() && first->start().y_ == y; ++first) {
+			for (size_t a = 0; a < active.size(); ++a) {
+				size_t const k = active[a];
+				N32 const start = max<N32>(first->start().x_, windows[k].x0);
+				N32 const end = min<N32>(first->start().x_ + first->len() - 1, windows[k].x1);
+				if (end < start) {
+					continue;
 				}
-				iterSkelB++;
+				Region & erodedZone = erodedZones[bankIndex[k]];
+				pair<RboIterator, RboIterator> const & runs = zoneRows[a];
+				scanner.scanPart(k, Rbo(Point<N16>(start, y), end - start + 1), [&erodedZone, &runs](Rbo const & r) {
+					// clips the run of the erosion to the runs of the zone
+					N32 const hitEnd = r.start().x_ + r.len() - 1;
+					for (auto z = runs.first; z != runs.second; ++z) {
+						N32 const clipStart = max<N32>(r.start().x_, z->start().x_);
+						N32 const clipEnd = min<N32>(hitEnd, z->start().x_ + z->len() - 1);
+						if (clipStart <= clipEnd) {
+							erodedZone.add(Rbo(Point<N16>(clipStart, r.start().y_), clipEnd - clipStart + 1));
+						}
+					}
+					return true;
+				});
 			}
+		}
+	}
 
-			if (!breakl) {
-				minDist = 32767; // minDist is set to maximum value;
-				for (list<erosTransPoint>::const_iterator iterSkel = skeletonB.begin(); iterSkel != skeletonB.end(); ++iterSkel) {
-					minDist = min(minDist,erosTransX.erosTransXlmin(((iterSkel->point.x_ + xcoord)<<1)+1, iterSkel->point.y_ + r.start().y_)); // this variable is needed to apply the jump-hit-theorem
-				}
+	return erodedZones;
+}
 
-				// apply jump-hit-theorem
-				erodedImage.add(Rbo(Point<N16>(xcoord - erosTransX.translation.x_, r.start().y_ - erosTransX.translation.y_), minDist));
-				xcoord = xcoord + minDist + 1; // our next eroded run starts at xcoord or >xcoord
+
+/**
+ * @param zones the zones
+ * @param Bs the structuring element of each zone
+ * @return the union of the zones eroded by their structuring elements
+ */
+Region const Region::erodeZones(vector<Region> const & zones, vector<Region> const & Bs) const {
+	vector<Region> const erodedZones = this->erodeInZones(zones, Bs);
+	return unionAll(erodedZones.begin(), erodedZones.end());
+}
+
+
+/**
+ * @param zones the zones as windows
+ * @param Bs the structuring element of each zone
+ * @return the union of the zones eroded by their structuring elements
+ */
+Region const Region::erodeZones(vector<WinP> const & zones, vector<Region> const & Bs) const {
+	return this->erodeZones(vector<Region>(zones.begin(), zones.end()), Bs);
+}
+
+
+/**
+ * dilates every zone by its own structuring element.
+ * p is not contained in X dilated by B iff p - b is contained in X^c for every b in B, i.e. iff
+ * p is contained in X^c eroded by B^t. X^c is only needed within the zones enlarged by the B^t.
+ *
+ * uses: erodeInZones()
+ *
+ * @param zones the zones
+ * @param Bs the structuring element of each zone
+ * @return the union of the zones dilated by their structuring elements
+ */
+Region const Region::dilateZones(vector<Region> const & zones, vector<Region> const & Bs) const {
+
+	if (zones.size() != Bs.size()) {
+		throw ParameterError(2, string(IPL_FNC_NAME) + ": not one structuring element per zone");
+	}
+	if (this->empty()) {
+		return Region();
+	}
+
+	// the reflected structuring elements and the universe covering p - b for every p of a zone
+	vector<Region> reflectedBs(Bs.size());
+	N32 x0 = 32767, y0 = 32767, x1 = -32768, y1 = -32768;
+	for (size_t i = 0; i < Bs.size(); ++i) {
+		for (auto b = Bs[i].end(); b != Bs[i].begin(); ) {
+			--b;
+			reflectedBs[i].add(Rbo(Point<N16>(-b->start().x_ - b->len() + 1, -b->start().y_), b->len()));
+		}
+		if (zones[i].empty()) {
+			continue;
+		}
+		WinP const & zoneBox = zones[i].boundingBox();
+		WinP const Bbox = Bs[i].empty() ? WinP(0, 0, 0, 0) : Bs[i].boundingBox();
+		x0 = min<N32>(x0, zoneBox.upperLeft().x_ - Bbox.lowerRight().x_);
+		y0 = min<N32>(y0, zoneBox.upperLeft().y_ - Bbox.lowerRight().y_);
+		x1 = max<N32>(x1, zoneBox.lowerRight().x_ - Bbox.upperLeft().x_);
+		y1 = max<N32>(y1, zoneBox.lowerRight().y_ - Bbox.upperLeft().y_);
+	}
+	if (x1 < x0) { // all zones are empty
+		return Region();
+	}
+
+	WinP const universe(x0, y0, x1, y1);
+	vector<Region> const missing = this->complement(&universe).erodeInZones(zones, reflectedBs);
+	vector<Region> dilatedZones;
+	for (size_t i = 0; i < zones.size(); ++i) {
+		dilatedZones.push_back(zones[i].subtract(missing[i]));
+	}
+	return unionAll(dilatedZones.begin(), dilatedZones.end());
+}
+
+
+/**
+ * @param zones the zones as windows
+ * @param Bs the structuring element of each zone
+ * @return the union of the zones dilated by their structuring elements
+ */
+Region const Region::dilateZones(vector<WinP> const & zones, vector<Region> const & Bs) const {
+	return this->dilateZones(vector<Region>(zones.begin(), zones.end()), Bs);
+}
+
+
+/**
+ * does the same scan as erode2cut, but stops at the first hit.
+ *
+ * uses: Erode2cutScan
+ *
+ * @param B the structuring element B
+ * @return true iff the region eroded by B is not empty
+ */
+bool Region::fits(Region const & B) const {
+
+	if (this->empty() || B.empty()) {
+		return !this->empty();
+	}
+
+	return !Erode2cutScan(*this, B).scan(this->begin(), this->end(), [](Rbo const &) {
+		return false; // the first hit suffices
+	});
+}
+
+
+/**
+ * does the same scan as erode2cut, but only sums up the lengths minDist of the hits.
+ *
+ * uses: Erode2cutScan
+ *
+ * @param B the structuring element B
+ * @return the area of the region eroded by B
+ */
+N32 Region::erodedArea(Region const & B) const {
+
+	N32 area = 0;
+	if (this->empty() || B.empty()) {
+		for (auto & r : *this) {
+			area += r.len();
+		}
+		return area;
+	}
+
+	Erode2cutScan(*this, B).scan(this->begin(), this->end(), [&area](Rbo const & r) {
+		area += r.len();
+		return true;
+	});
+
+	return area;
+}
+
+
+/**
+ * the state of a lazy erosion: a reference to X and the scan of X by B.
+ * If X or B is empty there is no scan, the erosion equals X.
+ */
+struct Region::LazyErosion::Impl {
+	Impl(Region const & orig, Region const & B)
+		: X(orig), scanner(X.empty() || B.empty() ? 0 : new Erode2cutScan(X, B)) {
+	}
+
+	template<typename Hit>
+	bool scan(RboIterator first, RboIterator last, Hit hit) {
+		if (scanner) {
+			return scanner->scan(first, last, hit);
+		}
+		for ( ; first != last; ++first) {
+			if (!hit(*first)) {
+				return false;
 			}
 		}
+		return true;
 	}
 
-//    duration = tm.toc();				// Time-Measurement: should be commented in release
-//    fprintf(eOut, "\t%u", duration);	//
-//    tm.tic(); 							//
+	template<typename Hit>
+	bool scanRow(N32 y, Hit hit) {
+		if (scanner) {
+			return scanner->scanRow(y, hit);
+		}
+		auto runs = rowRange(X, y);
+		return scan(runs.first, runs.second, hit);
+	}
 
-	erodedImage.translate(origTranslate); // since the structuring element got translated by origTranslate,
-										  // also the eroded Image needs to be translated by the same vector.
+	Region const & X; /**< the region to be eroded; must outlive the lazy erosion and its iterators */
+	boost::scoped_ptr<Erode2cutScan> scanner; /**< the scan of X by B */
+};
 
-//	duration = tm.toc();				// Time-Measurement: should be commented in release
-//  fprintf(eOut, "\t%u", duration);	//
-//	fprintf(eOut,"\n");					//
-//	fflush(eOut);						//
 
-	return erodedImage;
+/**
+ * @param B the structuring element B
+ * @return the region eroded by B, evaluated on demand
+ */
+Region::LazyErosion const Region::erode2cutLazy(Region const & B) const {
+	return LazyErosion(*this, B);
+}
+
+
+Region::LazyErosion::LazyErosion(Region const & X, Region const & B)
+	: impl_(new Impl(X, B)) {
+}
+
+
+Region::LazyErosion::Iterator Region::LazyErosion::begin() const {
+	return Iterator(impl_, impl_->X.begin());
+}
+
+
+Region::LazyErosion::Iterator Region::LazyErosion::end() const {
+	return Iterator(impl_, impl_->X.end());
+}
+
+
+void Region::LazyErosion::row(N16 y, std::vector<Rbo> & rbos) const {
+	impl_->scanRow(y, [&rbos](Rbo const & r) {
+		rbos.push_back(r);
+		return true;
+	});
+}
+
+
+/**
+ * the runs of a row of the erosion are sorted, so the scan stops at the first run right of pt.
+ */
+bool Region::LazyErosion::includes(PointN16 const & pt) const {
+	bool found = false;
+	impl_->scanRow(pt.y_, [&pt, &found](Rbo const & r) {
+		if (r.start().x_ > pt.x_) {
+			return false;
+		}
+		if (r.start().x_ + r.len() > pt.x_) {
+			found = true;
+			return false;
+		}
+		return true;
+	});
+	return found;
+}
+
+
+Region const Region::LazyErosion::intersect(Region const & other) const {
+	vector<Rbo> rbos;
+	Region erodedRows;
+	for (auto r = other.begin(); r != other.end(); ) {
+		N16 const y = r->start().y_;
+		rbos.clear();
+		row(y, rbos);
+		for (auto & e : rbos) {
+			erodedRows.add(e);
+		}
+		while (r != other.end() && r->start().y_ == y) { // next row of other
+			++r;
+		}
+	}
+	return erodedRows.intersect(other);
+}
+
+
+Region::LazyErosion::Iterator::Iterator()
+	: row_(0), rowEnd_(0), idx_(0) {
+}
+
+
+Region::LazyErosion::Iterator::Iterator(boost::shared_ptr<Impl> const & impl, RboIterator row)
+	: impl_(impl), row_(row), rowEnd_(row), idx_(0) {
+	nextHits();
+}
+
+
+Region::LazyErosion::Iterator & Region::LazyErosion::Iterator::operator++() {
+	if (++idx_ == rbos_.size()) {
+		row_ = rowEnd_;
+		nextHits();
+	}
+	return *this;
+}
+
+
+/**
+ * scans the rows of X starting at row_ until one of them contributes to the erosion.
+ * At the end row_ equals the end of X and rbos_ is empty.
+ */
+void Region::LazyErosion::Iterator::nextHits() {
+	rbos_.clear();
+	idx_ = 0;
+	RboIterator const last = impl_->X.end();
+	while (row_ != last) {
+		for (rowEnd_ = row_; rowEnd_ != last && rowEnd_->start().y_ == row_->start().y_; ++rowEnd_) {
+		}
+		impl_->scan(row_, rowEnd_, [this](Rbo const & r) {
+			rbos_.push_back(r);
+			return true;
+		});
+		if (!rbos_.empty()) {
+			return;
+		}
+		row_ = rowEnd_;
+	}
 }
 
 
@@ -1262,4 +1974,82 @@ Region const Region::dilatecut(Region const & B) const {
 	return dilatedImage;
 }
 
+/**
+ * erosion restricted to a window
+ * Only the pixels of X within win enlarged by the extent of B are needed to compute
+ * the erosion inside win, since h is a hit iff B + h is a subset of X. Therefore only
+ * the runs of X within this halo are copied before the erosion-transform is generated;
+ * the first row of the halo is found by a binary search, so the runs outside of its
+ * rows are never visited.
+ *
+ * uses: erode2cut()
+ *
+ * @param B the structuring element B
+ * @param win the window where the erosion is needed
+ * @return the region eroded by B and clipped to win
+ */
+Region const Region::erode2cut(Region const & B, WinP const & win) const {
+
+	if (this->empty() || B.empty()) {
+		Region res;
+		clipRange(firstRow(*this, win.upperLeft().y_), this->end(), win, res);
+		return res;
+	}
+
+	WinP const & Bbbox = B.boundingBox();
+	// the window enlarged by B, the pixel h + b has to be checked for every h in win and every b in B
+	WinP halo(win.upperLeft().x_ + Bbbox.upperLeft().x_,
+			  win.upperLeft().y_ + Bbbox.upperLeft().y_,
+			  win.lowerRight().x_ + Bbbox.lowerRight().x_,
+			  win.lowerRight().y_ + Bbbox.lowerRight().y_);
+
+	Region Xwin;
+	clipRange(firstRow(*this, halo.upperLeft().y_), this->end(), halo, Xwin);
+	if (Xwin.empty()) {
+		return Xwin;
+	}
+
+	Region res = Xwin.erode2cut(B);
+	return res.clip(win);
+}
+
+
+/**
+ * dilation restricted to a window
+ * Only the pixels of X within win enlarged by the extent of B^t are needed to compute
+ * the dilation inside win, since p is contained in the dilation iff p - b is contained
+ * in X for some b in B. Therefore only the runs of X within this halo are copied, starting
+ * at its first row found by a binary search, before the erosion-transform of X^c is generated.
+ *
+ * uses: dilatecut()
+ *
+ * @param B the structuring element B
+ * @param win the window where the dilation is needed
+ * @return the region dilated by B and clipped to win
+ */
+Region const Region::dilatecut(Region const & B, WinP const & win) const {
+
+	if (this->empty() || B.empty()) {
+		Region res;
+		clipRange(firstRow(*this, win.upperLeft().y_), this->end(), win, res);
+		return res;
+	}
+
+	WinP const & Bbbox = B.boundingBox();
+	// the window enlarged by B^t, the pixel p - b has to be checked for every p in win and every b in B
+	WinP halo(win.upperLeft().x_ - Bbbox.lowerRight().x_,
+			  win.upperLeft().y_ - Bbbox.lowerRight().y_,
+			  win.lowerRight().x_ - Bbbox.upperLeft().x_,
+			  win.lowerRight().y_ - Bbbox.upperLeft().y_);
+
+	Region Xwin;
+	clipRange(firstRow(*this, halo.upperLeft().y_), this->end(), halo, Xwin);
+	if (Xwin.empty()) {
+		return Xwin;
+	}
+
+	Region res = Xwin.dilatecut(B);
+	return res.clip(win);
+}
+
 IPL_NS_END
@@ -0,0 +1,257 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Parallel Operations of Regions
+ *
+ ********************************************************************/
+
+#include "ipl/region.hh"
+
+#include <algorithm>
+#include <vector>
+
+#include "ipl/executor.hh"
+#include "ipl/pict.hh"
+#include "ipl/winp.hh"
+#include "ipl/iplerr.hh"
+
+using namespace std;
+
+IPL_NS_BEGIN
+
+IPL_ANON_NS_BEGIN
+
+//! Minimal number of Rbo's of a band of a set operation.
+N32 const minRbosPerBand = 4096;
+
+//! Minimal number of pixels of a band of a binarization.
+N32 const minPixelsPerBand = 1 << 16;
+
+//! Number of bands for @a work units of @a grain on @a ex.
+inline N32
+nrBands(Executor const & ex, N32 work, N32 grain)
+{
+    return max<N32>(1, min<N32>(ex.nrThreads(), work / grain));
+}
+
+//! Number of pixels of @a reg.
+N32
+nrPixels(Region const & reg)
+{
+    N32 n = 0;
+    for (auto r = reg.begin(); r != reg.end(); ++r)
+        n += r->len();
+    return n;
+}
+
+//! Compares a Rbo with a row.
+struct RowLess {
+    bool operator()(Rbo const & r, N32 y) const {
+        return r.start().y_ < y;
+    }
+};
+
+//! The first rows of the bands 1, ..., @a n - 1.
+/*! The bands contain about the same number of Rbo's of @a reg. Bands without
+ * any row are dropped, so the result may be shorter.
+ */
+vector<N32>
+splitRows(Region const & reg, N32 n)
+{
+    vector<N32> rows;
+    N32 const size = reg.nrRbos();
+    for (N32 k = 1; k < n; ++k) {
+        N32 const y = (reg.begin() + (N64(size) * k) / n)->start().y_;
+        if (y > reg.begin()->start().y_ && (rows.empty() || y > rows.back()))
+            rows.push_back(y);
+    }
+    return rows;
+}
+
+//! Bounds of the bands of @a reg for the first rows @a rows.
+/*! The band @a k is [result[k], result[k+1]).
+ */
+vector<Region::RboIterator>
+bandBounds(Region const & reg, vector<N32> const & rows)
+{
+    vector<Region::RboIterator> bounds;
+    bounds.push_back(reg.begin());
+    for (auto y = rows.begin(); y != rows.end(); ++y)
+        bounds.push_back(lower_bound(bounds.back(), reg.end(), *y, RowLess()));
+    bounds.push_back(reg.end());
+    return bounds;
+}
+
+IPL_ANON_NS_END
+
+void
+Region::concat(vector<Region> const & parts, Region & res)
+{
+    size_t size = res.rbos_.size();
+    for (auto p = parts.begin(); p != parts.end(); ++p)
+        size += p->rbos_.size();
+    res.rbos_.reserve(size);
+    for (auto p = parts.begin(); p != parts.end(); ++p)
+        res.rbos_.insert(res.rbos_.end(), p->rbos_.begin(), p->rbos_.end());
+    res.invalidateCaches();
+}
+
+Region::Region(PictImg<UN8> const & img,
+               N32 lo, N32 hi,
+               Executor & ex)
+{
+    createFromPic(img, lo, hi, ex);
+}
+
+Region::Region(PictImg<N16> const & img,
+               N32 lo, N32 hi,
+               Executor & ex)
+{
+    createFromPic(img, lo, hi, ex);
+}
+
+/*! @internal The bands are runs of whole rows of the roi with about the same
+ * number of scanlines.
+ */
+template<typename T>
+void
+Region::createFromPic(PictImg<T> const & img,
+                      N32 lo, N32 hi,
+                      Executor & ex)
+{
+    IPL_ASSERT_VALID(img);
+    Region const & roi = img.roi();
+    N32 const n = nrBands(ex, nrPixels(roi), minPixelsPerBand);
+    if (n == 1 || lo > hi) {
+        createFromPic(img, lo, hi);
+        return;
+    }
+    IPLLOG_INFO(IPL_FNC_NAME << " from binarization with " << PointN16(lo,hi)
+                << " in " << n << " bands");
+    this->rbos_.clear();
+    this->invalidateCaches();
+
+    vector<RboIterator> const bounds = bandBounds(roi, splitRows(roi, n));
+    vector<Region> parts(bounds.size() - 1);
+    ex.run(parts.size(), [&](N32 k) {
+            binarizeRange(img, lo, hi, bounds[k], bounds[k+1], parts[k]);
+        });
+    concat(parts, *this);
+    IPLLOG_INFO(IPL_FNC_NAME << ": -> " << *this);
+    IPL_ASSERT_VALID(*this);
+}
+
+/*! @internal Both Regions are split at the same rows, the bands contain
+ * about the same number of Rbo's of the larger Region.
+ */
+Region const
+Region::unions(Region const & other, Executor & ex) const
+{
+    IPL_ASSERT_VALID(*this);
+    IPL_ASSERT_VALID(other);
+    N32 const n = nrBands(ex, this->nrRbos() + other.nrRbos(), minRbosPerBand);
+    if (n == 1 || this->empty() || other.empty())
+        return this->unions(other);
+
+    vector<N32> const rows = splitRows(this->nrRbos() >= other.nrRbos()
+                                       ? *this : other, n);
+    vector<RboIterator> const r = bandBounds(*this, rows),
+        s = bandBounds(other, rows);
+    vector<Region> parts(r.size() - 1);
+    ex.run(parts.size(), [&](N32 k) {
+            parts[k].rbos_.reserve((r[k+1] - r[k]) + (s[k+1] - s[k]));
+            unionRange(r[k], r[k+1], s[k], s[k+1], parts[k]);
+        });
+    Region reg;
+    concat(parts, reg);
+    IPL_ASSERT_VALID(reg);
+    return reg;
+}
+
+/*! @internal The bands are the same as in Region::unions(Region const &,
+ * Executor &).
+ */
+Region const
+Region::intersect(Region const & other, Executor & ex) const
+{
+    IPL_ASSERT_VALID(*this);
+    IPL_ASSERT_VALID(other);
+    N32 const n = nrBands(ex, this->nrRbos() + other.nrRbos(), minRbosPerBand);
+    if (n == 1 || this->empty() || other.empty())
+        return this->intersect(other);
+
+    vector<N32> const rows = splitRows(this->nrRbos() >= other.nrRbos()
+                                       ? *this : other, n);
+    vector<RboIterator> const r = bandBounds(*this, rows),
+        s = bandBounds(other, rows);
+    vector<Region> parts(r.size() - 1);
+    ex.run(parts.size(), [&](N32 k) {
+            intersectRange(r[k], r[k+1], s[k], s[k+1], parts[k]);
+        });
+    Region reg;
+    concat(parts, reg);
+    IPL_ASSERT_VALID(reg);
+    return reg;
+}
+
+/*! @internal The rows of the universe are split into bands of equal height,
+ * each band is the universe of a serial complement.
+ */
+Region const
+Region::complement(WinP const * universe, Executor & ex) const
+{
+    IPL_ASSERT_VALID(*this);
+    if (this->empty())
+        return this->complement(universe);
+    WinP const & u = universe ? *universe : this->boundingBox();
+    N32 const n = nrBands(ex, this->nrRbos() + u.height(), minRbosPerBand);
+    if (n == 1 || u.height() < n)
+        return this->complement(&u);
+
+    N32 const y0 = u.upperLeft().y_;
+    vector<N32> rows;
+    for (N32 k = 1; k < n; ++k)
+        rows.push_back(y0 + (u.height() * k) / n);
+    vector<RboIterator> const r = bandBounds(*this, rows);
+    vector<Region> parts(n);
+    ex.run(n, [&](N32 k) {
+            WinP const band(PointN16(u.upperLeft().x_, k ? rows[k-1] : y0),
+                            PointN16(u.lowerRight().x_,
+                                     k + 1 < n ? rows[k] - 1 : u.lowerRight().y_));
+            complementRange(r[k], r[k+1], band, parts[k]);
+        });
+    Region reg;
+    concat(parts, reg);
+    IPL_ASSERT_VALID(reg);
+    return reg;
+}
+
+/*! @internal The Rbo's are only replaced, when all bands are clipped.
+ */
+Region &
+Region::clip(WinP const & win, Executor & ex)
+{
+    IPL_ASSERT_VALID(*this);
+    IPL_ASSERT_VALID(win);
+    N32 const n = nrBands(ex, this->nrRbos(), minRbosPerBand);
+    if (n == 1)
+        return this->clip(win);
+
+    vector<RboIterator> const r = bandBounds(*this, splitRows(*this, n));
+    vector<Region> parts(r.size() - 1);
+    ex.run(parts.size(), [&](N32 k) {
+            clipRange(r[k], r[k+1], win, parts[k]);
+        });
+    Region reg;
+    concat(parts, reg);
+    rbos_.swap(reg.rbos_);
+    this->invalidateCaches();
+    IPL_ASSERT_VALID(*this);
+    return *this;
+}
+
+IPL_NS_END
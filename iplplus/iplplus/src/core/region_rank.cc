@@ -0,0 +1,178 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Rank erosion of a Region
+ *
+ ********************************************************************/
+
+#include "ipl/region.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "ipl/iplerr.hh"
+
+using namespace std;
+
+IPL_NS_BEGIN
+
+IPL_ANON_NS_BEGIN
+
+//! A run of the structuring element at a point of a row of the result.
+struct ActiveRun
+{
+    //! the prefix counts of its row of the object, at x = 0 of the result
+    N32 const * counts_;
+    //! its length
+    N32 len_;
+};
+
+//! Prefix counts of the rows of a Region.
+/*! counts(y)[i] is the number of pixels of row @em y left of
+ * <em>x0 + i</em>. The columns cover the bounding box widened by a margin
+ * on both sides, so a structuring element of that width never leaves them.
+ */
+class PrefixCounts
+{
+public:
+    //! ctr, the counts of @a reg with a margin of @a margin columns.
+    PrefixCounts(Region const & reg, N32 margin)
+    {
+        WinP const & bb = reg.boundingBox();
+        x0_ = bb.upperLeft().x_ - margin;
+        y0_ = bb.upperLeft().y_;
+        height_ = bb.height();
+        stride_ = bb.width() + 2 * margin + 1;
+        counts_.resize(N64(stride_) * height_);
+        Region::RboIterator r = reg.begin();
+        for (N32 y = 0; y < height_; ++y) {
+            N32 * c = &counts_[N64(y) * stride_];
+            N32 x = 0, n = 0;
+            for ( ; r != reg.end() && r->start().y_ == y0_ + y; ++r) {
+                N32 const xs = r->start().x_ - x0_;
+                fill(c + x, c + xs + 1, n);
+                for (N32 k = 1; k <= r->len(); ++k)
+                    c[xs + k] = n + k;
+                n += r->len();
+                x = xs + r->len() + 1;
+            }
+            fill(c + x, c + stride_, n);
+        }
+    }
+
+    //! The counts of row @a y at column 0, null if @a y is outside.
+    N32 const * row(N32 y) const {
+        return y < y0_ || y >= y0_ + height_ ? 0 : &counts_[N64(y - y0_) * stride_] - x0_;
+    }
+
+private:
+    //! the column of the first count
+    N32 x0_;
+    //! the first row
+    N32 y0_;
+    //! the number of rows
+    N32 height_;
+    //! the number of counts per row
+    N32 stride_;
+    //! the counts
+    vector<N32> counts_;
+};
+
+IPL_ANON_NS_END
+
+/*! @internal For every row of the result the runs of @a B which meet a row
+ * of the object are collected. The points, where any of them covers a
+ * pixel, are the union of the runs of the object widened by the runs of
+ * @a B; only these intervals are scanned. At a point with coverage @em c
+ * and @em n runs of @a B, the next <em>ceil((minCount - c) / n)</em>
+ * points miss and the next <em>(c - minCount) / n</em> points hit.
+ */
+Region const
+Region::erodeRank(Region const & B, N32 minCount) const
+{
+    IPLLOG_INFO(IPL_FNC_NAME << " " << minCount << " of " << *this << " by " << B);
+    if (minCount <= 0)
+        throw ParameterError(2, IPL_FNC_NAME);
+    if (this->empty() || B.empty())
+        return *this;
+
+    WinP const & bb = this->boundingBox();
+    WinP const & bbB = B.boundingBox();
+    PrefixCounts const counts(*this, bbB.width());
+    N32 const y0 = bb.upperLeft().y_ - bbB.lowerRight().y_,
+        y1 = bb.lowerRight().y_ - bbB.upperLeft().y_;
+
+    Region res;
+    vector<ActiveRun> active;
+    vector<pair<N32, N32> > candidates;
+    for (N32 y = y0; y <= y1; ++y) {
+        active.clear();
+        candidates.clear();
+        for (RboIterator b = B.begin(); b != B.end(); ++b) {
+            N32 const yb = y + b->start().y_;
+            N32 const * row = counts.row(yb);
+            if (!row)
+                continue;
+            ActiveRun const a = { row + b->start().x_, b->len() };
+            active.push_back(a);
+            pair<RboIterator, RboIterator> const runs =
+                equal_range(this->begin(), this->end(), Rbo(PointN16(0, yb), 1),
+                            [](Rbo const & r, Rbo const & s) {
+                                return r.start().y_ < s.start().y_;
+                            });
+            for (RboIterator r = runs.first; r != runs.second; ++r)
+                candidates.push_back(make_pair(r->start().x_ - b->start().x_ - b->len() + 1,
+                                               r->start().x_ + r->len() - 1 - b->start().x_));
+        }
+        N32 const n = active.size();
+        if (n * N32(bbB.width()) < minCount || candidates.empty())
+            continue;
+        sort(candidates.begin(), candidates.end());
+
+        N32 hitStart = 0, hitEnd = -1; // the current run of the result
+        for (size_t i = 0; i < candidates.size(); ) {
+            N32 const xs = candidates[i].first;
+            N32 xe = candidates[i].second;
+            for (++i; i < candidates.size() && candidates[i].first <= xe + 1; ++i)
+                xe = max(xe, candidates[i].second);
+            for (N32 x = xs; x <= xe; ) {
+                N32 c = 0;
+                for (vector<ActiveRun>::const_iterator a = active.begin(); a != active.end(); ++a)
+                    c += a->counts_[x + a->len_] - a->counts_[x];
+                if (c < minCount) {
+                    x += (minCount - c + n - 1) / n;
+                    continue;
+                }
+                N32 const last = min(xe, x + (c - minCount) / n);
+                if (x != hitEnd + 1) {
+                    if (hitEnd >= hitStart)
+                        res.add(Rbo(PointN16(hitStart, y), hitEnd - hitStart + 1));
+                    hitStart = x;
+                }
+                hitEnd = last;
+                x = last + 1;
+            }
+        }
+        if (hitEnd >= hitStart)
+            res.add(Rbo(PointN16(hitStart, y), hitEnd - hitStart + 1));
+    }
+    IPL_ASSERT_VALID(res);
+    return res;
+}
+
+Region const
+Region::erodePercentile(Region const & B, F64 percent) const
+{
+    if (!(percent > 0 && percent <= 100))
+        throw ParameterError(2, string(IPL_FNC_NAME) + ": percent not in (0, 100]");
+    N32 const minCount = static_cast<N32>(ceil(percent * B.area() / 100 - 1e-9));
+    return this->erodeRank(B, max(minCount, 1));
+}
+
+IPL_NS_END
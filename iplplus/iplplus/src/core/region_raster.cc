@@ -0,0 +1,206 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Conversions of Regions from and to raster buffers
+ *
+ ********************************************************************/
+
+#include "ipl/region.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined IPL_USE_OLD_CV
+#    include <opencv/cv.h>
+#else
+#    include <opencv2/core/core.hpp>
+#endif
+
+#include "ipl/iplerr.hh"
+
+using namespace std;
+
+IPL_NS_BEGIN
+
+IPL_ANON_NS_BEGIN
+
+//! Throws a ParameterError if the size of a buffer is negative.
+void
+checkSize(N32 width, N32 height, char const * fnc)
+{
+    if (width < 0)
+        throw ParameterError(2, fnc);
+    if (height < 0)
+        throw ParameterError(3, fnc);
+}
+
+//! The first Rbo of @a reg in row @a y or below.
+Region::RboIterator
+firstInRow(Region const & reg, N32 y)
+{
+    return lower_bound(reg.begin(), reg.end(), y,
+                       [](Rbo const & r, N32 row) { return r.start().y_ < row; });
+}
+
+//! Sets the bits [@a xs, @a xe) of the packed row @a row.
+inline void
+setBits(UN8 * row, N32 xs, N32 xe)
+{
+    N32 const bs = xs / 8,
+        be = (xe - 1) / 8;
+    UN8 const ms = 0xff >> (xs % 8),
+        me = 0xff << (7 - (xe - 1) % 8);
+    if (bs == be) {
+        row[bs] |= ms & me;
+        return;
+    }
+    row[bs] |= ms;
+    memset(row + bs + 1, 0xff, be - bs - 1);
+    row[be] |= me;
+}
+
+IPL_ANON_NS_END
+
+/*! @internal Each row is passed directly to binarizeRow, the buffer is
+ * never copied.
+ */
+template<typename T>
+Region const
+Region::thresholdBuffer(T const * data, N32 width, N32 height,
+                        std::ptrdiff_t step, N32 lo, N32 hi,
+                        PointN16 const & origin)
+{
+    Region res;
+    if (lo > hi)
+        return res;
+    UN8 const * row = reinterpret_cast<UN8 const *>(data);
+    for (N32 y = 0; y < height; ++y, row += step) {
+        T const * const first = reinterpret_cast<T const *>(row);
+        binarizeRow(first, first + width, lo, hi,
+                    PointN16(origin.x_, origin.y_ + y), res);
+    }
+    IPL_ASSERT_VALID(res);
+    return res;
+}
+
+Region const
+Region::fromBuffer(UN8 const * data, N32 width, N32 height,
+                   std::ptrdiff_t step, N32 lo, N32 hi,
+                   PointN16 const & origin)
+{
+    checkSize(width, height, IPL_FNC_NAME);
+    return thresholdBuffer(data, width, height, step, lo, hi, origin);
+}
+
+Region const
+Region::fromBuffer(N16 const * data, N32 width, N32 height,
+                   std::ptrdiff_t step, N32 lo, N32 hi,
+                   PointN16 const & origin)
+{
+    checkSize(width, height, IPL_FNC_NAME);
+    return thresholdBuffer(data, width, height, step, lo, hi, origin);
+}
+
+Region const
+Region::fromBuffer(UN16 const * data, N32 width, N32 height,
+                   std::ptrdiff_t step, N32 lo, N32 hi,
+                   PointN16 const & origin)
+{
+    checkSize(width, height, IPL_FNC_NAME);
+    return thresholdBuffer(data, width, height, step, lo, hi, origin);
+}
+
+Region const
+Region::fromMat(cv::Mat const & mat, N32 lo, N32 hi, PointN16 const & origin)
+{
+    if (mat.empty())
+        return Region();
+    std::ptrdiff_t const step = mat.step;
+    switch (mat.type()) {
+        case CV_8UC1:
+            return thresholdBuffer(mat.ptr<UN8>(0), mat.cols, mat.rows, step,
+                                   lo, hi, origin);
+        case CV_16SC1:
+            return thresholdBuffer(mat.ptr<N16>(0), mat.cols, mat.rows, step,
+                                   lo, hi, origin);
+        case CV_16UC1:
+            return thresholdBuffer(mat.ptr<UN16>(0), mat.cols, mat.rows, step,
+                                   lo, hi, origin);
+        default:
+            throw ParameterError(1, string(IPL_FNC_NAME) + ": unsupported type");
+    }
+}
+
+/*! @internal The gaps and the runs of each row are written with one memset
+ * each, so every pixel of the buffer is written exactly once.
+ */
+void
+Region::toBuffer(UN8 * data, N32 width, N32 height, std::ptrdiff_t step,
+                 PointN16 const & origin, UN8 fg, UN8 bg) const
+{
+    IPL_ASSERT_VALID(*this);
+    checkSize(width, height, IPL_FNC_NAME);
+    auto r = firstInRow(*this, origin.y_);
+    auto const e = this->end();
+    for (N32 y = 0; y < height; ++y, data += step) {
+        N32 x = 0;
+        for ( ; r != e && r->start().y_ == origin.y_ + y; ++r) {
+            N32 const xs = max<N32>(r->start().x_ - origin.x_, x),
+                xe = min<N32>(r->start().x_ - origin.x_ + r->len(), width);
+            if (xs >= xe)
+                continue;
+            memset(data + x, bg, xs - x);
+            memset(data + xs, fg, xe - xs);
+            x = xe;
+        }
+        memset(data + x, bg, width - x);
+    }
+}
+
+void
+Region::toMat(cv::Mat & mat, PointN16 const & origin, UN8 fg, UN8 bg) const
+{
+    if (mat.type() != CV_8UC1)
+        throw ParameterError(1, string(IPL_FNC_NAME) + ": unsupported type");
+    if (mat.empty())
+        return;
+    this->toBuffer(mat.ptr<UN8>(0), mat.cols, mat.rows, mat.step, origin, fg, bg);
+}
+
+Region const
+Region::fromBits(UN8 const * data, N32 width, N32 height, std::ptrdiff_t step,
+                 PointN16 const & origin)
+{
+    checkSize(width, height, IPL_FNC_NAME);
+    Region res;
+    for (N32 y = 0; y < height; ++y, data += step)
+        unpackRow(data, width, PointN16(origin.x_, origin.y_ + y), res);
+    IPL_ASSERT_VALID(res);
+    return res;
+}
+
+void
+Region::toBits(UN8 * data, N32 width, N32 height, std::ptrdiff_t step,
+               PointN16 const & origin) const
+{
+    IPL_ASSERT_VALID(*this);
+    checkSize(width, height, IPL_FNC_NAME);
+    N32 const rowBytes = (width + 7) / 8;
+    auto r = firstInRow(*this, origin.y_);
+    auto const e = this->end();
+    for (N32 y = 0; y < height; ++y, data += step) {
+        memset(data, 0, rowBytes);
+        for ( ; r != e && r->start().y_ == origin.y_ + y; ++r) {
+            N32 const xs = max<N32>(r->start().x_ - origin.x_, 0),
+                xe = min<N32>(r->start().x_ - origin.x_ + r->len(), width);
+            if (xs < xe)
+                setBits(data, xs, xe);
+        }
+    }
+}
+
+IPL_NS_END
@@ -15,9 +15,8 @@
 #include "ipl/region.hh"
 
 #include <algorithm>
-#include <functional>
+#include <queue>
 #include <vector>
-#include <iterator>
 
 #include "ipl/iplerr.hh"
 
@@ -44,31 +43,113 @@ merge(N32 & xe, Rbo const & r)
     return true;
 }
 
-//! Compare Functor
-struct IterSorter : public binary_function<Region::RboIterator,
-                                           Region::RboIterator,
-                                           bool>
+//! Next Rbo of the row @a y of two Regions.
+/*! @a r and @a s iterate through the Rbo's of the two Regions. Returns the
+ * one with the smaller start point and advances it, or 0 if both Regions
+ * have no more Rbo's in the row @a y.
+ */
+inline Rbo const *
+nextInRow(Region::RboIterator & r, Region::RboIterator rend,
+          Region::RboIterator & s, Region::RboIterator send,
+          N32 y)
+{
+    bool const rin = r != rend && r->start().y_ == y,
+        sin = s != send && s->start().y_ == y;
+    if (rin && (!sin || r->start().x_ <= s->start().x_))
+        return &*r++;
+    if (sin)
+        return &*s++;
+    return 0;
+}
+
+//! The boundaries of the Rbo's in a row.
+/*! Iterates in x-order alternately through the start and the end point of
+ * the Rbo's in the row @a y.
+ */
+class RowBounds
 {
-    //! Compare Operation
-    bool operator()(Region::RboIterator i1,
-                    Region::RboIterator i2) const {
-        return *i1 < *i2;
+public:
+    //! ctr
+    RowBounds(Region::RboIterator & r, Region::RboIterator rend, N32 y)
+        : r_(r), rend_(rend), y_(y), atEnd_(false) {
+    }
+    //! Are there more boundaries in the row?
+    bool valid() const {
+        return r_ != rend_ && r_->start().y_ == y_;
+    }
+    //! The actual boundary.
+    N32 x() const {
+        return atEnd_ ? r_->start().x_ + r_->len() : r_->start().x_;
+    }
+    //! Next boundary.
+    void next() {
+        if (atEnd_)
+            ++r_;
+        atEnd_ = !atEnd_;
+    }
+private:
+    Region::RboIterator & r_;
+    Region::RboIterator const rend_;
+    N32 const y_;
+    bool atEnd_;
+};
+
+//! A Region in a k-way merge.
+/*! Iterates through the Rbo's of a Region. For Region::intersectAll we
+ * iterate through the start and end points of the Rbo's instead, then
+ * @a atEnd tells us which one is the actual.
+ */
+struct MergeCursor {
+    //! ctr
+    explicit MergeCursor(Region const & reg)
+        : r(reg.begin()), rend(reg.end()), atEnd(false) {
+    }
+    //! Row of the actual position.
+    N32 y() const {
+        return r->start().y_;
+    }
+    //! Column of the actual position.
+    N32 x() const {
+        return atEnd ? r->start().x_ + r->len() : r->start().x_;
+    }
+    //! Next boundary of the Rbo's; returns @c false at the end.
+    bool nextBound() {
+        if (atEnd)
+            ++r;
+        atEnd = !atEnd;
+        return r != rend;
+    }
+
+    //! the actual Rbo
+    Region::RboIterator r;
+    //! the end of the Region
+    Region::RboIterator rend;
+    //! the actual position is the end point of @a r
+    bool atEnd;
+};
+
+//! Heap order: the cursor with the smallest position is on the top.
+struct MergeLater {
+    //! call-operator
+    bool operator()(MergeCursor const & a, MergeCursor const & b) const {
+        return a.y() > b.y() || (a.y() == b.y() && a.x() > b.x());
     }
 };
+
+//! Heap of the cursors of a k-way merge.
+typedef priority_queue<MergeCursor, vector<MergeCursor>, MergeLater> MergeHeap;
+
 IPL_ANON_NS_END
 
 /*!
- * @todo Optimize, avoid the temporary vectors.
- *
  * @internal Iterate simultaneously through the Rbo's of the first Region (@a r)
  * and the second Region(@a s). Because the Rbo's are sorted row-wise, we can:
- * - Add all Rbo's from the upper part, that belongs only to one of the two regions.
  * - If in a certain row we have only rbos from @a r or @a s, add those Rbo's.
- * - Find all Rbos of a row @a iters1 for the first Region and @a iters2 for the
- *   second, store both sets sorted in a vector @a itersMerged. Build the compactification
- *   of these Rbos (merge if there are overlapping Rbo's) and add these Rbos to
- *   the result.
- * - Process the remaining lower part as the upper part.
+ * - In a row of both Regions take the Rbo's of both Regions in the order of
+ *   their start points (nextInRow) and build the compactification of these
+ *   Rbos (merge if there are overlapping Rbo's).
+ *
+ * The result has at most as many Rbo's as the two Regions together.
  */
 Region const
 Region::unions(Region const & other) const
@@ -82,24 +163,18 @@ Region::unions(Region const & other) const
     if (other.empty())
         return *this;
 
-    vector<RboIterator> iters1, iters2, itersMerged;
-
     Region reg;
-    auto r = this->begin(),
-        s = other.begin(),
-        rend = this->end(),
-        send = other.end();
+    reg.rbos_.reserve(this->nrRbos() + other.nrRbos());
+    unionRange(this->begin(), this->end(), other.begin(), other.end(), reg);
+    IPL_ASSERT_VALID(reg);
+    return reg;
+}
 
-    if (*s < *r) {
-        swap(r,s), swap(rend,send);
-    }
-    IPL_ASSERT(r != rend && s != send);
-    N32 const y = s->start().y_;
-    while (r != rend && r->start().y_ < y) { // upper part
-        reg.add(*r);
-        ++r;
-    }
-    IPL_ASSERT(r == rend || r->start().y_ >= s->start().y_);
+void
+Region::unionRange(RboIterator r, RboIterator rend,
+                   RboIterator s, RboIterator send,
+                   Region & reg)
+{
     while (r != rend && s != send) {
         if (r->start().y_ < s->start().y_) {
             reg.add(*r);
@@ -108,94 +183,31 @@ Region::unions(Region const & other) const
             reg.add(*s);
             ++s;
         } else {
-            iters1.clear();
-            iters2.clear();
-            itersMerged.clear();
             N32 const y = r->start().y_;
-            IPL_ASSERT(s->start().y_ == y);
-            do {
-                iters1.push_back(r);
-            } while (++r != rend && r->start().y_ == y);
-            do {
-                iters2.push_back(s);
-            } while (++s != send && s->start().y_ == y);
-            IPL_ASSERT(!iters1.empty());
-            IPL_ASSERT(!iters2.empty());
-            merge(iters1.begin(), iters1.end(), iters2.begin(), iters2.end(),
-                  back_inserter(itersMerged), IterSorter());
-            IPL_ASSERT(itersMerged.size() > 1);
-
-            auto t = itersMerged.begin(),
-                te = itersMerged.end();
-            IPL_ASSERT(t != te);
-            while (t != te) {
-                N32 xs = (*t)->start().x_,
-                    xe = xs + (*t)->len();
-                ++t;
-                while (t != te && merge(xe, **t))
-                    ++t;
+            Rbo const * t = nextInRow(r, rend, s, send, y);
+            IPL_ASSERT(t);
+            while (t) {
+                N32 const xs = t->start().x_;
+                N32 xe = xs + t->len();
+                while ((t = nextInRow(r, rend, s, send, y)) && merge(xe, *t))
+                    ;
                 reg.add(Rbo(PointN16(xs,y), xe-xs));
             }
         }
     }
     IPL_ASSERT(r == rend || s == send);
     // lower part
-    while (r != rend) {
-        reg.add(*r);
-        ++r;
-    }
-    while (s != send) {
-        reg.add(*s);
-        ++s;
-    }
-    IPL_ASSERT_VALID(reg);
-    return reg;
+    reg.rbos_.insert(reg.rbos_.end(), r, rend);
+    reg.rbos_.insert(reg.rbos_.end(), s, send);
 }
 
-IPL_ANON_NS_BEGIN
-
-//! Intesection of two Rbos.
-/*! Intersect a Rbo with end point @a xe and a Rbo @a r.
- * We don't need the start point of the first Rbo, but assume, that it is smaller
- * than the end point of the second Rbo. Additionally we update the end point
- * @a xe such that we can reuse it in the next iteration.
- * @sa Region::intersect
- * @return Length of the intersection or -1 if the two Rbo's are disjunct.
- */
-inline N32
-intersection(N32 & xe, Rbo const & r)
-{
-    N32 xs = r.start().x_;
-    N32 len = r.len();
-    N32 xt = xs + len;
-
-    if (xe <= xs) {
-        xe = r.start().x_ + r.len();
-        return -1;
-    }
-    if (xe < xt) {
-        len = xe - r.start().x_;
-        xe = r.start().x_ + r.len();
-    }
-    return len;
-}
-
-IPL_ANON_NS_END
-
-/*! @internal The procedure is the same as in Region::unions, but for two Rbo's
- * in the same row we do not merge, but insert the intersection of the Rbo's.
- *
- * Only rows where both Regions have Rbo's must be considered. For such rows
- * we store the Rbo's sorted in a temporary vector and intersect adjacent elements.
- * We store the end point of the first Rbo in @a xe and check the next Rbo:
- * - if the Rbo has now intersection with the previous one, update @a xe as end
- *   point of the actual Rbo.
- * - if the Rbo is contained in the previous, add it to the resulting set.
- * - else the two Rbo's overlapp. Add the overlapp to the resulting set and update
- *   @a xe to the end point of the actual Rbo.
- * - Repeat this for all Rbo's.
+/*! @internal The procedure is the same as in Region::unions, but only rows
+ * where both Regions have Rbo's must be considered. In such a row we take the
+ * actual Rbo's @a r and @a s of both Regions, add their overlapp to the
+ * result and advance the one which ends first, because it can't overlapp any
+ * further Rbo of the other Region.
  *
- * @todo Optimize, avoid the temporary vector.
+ * The result has less Rbo's than the two Regions together.
  */
 Region const
 Region::intersect(Region const & other) const
@@ -216,52 +228,74 @@ Region::intersect(Region const & other) const
         || lr1.y_ < ul2.y_ || lr2.y_ < ul1.y_)
         return Region();
 
-    vector<RboIterator> iters1, iters2, itersMerged;
     Region reg;
-    auto r = this->begin(),
-        s = other.begin(),
-        rend = this->end(),
-        send = other.end();
-    if (*s < *r) {
-        swap(r, s), swap(rend, send);
-    }
-    IPL_ASSERT(r != rend && s != send);
-    N32 const y = s->start().y_;
-    while (r != rend && r->start().y_ < y)
-        ++r;
+    reg.rbos_.reserve(this->nrRbos() + other.nrRbos());
+    intersectRange(this->begin(), this->end(), other.begin(), other.end(), reg);
+    IPL_ASSERT_VALID(reg);
+    IPLLOG_INFO(IPL_FNC_NAME << ": -> " << reg);
+    return reg;
+}
+
+void
+Region::intersectRange(RboIterator r, RboIterator rend,
+                       RboIterator s, RboIterator send,
+                       Region & reg)
+{
     while (r != rend && s != send) {
         if (r->start().y_ < s->start().y_)
             ++r;
         else if (s->start().y_ < r->start().y_)
             ++s;
         else {
-            iters1.clear();
-            iters2.clear();
-            itersMerged.clear();
-            N32 const y = r->start().y_;
-            IPL_ASSERT(y == s->start().y_);
-            IPL_ASSERT(r != rend && s != send);
-            do {
-                iters1.push_back(r);
-            } while (++r != rend && y == r->start().y_);
-            do {
-                iters2.push_back(s);
-            } while (++s != send && y == s->start().y_);
-            IPL_ASSERT(!iters1.empty() && !iters2.empty());
-            merge(iters1.begin(), iters1.end(), iters2.begin(), iters2.end(),
-                  back_inserter(itersMerged), IterSorter());
-            IPL_ASSERT(itersMerged.size() > 1);
-
-            auto t = itersMerged.begin(),
-                te = itersMerged.end();
-            N32 xe = (*t)->start().x_ + (*t)->len();
-            ++t;
-            do {
-                N32 len = intersection(xe, **t);
-                if (len > 0)
-                    reg.add(Rbo((*t)->start(), len));
-            } while(++t != te);
+            N32 const re = r->start().x_ + r->len(),
+                se = s->start().x_ + s->len(),
+                xs = std::max(r->start().x_, s->start().x_),
+                xe = std::min(re, se);
+            if (xe > xs)
+                reg.add(Rbo(PointN16(xs, r->start().y_), xe-xs));
+            if (re < se)
+                ++r;
+            else
+                ++s;
+        }
+    }
+}
+
+/*!
+ * @internal We walk through the Rbo's of the object and cut out the Rbo's
+ * of @a other in the same row. @a s is the first Rbo of @a other, which may
+ * overlapp the actual or a later Rbo @a r. A Rbo of @a other overlapping
+ * several Rbo's of the object is visited once for each of them.
+ */
+Region const
+Region::subtract(Region const & other) const
+{
+    IPLLOG_INFO(IPL_FNC_NAME << ": " << *this << " and " << other);
+    IPL_ASSERT_VALID(*this);
+    IPL_ASSERT_VALID(other);
+    if (this->empty() || other.empty()) {
+        return *this;
+    }
+
+    Region reg;
+    reg.rbos_.reserve(this->nrRbos() + other.nrRbos());
+    auto s = other.begin();
+    auto const send = other.end();
+    for (auto r = this->begin(); r != this->end(); ++r) {
+        N32 const y = r->start().y_,
+            xe = r->start().x_ + r->len();
+        N32 xs = r->start().x_;
+        while (s != send
+               && (s->start().y_ < y
+                   || (s->start().y_ == y && s->start().x_ + s->len() <= xs)))
+            ++s;
+        for (auto t = s; t != send && t->start().y_ == y && t->start().x_ < xe; ++t) {
+            if (t->start().x_ > xs)
+                reg.add(Rbo(PointN16(xs, y), t->start().x_ - xs));
+            xs = std::max<N32>(xs, t->start().x_ + t->len());
         }
+        if (xe > xs)
+            reg.add(Rbo(PointN16(xs, y), xe - xs));
     }
     IPL_ASSERT_VALID(reg);
     IPLLOG_INFO(IPL_FNC_NAME << ": -> " << reg);
@@ -269,34 +303,164 @@ Region::intersect(Region const & other) const
 }
 
 /*!
- * @internal A-B is A intersect (Complement B)
- * @todo optimize, implement it dircetely.
+ * @internal As in Region::unions rows of only one Region are copied. In a
+ * row of both Regions we iterate through the start and end points of the
+ * Rbo's of both Regions in x-order (RowBounds). Every boundary flips the
+ * membership to exactly one of the Regions, so we start a Rbo at every second
+ * boundary and end it at the next.
  */
 Region const
-Region::subtract(Region const & other) const
+Region::symmetricDifference(Region const & other) const
 {
     IPLLOG_INFO(IPL_FNC_NAME << ": " << *this << " and " << other);
     IPL_ASSERT_VALID(*this);
     IPL_ASSERT_VALID(other);
-    if (this->empty() || other.empty()) {
+
+    if (this->empty())
+        return other;
+    if (other.empty())
         return *this;
+
+    Region reg;
+    reg.rbos_.reserve(2*(this->nrRbos() + other.nrRbos()));
+    auto r = this->begin(),
+        s = other.begin(),
+        rend = this->end(),
+        send = other.end();
+
+    while (r != rend && s != send) {
+        if (r->start().y_ < s->start().y_) {
+            reg.add(*r);
+            ++r;
+        } else if (s->start().y_ < r->start().y_) {
+            reg.add(*s);
+            ++s;
+        } else {
+            N32 const y = r->start().y_;
+            RowBounds a(r, rend, y), b(s, send, y);
+            bool inside = false;
+            N32 xs = 0;
+            while (a.valid() || b.valid()) {
+                N32 const x = !b.valid() || (a.valid() && a.x() <= b.x())
+                    ? a.x() : b.x();
+                bool flip = false;
+                for ( ; a.valid() && a.x() == x; a.next())
+                    flip = !flip;
+                for ( ; b.valid() && b.x() == x; b.next())
+                    flip = !flip;
+                if (!flip)
+                    continue;
+                if (inside)
+                    reg.add(Rbo(PointN16(xs, y), x - xs));
+                else
+                    xs = x;
+                inside = !inside;
+            }
+            IPL_ASSERT(!inside);
+        }
     }
-    WinP const & b1 = this->boundingBox();
-    WinP const & b2 = other.boundingBox();
-    WinP univ(std::min(b1.upperLeft().x_, b2.upperLeft().x_),
-              std::min(b1.upperLeft().y_, b2.upperLeft().y_),
-              std::max(b1.lowerRight().x_, b2.lowerRight().x_),
-              std::max(b1.lowerRight().y_, b2.lowerRight().y_));
-
-    return this->intersect(other.complement(&univ));
+    IPL_ASSERT(r == rend || s == send);
+    // lower part
+    reg.rbos_.insert(reg.rbos_.end(), r, rend);
+    reg.rbos_.insert(reg.rbos_.end(), s, send);
+    IPL_ASSERT_VALID(reg);
+    return reg;
 }
 
 
 /*!
- * @internal Iterate over all rows of the universe and cut ot the Rbo's of the
- * Region.
- *
- * @todo Optimize, avoid the temporary Region.
+ * @internal The heap yields the Rbo's of all Regions sorted as one Region.
+ * As in Region::unions we merge each one with the actual Rbo, if they overlapp
+ * or touch, else we add the actual Rbo to the result and start a new one.
+ */
+Region const
+Region::unionAll(std::vector<Region const *> const & regs)
+{
+    IPLLOG_INFO(IPL_FNC_NAME << ": " << regs.size() << " regions");
+    MergeHeap heap;
+    size_t nr = 0;
+    for (auto reg : regs) {
+        IPL_ASSERT_VALID(*reg);
+        if (!reg->empty()) {
+            heap.push(MergeCursor(*reg));
+            nr += reg->nrRbos();
+        }
+    }
+
+    Region res;
+    res.rbos_.reserve(nr);
+    if (heap.empty())
+        return res;
+
+    N32 y = heap.top().y(),
+        xs = heap.top().x(),
+        xe = xs;
+    while (!heap.empty()) {
+        MergeCursor c = heap.top();
+        heap.pop();
+        if (c.y() != y || !merge(xe, *c.r)) {
+            res.add(Rbo(PointN16(xs, y), xe-xs));
+            y = c.y();
+            xs = c.x();
+            xe = xs + c.r->len();
+        }
+        if (++c.r != c.rend)
+            heap.push(c);
+    }
+    res.add(Rbo(PointN16(xs, y), xe-xs));
+    IPL_ASSERT_VALID(res);
+    return res;
+}
+
+/*!
+ * @internal The heap yields the start and end points of the Rbo's of all
+ * Regions in x-order. Since the Rbo's of each Region are disjunct, a point is
+ * in the intersection iff it is covered by as many Rbo's as there are Regions.
+ * We count the covering Rbo's and add a Rbo to the result for every
+ * interval where the count equals the number of Regions. All boundaries at
+ * the same position are processed together, such that we never produce
+ * touching Rbo's.
+ */
+Region const
+Region::intersectAll(std::vector<Region const *> const & regs)
+{
+    IPLLOG_INFO(IPL_FNC_NAME << ": " << regs.size() << " regions");
+    Region res;
+    MergeHeap heap;
+    for (auto reg : regs) {
+        IPL_ASSERT_VALID(*reg);
+        if (reg->empty())
+            return res;
+        heap.push(MergeCursor(*reg));
+    }
+
+    N32 const all = regs.size();
+    N32 cover = 0,
+        xs = 0;
+    while (!heap.empty()) {
+        N32 const y = heap.top().y(),
+            x = heap.top().x(),
+            before = cover;
+        while (!heap.empty() && heap.top().y() == y && heap.top().x() == x) {
+            MergeCursor c = heap.top();
+            heap.pop();
+            cover += c.atEnd ? -1 : 1;
+            if (c.nextBound())
+                heap.push(c);
+        }
+        if (before < all && cover == all)
+            xs = x;
+        else if (before == all && cover < all)
+            res.add(Rbo(PointN16(xs, y), x-xs));
+    }
+    IPL_ASSERT(cover == 0);
+    IPL_ASSERT_VALID(res);
+    return res;
+}
+
+/*!
+ * @internal Iterate over all rows of the universe and cut out the Rbo's of the
+ * Region. The Rbo's are clipped to the universe on the fly.
  */
 Region const
 Region::complement(WinP const * universe /*= 0*/) const
@@ -318,57 +482,141 @@ Region::complement(WinP const * universe /*= 0*/) const
             return Region(*universe);
     }
 
-    Region tmp(*this);
     if (!universe)
         universe = &this->boundingBox();
-    else
-        tmp.clip(*universe);
 
     Region reg;
-    auto r = tmp.begin();
-    auto const re = tmp.end();
-
-    PointN16 pt = universe->upperLeft();
-    PointN16 const inc = PointN16(0,1);
-    N32 const ye = universe->lowerRight().y_,
-        wlen = universe->lowerRight().x_ - universe->upperLeft().x_ + 1;
-
-    if (r != re) {
-        N32 const ry = r->start().y_;
-        while (pt.y_ <= ye && pt.y_ < ry) {
-            reg.add(Rbo(pt, wlen));
-            pt += inc;
+    reg.rbos_.reserve(this->nrRbos() + max<N32>(universe->height(), 0));
+    complementRange(this->begin(), this->end(), *universe, reg);
+    IPLLOG_INFO(IPL_FNC_NAME << ": -> " << reg);
+    IPL_ASSERT_VALID(reg);
+    return reg;
+}
+
+void
+Region::complementRange(RboIterator r, RboIterator re,
+                        WinP const & universe,
+                        Region & reg)
+{
+    N32 const x0 = universe.upperLeft().x_,
+        y0 = universe.upperLeft().y_,
+        x1 = universe.lowerRight().x_ + 1,
+        y1 = universe.lowerRight().y_;
+
+    while (r != re && r->start().y_ < y0)
+        ++r;
+    for (N32 y = y0; y <= y1; ++y) {
+        N32 xs = x0;
+        for ( ; r != re && r->start().y_ == y; ++r) {
+            N32 const rs = max<N32>(r->start().x_, x0),
+                rt = min<N32>(r->start().x_ + r->len(), x1);
+            if (rt <= rs) // outside of the universe
+                continue;
+            if (rs > xs)
+                reg.add(Rbo(PointN16(xs, y), rs - xs));
+            xs = rt;
         }
+        if (x1 > xs)
+            reg.add(Rbo(PointN16(xs, y), x1 - xs));
+    }
+}
+
+IPL_ANON_NS_BEGIN
+
+//! Areas of two Regions and of their intersection.
+struct Areas {
+    //! ctr
+    Areas() : first(0), second(0), both(0) {
     }
-    while (pt.y_ <= ye && r != re) {
-        N32 const ry = pt.y_;
-        IPL_ASSERT(ry <= r->start().y_);
-        if (pt.y_ == r->start().y_) {
-            N32 xs = pt.x_;
-            N32 len = r->start().x_ - xs;
+    //! area of the first Region
+    N32 first;
+    //! area of the second Region
+    N32 second;
+    //! area of the intersection
+    N32 both;
+};
+
+//! Compute the areas of @a a, @a b and of their intersection.
+/*! Iterate simultaneously through the Rbo's of both Regions. In a common row
+ * we advance the Rbo which ends first, because it can't overlap any further
+ * Rbo of the other Region.
+ */
+Areas
+areas(Region const & a, Region const & b)
+{
+    Areas ar;
+    auto r = a.begin(),
+        s = b.begin(),
+        rend = a.end(),
+        send = b.end();
+    while (r != rend && s != send) {
+        if (r->start().y_ < s->start().y_) {
+            ar.first += r->len();
+            ++r;
+        } else if (s->start().y_ < r->start().y_) {
+            ar.second += s->len();
+            ++s;
+        } else {
+            N32 const re = r->start().x_ + r->len(),
+                se = s->start().x_ + s->len(),
+                len = std::min(re, se)
+                    - std::max<N32>(r->start().x_, s->start().x_);
             if (len > 0)
-                reg.add(Rbo(pt, len));
-            xs = r->start().x_ + r->len();
-            while (++r != re && r->start().y_ == pt.y_) {
-                len = r->start().x_ - xs;
-                reg.add(Rbo(PointN16(xs, ry), len));
-                xs = r->start().x_ + r->len();
+                ar.both += len;
+            if (re < se) {
+                ar.first += r->len();
+                ++r;
+            } else {
+                ar.second += s->len();
+                ++s;
             }
-            len = pt.x_ + wlen - xs;
-            if (len > 0)
-                reg.add(Rbo(PointN16(xs, ry), len));
-        } else {
-                reg.add(Rbo(pt, wlen));
         }
-        pt += inc;
-    }
-    while (pt.y_ <= ye) {
-        reg.add(Rbo(pt, wlen));
-        pt += inc;
     }
-    IPLLOG_INFO(IPL_FNC_NAME << ": -> " << reg);
-    IPL_ASSERT_VALID(reg);
-    return reg;
+    for ( ; r != rend; ++r)
+        ar.first += r->len();
+    for ( ; s != send; ++s)
+        ar.second += s->len();
+    return ar;
+}
+
+IPL_ANON_NS_END
+
+N32
+Region::intersectArea(Region const & other) const
+{
+    IPL_ASSERT_VALID(*this);
+    IPL_ASSERT_VALID(other);
+    return areas(*this, other).both;
+}
+
+N32
+Region::unionArea(Region const & other) const
+{
+    IPL_ASSERT_VALID(*this);
+    IPL_ASSERT_VALID(other);
+    Areas const ar = areas(*this, other);
+    return ar.first + ar.second - ar.both;
+}
+
+N32
+Region::xorArea(Region const & other) const
+{
+    IPL_ASSERT_VALID(*this);
+    IPL_ASSERT_VALID(other);
+    Areas const ar = areas(*this, other);
+    return ar.first + ar.second - 2*ar.both;
+}
+
+F64
+Region::iou(Region const & other) const
+{
+    IPL_ASSERT_VALID(*this);
+    IPL_ASSERT_VALID(other);
+    Areas const ar = areas(*this, other);
+    N32 const un = ar.first + ar.second - ar.both;
+    if (un == 0)
+        return 0.0;
+    return static_cast<F64>(ar.both) / un;
 }
 
 IPL_NS_END
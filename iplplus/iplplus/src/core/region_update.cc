@@ -0,0 +1,186 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  incremental update of morphological operations
+ *
+ ********************************************************************/
+
+#include "ipl/region.hh"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+IPL_NS_BEGIN
+
+IPL_ANON_NS_BEGIN
+
+//! A closed range of rows.
+typedef pair<N32, N32> RowBand;
+
+//! Functor to find the first Rbo in a row.
+struct RowBefore {
+    //! call-operator
+    bool operator()(Rbo const & r, N32 y) const {
+        return r.start().y_ < y;
+    }
+};
+
+//! First Rbo of @a reg in row @a y or behind.
+inline Region::RboIterator
+rowBegin(Region const & reg, N32 y)
+{
+    return lower_bound(reg.begin(), reg.end(), y, RowBefore());
+}
+
+//! Run-level diff.
+/*! Walks simultaneously through the Rbos of @a a and @a b and appends every
+ * row, where the two Regions differ, to @a rows. The rows are sorted.
+ */
+void
+changedRows(Region const & a, Region const & b, vector<N32> & rows)
+{
+    auto r = a.begin(), re = a.end();
+    auto s = b.begin(), se = b.end();
+    while (r != re || s != se) {
+        N32 const y = (s == se || (r != re && r->start().y_ < s->start().y_))
+            ? r->start().y_ : s->start().y_;
+        bool same = true;
+        while (r != re && s != se
+               && r->start().y_ == y && s->start().y_ == y) {
+            same = same && *r == *s;
+            ++r, ++s;
+        }
+        // Rbos left in this row in only one of the Regions
+        while (r != re && r->start().y_ == y) {
+            same = false;
+            ++r;
+        }
+        while (s != se && s->start().y_ == y) {
+            same = false;
+            ++s;
+        }
+        if (!same)
+            rows.push_back(y);
+    }
+}
+
+//! Result rows affected by the changed input rows @a rows.
+/*! A result row @em y depends on the input rows [@em y + @a lo,
+ * @em y + @a hi]. Collect the affected result rows as sorted, disjoint bands.
+ */
+void
+affectedBands(vector<N32> const & rows, N32 lo, N32 hi, vector<RowBand> & bands)
+{
+    for (auto c : rows) {
+        N32 const y0 = c - hi,
+            y1 = c - lo;
+        if (!bands.empty() && y0 <= bands.back().second + 1)
+            bands.back().second = max(bands.back().second, y1);
+        else
+            bands.push_back(RowBand(y0, y1));
+    }
+}
+
+//! Copy of all Rbos of @a reg in the rows [@a y0, @a y1].
+Region const
+rowSlice(Region const & reg, N32 y0, N32 y1)
+{
+    Region slice;
+    for (auto r = rowBegin(reg, y0);
+         r != reg.end() && r->start().y_ <= y1;
+         ++r)
+        slice.add(*r);
+    return slice;
+}
+
+//! The morphological operations with an update.
+typedef Region const (Region::*MorphOp)(Region const &) const;
+
+//! Implementation of erode2cutUpdate and dilatecutUpdate.
+/*! A result row @em y of @a op depends on the input rows [@em y + @a lo,
+ * @em y + @a hi]. Recompute the result only in the bands affected by a change
+ * of the input and take all the other rows from @a prevRes.
+ */
+Region const
+updateMorph(Region const & X, Region const & B,
+            Region const & prevX, Region const & prevRes,
+            MorphOp op, N32 lo, N32 hi)
+{
+    vector<N32> rows;
+    changedRows(X, prevX, rows);
+    if (rows.empty())
+        return prevRes;
+
+    vector<RowBand> bands;
+    affectedBands(rows, lo, hi, bands);
+
+    Region res;
+    auto p = prevRes.begin();
+    auto const pe = prevRes.end();
+    for (auto & b : bands) {
+        while (p != pe && p->start().y_ < b.first)
+            res.add(*p++);
+        while (p != pe && p->start().y_ <= b.second)
+            ++p;
+        Region const part = (rowSlice(X, b.first + lo, b.second + hi).*op)(B);
+        for (auto r = rowBegin(part, b.first);
+             r != part.end() && r->start().y_ <= b.second;
+             ++r)
+            res.add(*r);
+    }
+    while (p != pe)
+        res.add(*p++);
+    IPL_ASSERT_VALID(res);
+    return res;
+}
+
+IPL_ANON_NS_END
+
+/*! @internal The result row @em y of the erosion depends on the input rows
+ * @em y + @em dy, where @em dy runs through the rows of @em B.
+ */
+Region const
+Region::erode2cutUpdate(Region const & B,
+                        Region const & prevX,
+                        Region const & prevEroded) const
+{
+    IPLLOG_INFO(IPL_FNC_NAME << ": " << *this << " with previous " << prevX);
+    IPL_ASSERT_VALID(*this);
+    IPL_ASSERT_VALID(prevX);
+    IPL_ASSERT_VALID(prevEroded);
+    if (B.empty()) {
+        return *this;
+    }
+    WinP const & bb = B.boundingBox();
+    return updateMorph(*this, B, prevX, prevEroded, &Region::erode2cut,
+                       bb.upperLeft().y_, bb.lowerRight().y_);
+}
+
+/*! @internal The result row @em y of the dilation depends on the input rows
+ * @em y - @em dy, where @em dy runs through the rows of @em B.
+ */
+Region const
+Region::dilatecutUpdate(Region const & B,
+                        Region const & prevX,
+                        Region const & prevDilated) const
+{
+    IPLLOG_INFO(IPL_FNC_NAME << ": " << *this << " with previous " << prevX);
+    IPL_ASSERT_VALID(*this);
+    IPL_ASSERT_VALID(prevX);
+    IPL_ASSERT_VALID(prevDilated);
+    if (B.empty()) {
+        return *this;
+    }
+    WinP const & bb = B.boundingBox();
+    return updateMorph(*this, B, prevX, prevDilated, &Region::dilatecut,
+                       -bb.lowerRight().y_, -bb.upperLeft().y_);
+}
+
+IPL_NS_END
@@ -15,6 +15,7 @@
 #include "ipl/board.hh"
 
 #include "ipl/polygon.hh"
+#include "ipl/blobs.hh"
 
 IPL_NS_BEGIN
 
@@ -109,6 +110,12 @@ Board::drawMarkerXy(F64 x, F64 y, MarkerStyle style)
     }
 }
 
+void
+Board::drawBlobs(Blobs const & blobs)
+{
+    this->drawRegions(blobs.begin(), blobs.end(), true);
+}
+
 
 /*************************************************************************/
 
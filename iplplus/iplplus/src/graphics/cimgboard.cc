@@ -27,6 +27,7 @@
 #include "ipl/range.hh"
 #include "ipl/trafo2d.hh"
 #include "ipl/region.hh"
+#include "ipl/blobs.hh"
 
 using namespace cimg_library;
 
@@ -227,6 +228,24 @@ CImgBoard::inputRect(Rect & rect)
     return ok;
 }
 
+void
+CImgBoard::blobInfo(Blobs const & blobs,
+                    std::function<void (Region const & r)> cb)
+{
+    PointN16 pt;
+    while (this->inputPoint(pt)) {
+        N32 const i = blobs.find(pt);
+        if (i < 0) {
+            continue;
+        }
+        if (cb) {
+            cb(blobs[i]);
+        } else {
+            std::cout << "blob " << i << ": " << blobs[i] << std::endl;
+        }
+    }
+}
+
 
 void
 CImgBoard::drawPointXy(F64 x, F64 y)
@@ -0,0 +1,491 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Unittest for the creation of Regions from images
+ *
+ ********************************************************************/
+
+#include "config.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include <fstream>
+#include <vector>
+#include <map>
+#include <string>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/XmlOutputter.h>
+
+#include "ipl/region.hh"
+#include "ipl/pict.hh"
+#include "ipl/circle.hh"
+#include "ipl/executor.hh"
+#include "ipl/iplerr.hh"
+
+#if defined(IPL_HAVE_TIFF)
+#    include <tiffio.h>
+#endif
+
+#if defined IPL_USE_OLD_CV
+#    include <opencv/cv.h>
+#else
+#    include <opencv2/core/core.hpp>
+#endif
+
+using namespace ipl;
+using namespace std;
+
+class RegionCreateTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(RegionCreateTest);
+    CPPUNIT_TEST(testBinarizeUN8);
+    CPPUNIT_TEST(testBinarizeN16);
+    CPPUNIT_TEST(testEmptyRange);
+    CPPUNIT_TEST(testThresholds);
+    CPPUNIT_TEST(testLabels);
+    CPPUNIT_TEST(testParallelBinarize);
+    CPPUNIT_TEST(testFromFile);
+    CPPUNIT_TEST(testBilevelCodes);
+    CPPUNIT_TEST(testRasterBuffers);
+    CPPUNIT_TEST_SUITE_END();
+public:
+    void setUp();
+    void testBinarizeUN8();
+    void testBinarizeN16();
+    void testEmptyRange();
+    void testThresholds();
+    void testLabels();
+    void testParallelBinarize();
+    void testFromFile();
+    void testBilevelCodes();
+    void testRasterBuffers();
+};
+
+IPL_ANON_NS_BEGIN
+
+//! number of test iterations
+int const testIterations = 20;
+
+//! Image with random blocks of random values in [@a lo, @a hi].
+/*! The width is not a multiple of the SIMD width, such that the scalar
+ * tail is tested, too.
+ */
+template<typename T>
+PictImg<T>
+randomImage(N32 lo, N32 hi,
+            N16 width = rand()%200 + 1, N16 height = rand()%50 + 1)
+{
+    PictImg<T> img(width, height);
+    for (N16 y = 0; y < img.height(); ++y) {
+        N16 x = 0;
+        while (x < img.width()) {
+            T const v = static_cast<T>(lo + rand()%(hi - lo + 1));
+            for (N32 n = rand()%40 + 1; n > 0 && x < img.width(); --n, ++x)
+                img(x, y) = v;
+        }
+    }
+    return img;
+}
+
+//! Binarization pixel by pixel.
+template<typename T>
+bool
+sameAsBinarization(Region const & reg, PictImg<T> const & img, N32 lo, N32 hi)
+{
+    for (N16 y = 0; y < img.height(); ++y)
+        for (N16 x = 0; x < img.width(); ++x) {
+            PointN16 const pt(x, y);
+            bool const in = img.roi().includes(pt)
+                && img(pt) >= lo && img(pt) <= hi;
+            if (in != reg.includes(pt))
+                return false;
+        }
+    return reg.validate();
+}
+
+#if defined(IPL_HAVE_TIFF)
+//! Writes the pixels of @a reg in [0, @a width) x [0, @a height) with libtiff.
+/*! The rows are packed pixel by pixel and compressed by libtiff with
+ * @a compression, so the file doesn't depend on the codecs of the Region.
+ */
+void
+writeTiffScanlines(Region const & reg, string const & fn, N32 width, N32 height,
+                   UN16 compression)
+{
+    TIFF * tif = TIFFOpen(fn.c_str(), "w");
+    CPPUNIT_ASSERT(tif);
+    TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, UN32(width));
+    TIFFSetField(tif, TIFFTAG_IMAGELENGTH, UN32(height));
+    TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, 1);
+    TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, 1);
+    TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_MINISBLACK);
+    TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+    TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, UN32(height));
+    TIFFSetField(tif, TIFFTAG_COMPRESSION, compression);
+    vector<UN8> row((width + 7) / 8);
+    for (N32 y = 0; y < height; ++y) {
+        fill(row.begin(), row.end(), 0);
+        for (N32 x = 0; x < width; ++x)
+            if (reg.includes(PointN16(x, y)))
+                row[x / 8] |= 0x80 >> x % 8;
+        CPPUNIT_ASSERT(TIFFWriteScanline(tif, &row[0], y, 0) >= 0);
+    }
+    TIFFClose(tif);
+}
+
+//! Check that libtiff decodes the file @a fn to the pixels of @a reg.
+bool
+sameTiffScanlines(Region const & reg, string const & fn, N32 width, N32 height)
+{
+    TIFF * tif = TIFFOpen(fn.c_str(), "r");
+    if (!tif)
+        return false;
+    vector<UN8> row(TIFFScanlineSize(tif));
+    bool same = row.size() == size_t((width + 7) / 8);
+    for (N32 y = 0; same && y < height; ++y) {
+        same = TIFFReadScanline(tif, &row[0], y, 0) >= 0;
+        for (N32 x = 0; same && x < width; ++x)
+            same = reg.includes(PointN16(x, y)) == bool(row[x / 8] & 0x80 >> x % 8);
+    }
+    TIFFClose(tif);
+    return same;
+}
+#endif
+
+IPL_ANON_NS_END
+
+void
+RegionCreateTest::setUp()
+{
+    srand(time(NULL));
+}
+
+void
+RegionCreateTest::testBinarizeUN8()
+{
+    for (int i = 0; i < testIterations; ++i) {
+        PictImg<UN8> img = randomImage<UN8>(0, 255);
+        N32 const lo = rand()%300 - 20,
+            hi = lo + rand()%100;
+        CPPUNIT_ASSERT(sameAsBinarization(Region(img, lo, hi), img, lo, hi));
+        CPPUNIT_ASSERT(sameAsBinarization(Region(img, 0, 255), img, 0, 255));
+
+        img.setRoi(Region(Circle(PointF64(img.width()/2, img.height()/2),
+                                 img.width()/3 + 1)).clip(img.fullRoi()));
+        CPPUNIT_ASSERT(sameAsBinarization(Region(img, lo, hi), img, lo, hi));
+    }
+}
+
+void
+RegionCreateTest::testBinarizeN16()
+{
+    for (int i = 0; i < testIterations; ++i) {
+        PictImg<N16> img = randomImage<N16>(-32768, 32767);
+        N32 const lo = rand()%70000 - 35000,
+            hi = lo + rand()%20000;
+        CPPUNIT_ASSERT(sameAsBinarization(Region(img, lo, hi), img, lo, hi));
+
+        img.setRoi(Region(Circle(PointF64(img.width()/2, img.height()/2),
+                                 img.width()/3 + 1)).clip(img.fullRoi()));
+        CPPUNIT_ASSERT(sameAsBinarization(Region(img, lo, hi), img, lo, hi));
+    }
+}
+
+/*! The values of the images lie in [hi, lo], so a range test accepting
+ * <tt>v == hi</tt> or <tt>v == lo</tt> would yield pixels. The images are
+ * wide enough for the SIMD loops, the UN16 buffer uses the scalar one.
+ */
+void
+RegionCreateTest::testEmptyRange()
+{
+    Executor ex(4);
+    for (int i = 0; i < testIterations; ++i) {
+        N32 const hi = rand()%255,
+            lo = hi + 1 + rand()%3;
+        PictImg<UN8> const img = randomImage<UN8>(hi, min(lo, 255), rand()%200 + 64);
+        CPPUNIT_ASSERT(sameAsBinarization(Region(img, lo, hi), img, lo, hi));
+        CPPUNIT_ASSERT(Region(img, lo, hi).empty());
+        CPPUNIT_ASSERT(Region(img, lo, hi, ex).empty());
+        CPPUNIT_ASSERT(Region::fromBuffer(&img(0, 0), img.width(), img.height(),
+                                          img.width(), lo, hi).empty());
+
+        PictImg<N16> const img16 = randomImage<N16>(hi * 100 - 50000, hi * 100 - 49999,
+                                                    rand()%200 + 64);
+        N32 const lo16 = hi * 100 - 49999,
+            hi16 = hi * 100 - 50000;
+        CPPUNIT_ASSERT(sameAsBinarization(Region(img16, lo16, hi16), img16, lo16, hi16));
+        CPPUNIT_ASSERT(Region(img16, lo16, hi16, ex).empty());
+        CPPUNIT_ASSERT(Region::fromBuffer(&img16(0, 0), img16.width(), img16.height(),
+                                          2 * img16.width(), lo16, hi16).empty());
+
+        vector<UN16> const buffer(img.width() * img.height(), hi);
+        CPPUNIT_ASSERT(Region::fromBuffer(&buffer[0], img.width(), img.height(),
+                                          2 * img.width(), lo, hi).empty());
+        CPPUNIT_ASSERT(!Region::fromBuffer(&buffer[0], img.width(), img.height(),
+                                           2 * img.width(), hi, hi).empty());
+    }
+}
+
+void
+RegionCreateTest::testThresholds()
+{
+    for (int i = 0; i < testIterations; ++i) {
+        PictImg<UN8> img = randomImage<UN8>(0, 255);
+        PictImg<N16> img16 = randomImage<N16>(-1000, 1000);
+        if (i%2)
+            img.setRoi(Region(Circle(PointF64(img.width()/2, img.height()/2),
+                                     img.width()/3 + 1)).clip(img.fullRoi()));
+        vector<Region::Threshold> thresholds;
+        for (N32 lo = rand()%20 - 10; lo < 300; lo += rand()%50 + 1) {
+            N32 const hi = lo + rand()%30;
+            thresholds.push_back(Region::Threshold(lo, hi));
+            lo = hi;
+        }
+
+        vector<Region> const regs = Region::fromThresholds(img, thresholds);
+        CPPUNIT_ASSERT_EQUAL(thresholds.size(), regs.size());
+        for (size_t k = 0; k < regs.size(); ++k) {
+            N32 const lo = thresholds[k].first,
+                hi = thresholds[k].second;
+            CPPUNIT_ASSERT(sameAsBinarization(regs[k], img, lo, hi));
+            CPPUNIT_ASSERT(Region(img, lo, hi).xorArea(regs[k]) == 0);
+        }
+
+        vector<Region> const regs16 = Region::fromThresholds(img16, thresholds);
+        for (size_t k = 0; k < regs16.size(); ++k)
+            CPPUNIT_ASSERT(sameAsBinarization(regs16[k], img16,
+                                              thresholds[k].first,
+                                              thresholds[k].second));
+    }
+    vector<Region::Threshold> overlapping;
+    overlapping.push_back(Region::Threshold(10, 20));
+    overlapping.push_back(Region::Threshold(20, 30));
+    CPPUNIT_ASSERT_THROW(Region::fromThresholds(PictImg<UN8>(10, 10), overlapping),
+                         ParameterError);
+}
+
+void
+RegionCreateTest::testLabels()
+{
+    for (int i = 0; i < testIterations; ++i) {
+        PictImg<UN8> img = randomImage<UN8>(0, 5);
+        PictImg<N16> img16 = randomImage<N16>(-3, 300);
+        if (i%2)
+            img.setRoi(Region(Circle(PointF64(img.width()/2, img.height()/2),
+                                     img.width()/3 + 1)).clip(img.fullRoi()));
+
+        map<N32, Region> const labels = Region::fromLabels(img);
+        N32 area = 0;
+        for (auto & l : labels) {
+            CPPUNIT_ASSERT(sameAsBinarization(l.second, img, l.first, l.first));
+            area += l.second.unionArea(Region());
+        }
+        CPPUNIT_ASSERT_EQUAL(img.roi().unionArea(Region()), area);
+
+        map<N32, Region> const labels16 = Region::fromLabels(img16);
+        for (auto & l : labels16)
+            CPPUNIT_ASSERT(sameAsBinarization(l.second, img16, l.first, l.first));
+    }
+}
+
+void
+RegionCreateTest::testParallelBinarize()
+{
+    Executor ex(4);
+    for (int i = 0; i < testIterations / 4; ++i) {
+        PictImg<UN8> img = randomImage<UN8>(0, 255, 640 + rand()%10, 480);
+        N32 const lo = rand()%256,
+            hi = lo + rand()%100;
+        Region const reg(img, lo, hi, ex);
+        CPPUNIT_ASSERT(sameAsBinarization(reg, img, lo, hi));
+        Region const serial(img, lo, hi);
+        CPPUNIT_ASSERT_EQUAL(serial.nrRbos(), reg.nrRbos());
+        CPPUNIT_ASSERT(std::equal(serial.begin(), serial.end(), reg.begin()));
+
+        img.setRoi(Region(Circle(PointF64(320, 240), 300)).clip(img.fullRoi()));
+        CPPUNIT_ASSERT(sameAsBinarization(Region(img, lo, hi, ex), img, lo, hi));
+
+        PictImg<N16> img16 = randomImage<N16>(-1000, 1000, 700, 500);
+        CPPUNIT_ASSERT(sameAsBinarization(Region(img16, -200, 300, ex),
+                                          img16, -200, 300));
+    }
+}
+
+void
+RegionCreateTest::testFromFile()
+{
+    vector<string> files;
+#if defined(IPL_HAVE_PNG)
+    files.push_back("test_region_create.png");
+#endif
+#if defined(IPL_HAVE_TIFF)
+    files.push_back("test_region_create.tif");
+#endif
+    for (auto & fn : files) {
+        for (int i = 0; i < testIterations / 4; ++i) {
+            PictImg<UN8> const img = randomImage<UN8>(0, 255);
+            img.save(fn);
+            N32 const lo = rand()%256,
+                hi = lo + rand()%100;
+            CPPUNIT_ASSERT_MESSAGE(fn, sameAsBinarization(Region::fromFile(fn, lo, hi),
+                                                          img, lo, hi));
+        }
+        // all pixels are at the bounds of the empty range
+        PictImg<UN8> const flat = randomImage<UN8>(100, 101, 16, 16);
+        flat.save(fn);
+        CPPUNIT_ASSERT_MESSAGE(fn, Region::fromFile(fn, 101, 100).empty());
+        CPPUNIT_ASSERT_MESSAGE(fn, Region::fromFile(fn, 200, 100).empty());
+        CPPUNIT_ASSERT_MESSAGE(fn, sameAsBinarization(Region::fromFile(fn, 100, 100),
+                                                      flat, 100, 100));
+        remove(fn.c_str());
+    }
+
+    CPPUNIT_ASSERT_THROW(Region::fromFile("test_region_create.none", 0, 255), IoError);
+    {
+        ofstream os("test_region_create.txt");
+        os << "no image";
+    }
+    CPPUNIT_ASSERT_THROW(Region::fromFile("test_region_create.txt", 0, 255), IoError);
+    remove("test_region_create.txt");
+}
+
+void
+RegionCreateTest::testBilevelCodes()
+{
+    for (int i = 0; i < testIterations; ++i) {
+        N32 const width = rand()%3000 + 1,
+            height = rand()%100 + 1;
+        // partly outside of the image
+        Region reg = Region(Circle(PointF64(rand()%width, rand()%height),
+                                   rand()%100 + 1))
+            .unions(Region(WinP(rand()%width, 0, width + 10, rand()%height)));
+        for (N32 y = 0; y < height; y += rand()%5 + 1) {
+            N32 const x = rand()%width;
+            reg = reg.unions(Region(WinP(x, y, x + rand()%100, y)));
+        }
+        Region const inside = Region(reg).clip(WinP(0, 0, width - 1, height - 1));
+
+        Region const g4 = Region::decodeG4(reg.encodeG4(width, height), width, height);
+        CPPUNIT_ASSERT(g4.validate());
+        CPPUNIT_ASSERT_EQUAL(inside.nrRbos(), g4.nrRbos());
+        CPPUNIT_ASSERT(std::equal(inside.begin(), inside.end(), g4.begin()));
+
+        Region const pb = Region::decodePackBits(reg.encodePackBits(width, height),
+                                                 width, height);
+        CPPUNIT_ASSERT(pb.validate());
+        CPPUNIT_ASSERT_EQUAL(inside.nrRbos(), pb.nrRbos());
+        CPPUNIT_ASSERT(std::equal(inside.begin(), inside.end(), pb.begin()));
+
+#if defined(IPL_HAVE_TIFF)
+        reg.saveTiff("test_region_create.tif", width, height,
+                     i % 2 ? Region::G4 : Region::PackBits);
+        Region const tif = Region::fromFile("test_region_create.tif", 255, 255);
+        CPPUNIT_ASSERT_EQUAL(inside.nrRbos(), tif.nrRbos());
+        CPPUNIT_ASSERT(std::equal(inside.begin(), inside.end(), tif.begin()));
+        WinP const frame(0, 0, width - 1, height - 1);
+        CPPUNIT_ASSERT_EQUAL(0, Region::fromFile("test_region_create.tif", 0, 0)
+                             .xorArea(inside.complement(&frame)));
+
+        // our code decoded by libtiff, the code of libtiff decoded by us
+        CPPUNIT_ASSERT(sameTiffScanlines(inside, "test_region_create.tif", width, height));
+        writeTiffScanlines(reg, "test_region_create.tif", width, height,
+                           i % 2 ? COMPRESSION_PACKBITS : COMPRESSION_CCITTFAX4);
+        Region const libtiff = Region::fromFile("test_region_create.tif", 255, 255);
+        CPPUNIT_ASSERT_EQUAL(inside.nrRbos(), libtiff.nrRbos());
+        CPPUNIT_ASSERT(std::equal(inside.begin(), inside.end(), libtiff.begin()));
+#endif
+    }
+    remove("test_region_create.tif");
+
+    vector<UN8> code = Region(WinP(3, 4, 50, 20)).encodeG4(100, 30);
+    code.resize(code.size() / 2);
+    CPPUNIT_ASSERT_THROW(Region::decodeG4(code, 100, 30), IoError);
+    CPPUNIT_ASSERT_THROW(Region::decodeG4(vector<UN8>(20, 0), 100, 30), IoError);
+    CPPUNIT_ASSERT_THROW(Region::decodePackBits(vector<UN8>(3, 1), 100, 30), IoError);
+    CPPUNIT_ASSERT_THROW(Region().encodeG4(0, 30), ParameterError);
+}
+
+void
+RegionCreateTest::testRasterBuffers()
+{
+    for (int i = 0; i < testIterations; ++i) {
+        PictImg<UN8> const img = randomImage<UN8>(0, 255);
+        N32 const lo = rand()%256,
+            hi = lo + rand()%100;
+        Region const reg(img, lo, hi);
+        Region const fromBuffer = Region::fromBuffer(&img(0, 0), img.width(), img.height(),
+                                                     img.width(), lo, hi);
+        CPPUNIT_ASSERT_EQUAL(reg.nrRbos(), fromBuffer.nrRbos());
+        CPPUNIT_ASSERT(std::equal(reg.begin(), reg.end(), fromBuffer.begin()));
+
+        PictImg<N16> const img16 = randomImage<N16>(-32768, 32767);
+        Region const reg16(img16, lo * 100, hi * 200);
+        Region const fromBuffer16 = Region::fromBuffer(&img16(0, 0), img16.width(), img16.height(),
+                                                       2 * img16.width(), lo * 100, hi * 200);
+        CPPUNIT_ASSERT_EQUAL(reg16.nrRbos(), fromBuffer16.nrRbos());
+        CPPUNIT_ASSERT(std::equal(reg16.begin(), reg16.end(), fromBuffer16.begin()));
+
+        // a window partly outside of the Region, rows with padding
+        N32 const width = rand()%300 + 1,
+            height = rand()%60 + 1,
+            step = width + rand()%20;
+        PointN16 const origin(rand()%100 - 50, rand()%30 - 15);
+        Region const inside = Region(reg).clip(WinP(origin.x_, origin.y_,
+                                                    origin.x_ + width - 1, origin.y_ + height - 1));
+        vector<UN8> buffer(step * height, 7);
+        reg.toBuffer(&buffer[0], width, height, step, origin, 200, 10);
+        for (N32 y = 0; y < height; ++y)
+            for (N32 x = 0; x < width; ++x)
+                CPPUNIT_ASSERT_EQUAL(inside.includes(PointN16(origin.x_ + x, origin.y_ + y)) ? 200 : 10,
+                                     N32(buffer[y * step + x]));
+        Region const back = Region::fromBuffer(&buffer[0], width, height, step, 200, 200, origin);
+        CPPUNIT_ASSERT_EQUAL(inside.nrRbos(), back.nrRbos());
+        CPPUNIT_ASSERT(std::equal(inside.begin(), inside.end(), back.begin()));
+
+        vector<UN8> bits(step * height, 0xff);
+        reg.toBits(&bits[0], width, height, step, origin);
+        for (N32 y = 0; y < height; ++y)
+            for (N32 x = 0; x < (width + 7) / 8 * 8; ++x)
+                CPPUNIT_ASSERT_EQUAL(x < width && inside.includes(PointN16(origin.x_ + x, origin.y_ + y)),
+                                     bool(bits[y * step + x / 8] & 0x80 >> x % 8));
+        Region const unpacked = Region::fromBits(&bits[0], width, height, step, origin);
+        CPPUNIT_ASSERT(unpacked.validate());
+        CPPUNIT_ASSERT_EQUAL(inside.nrRbos(), unpacked.nrRbos());
+        CPPUNIT_ASSERT(std::equal(inside.begin(), inside.end(), unpacked.begin()));
+
+        cv::Mat mat(height, width, CV_8UC1);
+        reg.toMat(mat, origin);
+        Region const fromMat = Region::fromMat(mat, 255, 255, origin);
+        CPPUNIT_ASSERT_EQUAL(inside.nrRbos(), fromMat.nrRbos());
+        CPPUNIT_ASSERT(std::equal(inside.begin(), inside.end(), fromMat.begin()));
+    }
+
+    cv::Mat mat(10, 10, CV_32FC1);
+    CPPUNIT_ASSERT_THROW(Region::fromMat(mat, 0, 1), ParameterError);
+    CPPUNIT_ASSERT_THROW(Region().toMat(mat), ParameterError);
+    CPPUNIT_ASSERT_THROW(Region::fromBits(0, -1, 1, 0), ParameterError);
+}
+
+int test_region_create(int, char*[])
+{
+    std::ofstream of("test_region_create.xml");
+    CppUnit::TextTestRunner runner;
+    if (localTesting()) {
+        runner.setOutputter(new CppUnit::CompilerOutputter(&runner.result(),
+                                                           std::cerr));
+    } else {
+        runner.setOutputter(new CppUnit::XmlOutputter(&runner.result(), of));
+    }
+    runner.addTest(RegionCreateTest::suite());
+    return runner.run() ? 0 : 1;
+}
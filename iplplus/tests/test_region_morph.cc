@@ -15,7 +15,9 @@
 #include "config.hh"
 
 #include <algorithm>
+#include <cmath>
 #include <string>
+#include <vector>
 #include <boost/array.hpp>
 #include <boost/archive/xml_oarchive.hpp>
 #include <boost/archive/xml_iarchive.hpp>
@@ -28,6 +30,9 @@
 
 #include "ipl/region.hh"
 #include "ipl/circle.hh"
+#include "ipl/packedmask.hh"
+#include "ipl/pict.hh"
+#include "ipl/iplerr.hh"
 
 using namespace ipl;
 using namespace std;
@@ -40,6 +45,15 @@ class RegionMorphTest : public CppUnit::TestFixture
     CPPUNIT_TEST(testSinglePointSE);
     CPPUNIT_TEST(testImgErodedByItself);
     CPPUNIT_TEST(testPointDilatedByImage);
+    CPPUNIT_TEST(testIncrementalUpdate);
+    CPPUNIT_TEST(testWindowedMorph);
+    CPPUNIT_TEST(testLazyErosion);
+    CPPUNIT_TEST(testFitsAndErodedArea);
+    CPPUNIT_TEST(testPackedMask);
+    CPPUNIT_TEST(testDistanceTransform);
+    CPPUNIT_TEST(testErosionBank);
+    CPPUNIT_TEST(testRankErosion);
+    CPPUNIT_TEST(testZoneMorphology);
     CPPUNIT_TEST_SUITE_END();
 public:
     void testEmptyPicture();
@@ -47,6 +61,15 @@ public:
     void testSinglePointSE();
     void testImgErodedByItself();
     void testPointDilatedByImage();
+    void testIncrementalUpdate();
+    void testWindowedMorph();
+    void testLazyErosion();
+    void testFitsAndErodedArea();
+    void testPackedMask();
+    void testDistanceTransform();
+    void testErosionBank();
+    void testRankErosion();
+    void testZoneMorphology();
 
 };
 
@@ -301,6 +324,460 @@ RegionMorphTest::testPointDilatedByImage()
 
 }
 
+void
+RegionMorphTest::testIncrementalUpdate()
+{
+	int rdmInteger1, rdmInteger2, rdmInteger3, rdmInteger4;
+	std::stringstream errormessage;
+	Region X1, X2, B;
+	srand(time(NULL));
+
+	for (int i = 1; i < testIterations; i++) {
+		rdmInteger1 = (rand()%100);
+		rdmInteger2 = (rand()%100);
+		rdmInteger3 = (rand()%100);
+		rdmInteger4 = (rand()%10);
+
+		errormessage << "Test failed for rdmInteger1 = " << rdmInteger1 << " :: rdmInteger2 = " << rdmInteger2 << " :: rdmInteger3 = " << rdmInteger3 << " :: rdmInteger4 = " << rdmInteger4 << endl;
+
+		X1 = Region(Circle(PointF64(rdmInteger3, rdmInteger2), rdmInteger1 + 20));
+		B = Region::generateStructuringElement(Region::StructuringElementDiamond, rdmInteger4 + 1);
+
+		// a frame differing in a few rows from X1
+		X2 = X1.unions(Region(WinP(rdmInteger1, rdmInteger2, rdmInteger1 + 30, rdmInteger2 + rdmInteger4)));
+		X2 = X2.subtract(Region(WinP(rdmInteger3, rdmInteger1, rdmInteger3 + 10, rdmInteger1 + 2)));
+
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), X2.erode2cut(B) == X2.erode2cutUpdate(B, X1, X1.erode2cut(B)));
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), X2.dilatecut(B) == X2.dilatecutUpdate(B, X1, X1.dilatecut(B)));
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), X1.erode2cut(B) == X1.erode2cutUpdate(B, X1, X1.erode2cut(B)));
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), Region().dilatecut(B) == Region().dilatecutUpdate(B, X1, X1.dilatecut(B)));
+	}
+}
+
+void
+RegionMorphTest::testWindowedMorph()
+{
+	int rdmInteger1, rdmInteger2, rdmInteger3, rdmInteger4;
+	std::stringstream errormessage;
+	Region X, B, fullImage;
+	srand(time(NULL));
+
+	for (int i = 1; i < testIterations; i++) {
+		rdmInteger1 = (rand()%100);
+		rdmInteger2 = (rand()%100);
+		rdmInteger3 = (rand()%100);
+		rdmInteger4 = (rand()%10);
+
+		errormessage << "Test failed for rdmInteger1 = " << rdmInteger1 << " :: rdmInteger2 = " << rdmInteger2 << " :: rdmInteger3 = " << rdmInteger3 << " :: rdmInteger4 = " << rdmInteger4 << endl;
+
+		X = Region(Circle(PointF64(rdmInteger3, rdmInteger2), rdmInteger1 + 20));
+		X = X.unions(Region(Rect(PointF64(rdmInteger1, rdmInteger3), PointF64(rdmInteger2 + 1, rdmInteger4 + 1), Angle(rdmInteger4, Angle::InDeg))));
+		B = Region::generateStructuringElement(Region::StructuringElementCircle, rdmInteger4 + 1);
+		WinP win(rdmInteger1, rdmInteger2, rdmInteger1 + rdmInteger3, rdmInteger2 + 2*rdmInteger4);
+
+		fullImage = X.erode2cut(B);
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), fullImage.clip(win) == X.erode2cut(B, win));
+		fullImage = X.dilatecut(B);
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), fullImage.clip(win) == X.dilatecut(B, win));
+
+		// an empty structuring element clips X to the window
+		fullImage = X;
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), fullImage.clip(win) == X.erode2cut(Region(), win));
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), fullImage == X.dilatecut(Region(), win));
+	}
+	CPPUNIT_ASSERT(Region().erode2cut(B, WinP(0, 0, 10, 10)).empty());
+	CPPUNIT_ASSERT(Region().dilatecut(B, WinP(0, 0, 10, 10)).empty());
+}
+
+void
+RegionMorphTest::testLazyErosion()
+{
+	int rdmInteger1, rdmInteger2, rdmInteger3, rdmInteger4;
+	std::stringstream errormessage;
+	Region X, B, erodedImage, lazyImage;
+	srand(time(NULL));
+
+	for (int i = 1; i < testIterations; i++) {
+		rdmInteger1 = (rand()%100);
+		rdmInteger2 = (rand()%100);
+		rdmInteger3 = (rand()%100);
+		rdmInteger4 = (rand()%10);
+
+		errormessage << "Test failed for rdmInteger1 = " << rdmInteger1 << " :: rdmInteger2 = " << rdmInteger2 << " :: rdmInteger3 = " << rdmInteger3 << " :: rdmInteger4 = " << rdmInteger4 << endl;
+
+		X = Region(Circle(PointF64(rdmInteger3, rdmInteger2), rdmInteger1 + 20));
+		X = X.unions(Region(Rect(PointF64(rdmInteger1, rdmInteger3), PointF64(rdmInteger2 + 1, rdmInteger4 + 1), Angle(rdmInteger4, Angle::InDeg))));
+		B = Region::generateStructuringElement(Region::StructuringElementDiamond, rdmInteger4 + 1);
+
+		erodedImage = X.erode2cut(B);
+		Region::LazyErosion const lazy = X.erode2cutLazy(B);
+
+		lazyImage = Region();
+		for (auto r = lazy.begin(); r != lazy.end(); ++r) {
+			lazyImage.add(*r);
+		}
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), erodedImage == lazyImage);
+
+		// the iterator keeps the erosion alive
+		Region::LazyErosion::Iterator it = X.erode2cutLazy(B).begin();
+		for (auto r = erodedImage.begin(); r != erodedImage.end(); ++r, ++it) {
+			CPPUNIT_ASSERT_MESSAGE(errormessage.str(), *r == *it);
+		}
+
+		for (int x = rdmInteger3 - rdmInteger1 - 20; x <= rdmInteger3 + rdmInteger1 + 20; x += rdmInteger4 + 1) {
+			CPPUNIT_ASSERT_MESSAGE(errormessage.str(), erodedImage.includes(PointN16(x, rdmInteger2)) == lazy.includes(PointN16(x, rdmInteger2)));
+		}
+
+		Region const win(WinP(rdmInteger1, rdmInteger2, rdmInteger1 + rdmInteger3, rdmInteger2 + 2*rdmInteger4));
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), erodedImage.intersect(win) == lazy.intersect(win));
+	}
+
+	Region const none;
+	Region::LazyErosion const empty = none.erode2cutLazy(B);
+	CPPUNIT_ASSERT(empty.begin() == empty.end());
+	CPPUNIT_ASSERT(Region::LazyErosion::Iterator() == Region::LazyErosion::Iterator());
+}
+
+void
+RegionMorphTest::testFitsAndErodedArea()
+{
+	int rdmInteger1, rdmInteger2, rdmInteger3, rdmInteger4;
+	std::stringstream errormessage;
+	Region X, B, erodedImage;
+	N32 area;
+	srand(time(NULL));
+
+	for (int i = 1; i < testIterations; i++) {
+		rdmInteger1 = (rand()%100);
+		rdmInteger2 = (rand()%100);
+		rdmInteger3 = (rand()%100);
+		rdmInteger4 = (rand()%30);
+
+		errormessage << "Test failed for rdmInteger1 = " << rdmInteger1 << " :: rdmInteger2 = " << rdmInteger2 << " :: rdmInteger3 = " << rdmInteger3 << " :: rdmInteger4 = " << rdmInteger4 << endl;
+
+		X = Region(Circle(PointF64(rdmInteger3, rdmInteger2), rdmInteger1 % 20 + 5));
+		B = Region::generateStructuringElement(Region::StructuringElementSquare, rdmInteger4 + 1);
+
+		erodedImage = X.erode2cut(B);
+		area = 0;
+		for (auto & r : erodedImage) {
+			area += r.len();
+		}
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), !erodedImage.empty() == X.fits(B));
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), area == X.erodedArea(B));
+	}
+
+	CPPUNIT_ASSERT(!Region().fits(B));
+	CPPUNIT_ASSERT(0 == Region().erodedArea(B));
+}
+
+
+void
+RegionMorphTest::testPackedMask()
+{
+	int rdmInteger1, rdmInteger2, rdmInteger3, rdmInteger4;
+	std::stringstream errormessage;
+	Region X, B;
+	srand(time(NULL));
+
+	for (int i = 1; i < testIterations; i++) {
+		rdmInteger1 = (rand()%100);
+		rdmInteger2 = (rand()%100);
+		rdmInteger3 = (rand()%100);
+		rdmInteger4 = (rand()%30);
+
+		errormessage << "Test failed for rdmInteger1 = " << rdmInteger1 << " :: rdmInteger2 = " << rdmInteger2 << " :: rdmInteger3 = " << rdmInteger3 << " :: rdmInteger4 = " << rdmInteger4 << endl;
+
+		// dense speckles with short runs and gaps
+		X = Region();
+		for (int y = rdmInteger2 - 80; y < rdmInteger2 + 80; y++) {
+			for (int x = rdmInteger1 - 150 + rand()%4, len = 0; x < rdmInteger1 + 150; x += len + rand()%4 + 1) {
+				len = rand()%6 + 1;
+				X.add(Rbo(PointN16(x, y), len));
+			}
+		}
+		X = X.unions(Region(Circle(PointF64(rdmInteger3, rdmInteger2), rdmInteger1 + 20)));
+
+		// the structuring elements include one wider than a word and one apart from the origin
+		Region const Bs[] = {
+			Region::generateStructuringElement(Region::StructuringElementCircle, rdmInteger4 % 10 + 1),
+			Region::generateStructuringElement(Region::StructuringElementDiamond, rdmInteger4 % 5 + 1),
+			Region::generateStructuringElement(Region::StructuringElementSquare, rdmInteger4 + 50),
+			Region(WinP(rdmInteger4 - 3, 2, rdmInteger4 + 1, 4)).unions(Region(WinP(-rdmInteger4, -9, -rdmInteger4 + 2, -7)))
+		};
+		for (auto & B : Bs) {
+			CPPUNIT_ASSERT_MESSAGE(errormessage.str(), X.erode2cut(B) == PackedMask(X).erode(B).region());
+			CPPUNIT_ASSERT_MESSAGE(errormessage.str(), X.erode2cut(B) == X.erode(B, Region::PackedEngine));
+			CPPUNIT_ASSERT_MESSAGE(errormessage.str(), X.erode2cut(B) == X.erode(B));
+			CPPUNIT_ASSERT_MESSAGE(errormessage.str(), X.dilate(B) == PackedMask(X).dilate(B).region());
+			CPPUNIT_ASSERT_MESSAGE(errormessage.str(), X.dilate(B) == X.dilate(B, Region::AutoEngine));
+			CPPUNIT_ASSERT_MESSAGE(errormessage.str(), X.dilate(B) == X.dilate(B, Region::RunEngine));
+		}
+
+		WinP const win(rdmInteger1, rdmInteger2, rdmInteger1 + rdmInteger3, rdmInteger2 + 2*rdmInteger4);
+		PackedMask const mask(X, win);
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), Region(X).clip(win) == mask.region());
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), X.includes(PointN16(rdmInteger1, rdmInteger2)) == mask.includes(PointN16(rdmInteger1, rdmInteger2)));
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), !mask.includes(PointN16(rdmInteger1 - 1, rdmInteger2)));
+	}
+
+	B = Region::generateStructuringElement(Region::StructuringElementSquare, 3);
+	CPPUNIT_ASSERT(PackedMask(Region()).erode(B).region().empty());
+	CPPUNIT_ASSERT(PackedMask(Region(WinP(0, 0, 1, 1))).erode(B).region().empty());
+	CPPUNIT_ASSERT(!PackedMask::erosionPreferred(Region(), B));
+	CPPUNIT_ASSERT(!PackedMask::dilationPreferred(Region(), B));
+
+	// a few points far apart are dilated by their runs
+	Region sparse;
+	sparse.add(Rbo(PointN16(0, 0), 1));
+	sparse.add(Rbo(PointN16(3000, 2000), 1));
+	CPPUNIT_ASSERT(!PackedMask::dilationPreferred(sparse, B));
+	CPPUNIT_ASSERT(sparse.dilate(B) == sparse.dilate(B, Region::AutoEngine));
+	CPPUNIT_ASSERT(PackedMask::dilationPreferred(Region(Circle(PointF64(100, 100), 80)), B));
+}
+
+void
+RegionMorphTest::testDistanceTransform()
+{
+	std::stringstream errormessage;
+	srand(time(NULL));
+
+	for (int i = 1; i < testIterations; i++) {
+		int const cx = rand()%100 - 50,
+			cy = rand()%100 - 50,
+			r = rand()%20 + 5;
+		errormessage << "Test failed for cx = " << cx << " :: cy = " << cy << " :: r = " << r << endl;
+
+		// a disk with a hole, a bar and some speckles
+		Region X = Region(Circle(PointF64(cx, cy), r))
+			.subtract(Region(Circle(PointF64(cx + r/3, cy), r/4)))
+			.unions(Region(WinP(cx - 2*r, cy + r/2, cx + r, cy + r/2 + rand()%5)));
+		for (int k = 0; k < 30; k++) {
+			int const x = cx + rand()%(2*r) - r,
+				y = cy + rand()%(2*r) - r;
+			X = X.unions(Region(WinP(x, y, x + rand()%3, y + rand()%3)));
+		}
+
+		// the distances pixel by pixel, the nearest pixel of the complement
+		// is within the bounding box grown by one
+		WinP const & bb = X.boundingBox();
+		PictImg<N16> const dist = X.distanceTransform(4);
+		for (int y = bb.upperLeft().y_; y <= bb.lowerRight().y_; y++) {
+			for (int x = bb.upperLeft().x_; x <= bb.lowerRight().x_; x++) {
+				int d2 = 0;
+				if (X.includes(PointN16(x, y))) {
+					d2 = 1 << 30;
+					for (int v = bb.upperLeft().y_ - 1; v <= bb.lowerRight().y_ + 1; v++)
+						for (int u = bb.upperLeft().x_ - 1; u <= bb.lowerRight().x_ + 1; u++)
+							if (!X.includes(PointN16(u, v)))
+								d2 = std::min(d2, (u - x)*(u - x) + (v - y)*(v - y));
+				}
+				CPPUNIT_ASSERT_EQUAL_MESSAGE(errormessage.str(), int(floor(4*sqrt(d2) + 0.5)),
+											 int(dist(x - bb.upperLeft().x_, y - bb.upperLeft().y_)));
+			}
+		}
+
+		// erosions by disks of integral and fractional radii
+		std::vector<F64> const radii = { 0, 1, 1.5, 2.3, F64(rand()%8), r/2.0 };
+		std::vector<Region> const eroded = X.erodeDisks(radii);
+		for (size_t k = 0; k < radii.size(); k++) {
+			int const R = int(radii[k]);
+			Region disk;
+			for (int y = -R; y <= R; y++) {
+				int const w = int(floor(sqrt(radii[k]*radii[k] - y*y)));
+				disk.add(Rbo(PointN16(-w, y), 2*w + 1));
+			}
+			CPPUNIT_ASSERT_MESSAGE(errormessage.str(), X.erode2cut(disk) == eroded[k]);
+			CPPUNIT_ASSERT_MESSAGE(errormessage.str(), X.erode2cut(disk) == X.erodeDisk(radii[k]));
+		}
+	}
+
+	CPPUNIT_ASSERT(Region().erodeDisk(3).empty());
+	CPPUNIT_ASSERT(Region(WinP(0, 0, 4, 4)).erodeDisk(2) == Region(WinP(2, 2, 2, 2)));
+	CPPUNIT_ASSERT_THROW(Region().distanceTransform(), EmptyRegionError);
+	CPPUNIT_ASSERT_THROW(Region().erodeDisk(-1), ParameterError);
+}
+
+void
+RegionMorphTest::testErosionBank()
+{
+	std::stringstream errormessage;
+	srand(time(NULL));
+
+	for (int i = 1; i < testIterations; i++) {
+		int const cx = rand()%100,
+			cy = rand()%100,
+			size = rand()%12 + 1;
+		errormessage << "Test failed for cx = " << cx << " :: cy = " << cy << " :: size = " << size << endl;
+
+		// a disk with dense speckles around
+		Region X;
+		for (int y = cy - 60; y < cy + 60; y++) {
+			for (int x = cx - 90 + rand()%4, len = 0; x < cx + 90; x += len + rand()%3 + 1) {
+				len = rand()%12 + 1;
+				X.add(Rbo(PointN16(x, y), len));
+			}
+		}
+		X = X.unions(Region(Circle(PointF64(cx, cy), 40)));
+
+		// rotated lines, a diamond larger than all of them and an empty one
+		std::vector<Region> bank = Region::generateLineBank(size, 8);
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), bank[0] == Region::generateStructuringElement(Region::StructuringElementLine, size));
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), bank[4] == Region(WinP(0, -size, 0, size)));
+		bank.push_back(Region::generateStructuringElement(Region::StructuringElementDiamond, size + 2));
+		bank.push_back(Region());
+
+		std::vector<Region> const eroded = X.erode2cut(bank);
+		CPPUNIT_ASSERT_EQUAL(bank.size(), eroded.size());
+		for (size_t k = 0; k < bank.size(); k++) {
+			CPPUNIT_ASSERT_MESSAGE(errormessage.str(), X.erode2cut(bank[k]) == eroded[k]);
+		}
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), Region::unionAll(eroded.begin(), eroded.end()) == X.erodeUnion(bank));
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), Region::intersectAll(eroded.begin(), eroded.end()) == X.erodeIntersection(bank));
+	}
+
+	CPPUNIT_ASSERT(Region().erode2cut(Region::generateLineBank(3, 4))[2].empty());
+	CPPUNIT_ASSERT(Region().erode2cut(std::vector<Region>()).empty());
+	CPPUNIT_ASSERT_THROW(Region::generateLineBank(3, 0), ParameterError);
+}
+
+void
+RegionMorphTest::testRankErosion()
+{
+	std::stringstream errormessage;
+	srand(time(NULL));
+
+	for (int i = 1; i < testIterations; i++) {
+		int const cx = rand()%100,
+			cy = rand()%100,
+			size = rand()%6 + 1;
+		errormessage << "Test failed for cx = " << cx << " :: cy = " << cy << " :: size = " << size << endl;
+
+		// a disk with holes and noise around
+		Region X = Region(Circle(PointF64(cx, cy), 20));
+		for (int k = 0; k < 60; k++) {
+			int const x = cx - 30 + rand()%60,
+				y = cy - 30 + rand()%60;
+			Region const speck(WinP(x, y, x + rand()%2, y + rand()%2));
+			X = rand()%2 ? X.unions(speck) : X.subtract(speck);
+		}
+		Region const B = Region::generateStructuringElement(Region::StructuringElementDiamond, size);
+		Region reflected;
+		for (Region::RboIterator b = B.end(); b != B.begin(); ) {
+			--b;
+			reflected.add(Rbo(PointN16(-b->start().x_ - b->len() + 1, -b->start().y_), b->len()));
+		}
+
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), X.erodeRank(B, B.area()) == X.erode2cut(B));
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), X.erodePercentile(B, 100) == X.erode2cut(B));
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), X.erodeRank(B, 1) == X.dilate(reflected));
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), X.erodeRank(B, B.area() + 1).empty());
+
+		// against counting the covered pixels of B at every point
+		N32 const minCount = rand()%B.area() + 1;
+		Region expected;
+		for (int y = cy - 30 - size; y <= cy + 30 + size; y++) {
+			int start = 0, len = 0;
+			for (int x = cx - 30 - size; x <= cx + 31 + size; x++) {
+				N32 count = 0;
+				for (Region::RboIterator b = B.begin(); b != B.end(); ++b) {
+					for (int k = 0; k < b->len(); k++) {
+						count += X.includes(PointN16(x + b->start().x_ + k, y + b->start().y_));
+					}
+				}
+				if (count >= minCount) {
+					start = len ? start : x;
+					len++;
+				} else if (len) {
+					expected.add(Rbo(PointN16(start, y), len));
+					len = 0;
+				}
+			}
+		}
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), expected == X.erodeRank(B, minCount));
+	}
+
+	Region const square(WinP(0, 0, 9, 9));
+	Region const B(WinP(-1, -1, 1, 1));
+	CPPUNIT_ASSERT(square.erodePercentile(B, 50) == Region(WinP(1, 0, 8, 9)).unions(Region(WinP(0, 1, 9, 8))));
+	CPPUNIT_ASSERT(square.erodePercentile(B, 40) == square);
+	CPPUNIT_ASSERT(square.erodePercentile(B, 30) == square.unions(Region(WinP(-1, 1, 10, 8))).unions(Region(WinP(1, -1, 8, 10))));
+	CPPUNIT_ASSERT(Region().erodeRank(B, 3).empty());
+	CPPUNIT_ASSERT(square.erodeRank(Region(), 3) == square);
+	CPPUNIT_ASSERT_THROW(square.erodeRank(B, 0), ParameterError);
+	CPPUNIT_ASSERT_THROW(square.erodePercentile(B, 0), ParameterError);
+	CPPUNIT_ASSERT_THROW(square.erodePercentile(B, 101), ParameterError);
+}
+
+void
+RegionMorphTest::testZoneMorphology()
+{
+	std::stringstream errormessage;
+	srand(time(NULL));
+
+	for (int i = 1; i < testIterations; i++) {
+		int const cx = rand()%100,
+			cy = rand()%100;
+		errormessage << "Test failed for cx = " << cx << " :: cy = " << cy << endl;
+
+		// a disk with dense speckles around
+		Region X;
+		for (int y = cy - 60; y < cy + 60; y++) {
+			for (int x = cx - 90 + rand()%4, len = 0; x < cx + 90; x += len + rand()%3 + 1) {
+				len = rand()%12 + 1;
+				X.add(Rbo(PointN16(x, y), len));
+			}
+		}
+		X = X.unions(Region(Circle(PointF64(cx, cy), 40)));
+
+		// a grid of 3x3 windows, larger structuring elements towards the border
+		std::vector<WinP> windows;
+		std::vector<Region> Bs;
+		for (int zy = 0; zy < 3; zy++) {
+			for (int zx = 0; zx < 3; zx++) {
+				int const x0 = cx - 100 + zx*65 + rand()%5,
+					y0 = cy - 70 + zy*45 + rand()%5;
+				windows.push_back(WinP(x0, y0, x0 + 64, y0 + 44));
+				if (zx == 1 && zy == 1) { // the centre stays as it is
+					Bs.push_back(Region());
+					continue;
+				}
+				int const size = abs(zx - 1) + abs(zy - 1) + rand()%3;
+				Bs.push_back(rand()%2 ? Region::generateStructuringElement(Region::StructuringElementCircle, size)
+						: Region(WinP(-size, 0, size, 1)));
+			}
+		}
+		std::vector<Region> const zones(windows.begin(), windows.end());
+
+		std::vector<Region> eroded, dilated;
+		for (size_t k = 0; k < zones.size(); k++) {
+			eroded.push_back(X.erode2cut(Bs[k]).intersect(zones[k]));
+			dilated.push_back(X.dilate(Bs[k]).intersect(zones[k]));
+		}
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), Region::unionAll(eroded.begin(), eroded.end()) == X.erodeZones(zones, Bs));
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), Region::unionAll(eroded.begin(), eroded.end()) == X.erodeZones(windows, Bs));
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), Region::unionAll(dilated.begin(), dilated.end()) == X.dilateZones(zones, Bs));
+
+		// a disk and its surrounding as zones
+		std::vector<Region> ring;
+		ring.push_back(Region(Circle(PointF64(cx, cy), 30)));
+		ring.push_back(Region(WinP(cx - 80, cy - 50, cx + 80, cy + 50)).subtract(ring[0]));
+		std::vector<Region> ringBs;
+		ringBs.push_back(Region::generateStructuringElement(Region::StructuringElementDiamond, 1));
+		ringBs.push_back(Region::generateStructuringElement(Region::StructuringElementCircle, 4));
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), X.erode2cut(ringBs[0]).intersect(ring[0]).unions(X.erode2cut(ringBs[1]).intersect(ring[1])) == X.erodeZones(ring, ringBs));
+		CPPUNIT_ASSERT_MESSAGE(errormessage.str(), X.dilate(ringBs[0]).intersect(ring[0]).unions(X.dilate(ringBs[1]).intersect(ring[1])) == X.dilateZones(ring, ringBs));
+	}
+
+	std::vector<Region> const zones(1, Region(WinP(0, 0, 9, 9)));
+	std::vector<Region> const Bs(1, Region(WinP(-1, -1, 1, 1)));
+	CPPUNIT_ASSERT(Region().erodeZones(zones, Bs).empty());
+	CPPUNIT_ASSERT(Region().dilateZones(zones, Bs).empty());
+	CPPUNIT_ASSERT(Region(WinP(0, 0, 20, 20)).dilateZones(zones, Bs) == zones[0]);
+	CPPUNIT_ASSERT(Region(WinP(0, 0, 20, 20)).erodeZones(zones, Bs) == Region(WinP(1, 1, 9, 9)));
+	CPPUNIT_ASSERT_THROW(Region(WinP(0, 0, 20, 20)).erodeZones(zones, std::vector<Region>()), ParameterError);
+	CPPUNIT_ASSERT_THROW(Region(WinP(0, 0, 20, 20)).dilateZones(zones, std::vector<Region>()), ParameterError);
+}
 
 int test_region_morph(int, char*[])
 {
@@ -0,0 +1,762 @@
+/*****************************************************************//**
+ *
+ * @file
+ * @date   Oct 19 2026
+ *
+ * $Id: $
+ *
+ * @brief  Unittest for the set operations of Region
+ *
+ ********************************************************************/
+
+#include "config.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <boost/iterator/transform_iterator.hpp>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/XmlOutputter.h>
+
+#include "ipl/region.hh"
+#include "ipl/circle.hh"
+#include "ipl/executor.hh"
+#include "ipl/mappedregion.hh"
+#include "ipl/packedregion.hh"
+#include "ipl/hybridregion.hh"
+#include "ipl/blobs.hh"
+#include "ipl/labelledregion.hh"
+#include "ipl/pict.hh"
+#include "ipl/iplerr.hh"
+
+using namespace ipl;
+using namespace std;
+
+class RegionSetTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(RegionSetTest);
+    CPPUNIT_TEST(testAreas);
+    CPPUNIT_TEST(testSetOperations);
+    CPPUNIT_TEST(testNaryOperations);
+    CPPUNIT_TEST(testParallelOperations);
+    CPPUNIT_TEST(testMappedRegion);
+    CPPUNIT_TEST(testPackedRegion);
+    CPPUNIT_TEST(testHybridRegion);
+    CPPUNIT_TEST(testBlobs);
+    CPPUNIT_TEST(testShapeFeatures);
+    CPPUNIT_TEST(testAttributeFilters);
+    CPPUNIT_TEST(testLabelledRegion);
+    CPPUNIT_TEST_SUITE_END();
+public:
+    void setUp();
+    void testAreas();
+    void testSetOperations();
+    void testNaryOperations();
+    void testParallelOperations();
+    void testMappedRegion();
+    void testPackedRegion();
+    void testHybridRegion();
+    void testBlobs();
+    void testShapeFeatures();
+    void testAttributeFilters();
+    void testLabelledRegion();
+
+private:
+    //! random test region: a circle and a rotated rectangle
+    Region randomRegion();
+    //! random test region with many Rbo's: a lot of circles
+    Region randomLargeRegion();
+    //! random speckle noise in a random window
+    PictImg<UN8> randomNoise();
+};
+
+IPL_ANON_NS_BEGIN
+
+//! number of test iterations
+int const testIterations = 20;
+
+//! number of pixels of @a reg
+N32
+area(Region const & reg)
+{
+    N32 a = 0;
+    for (auto & r : reg)
+        a += r.len();
+    return a;
+}
+
+//! Check every pixel of @a win: is it in @a res iff @a op applied to @a a and @a b?
+template<typename Op>
+bool
+samePixels(Region const & res, Region const & a, Region const & b,
+           WinP const & win, Op op)
+{
+    for (N16 y = win.upperLeft().y_; y <= win.lowerRight().y_; ++y)
+        for (N16 x = win.upperLeft().x_; x <= win.lowerRight().x_; ++x) {
+            PointN16 const pt(x, y);
+            if (res.includes(pt) != op(a.includes(pt), b.includes(pt)))
+                return false;
+        }
+    return true;
+}
+
+//! Copies a Region, for an iterator yielding temporaries.
+struct CopyRegion {
+    typedef Region result_type;
+    Region operator()(Region const & reg) const { return reg; }
+};
+
+//! Are @a a and @a b made of the same Rbo's?
+bool
+sameRbos(Region const & a, Region const & b)
+{
+    return a.nrRbos() == b.nrRbos()
+        && std::equal(a.begin(), a.end(), b.begin())
+        && a.validate() && b.validate();
+}
+
+//! The owner of @a pt after dilating each of @a objs to @a dilated.
+N32
+dilatedOwner(vector<Region> const & objs, vector<Region> const & dilated,
+             PointN16 const & pt, LabelledRegion::Conflict conflict)
+{
+    vector<N32> reaching;
+    for (N32 i = 0; i < N32(dilated.size()); ++i)
+        if (dilated[i].includes(pt))
+            reaching.push_back(i);
+    for (auto i : reaching)
+        if (objs[i].includes(pt))
+            return i;
+    if (reaching.size() == 1 || (!reaching.empty() && conflict == LabelledRegion::ConflictLowestLabel))
+        return reaching.front();
+    return -1;
+}
+
+//! The label of @a pt in @a objs, -1 if none.
+N32
+labelAt(vector<Region> const & objs, PointN16 const & pt)
+{
+    for (N32 i = 0; i < N32(objs.size()); ++i)
+        if (objs[i].includes(pt))
+            return i;
+    return -1;
+}
+
+//! Are @a blobs the connected components of @a reg found by a flood fill?
+bool
+sameAsFloodFill(Blobs const & blobs, Region const & reg, Blobs::Connectivity conn)
+{
+    if (reg.empty())
+        return blobs.empty();
+    WinP const & bbox = reg.boundingBox();
+    N32 const x0 = bbox.upperLeft().x_, y0 = bbox.upperLeft().y_,
+        w = N32(bbox.lowerRight().x_) - x0 + 1, h = N32(bbox.lowerRight().y_) - y0 + 1;
+    // the blob of each pixel, -1 outside of the Region
+    vector<N32> label(w * h, -1);
+    for (N32 i = 0; i < blobs.size(); ++i)
+        for (auto & r : blobs[i])
+            for (N32 x = r.start().x_; x < r.start().x_ + r.len(); ++x)
+                label[(r.start().y_ - y0) * w + x - x0] = i;
+    for (auto & r : reg)
+        for (N32 x = r.start().x_; x < r.start().x_ + r.len(); ++x)
+            if (label[(r.start().y_ - y0) * w + x - x0] < 0)
+                return false;
+
+    vector<bool> seen(w * h, false);
+    vector<N32> stack;
+    N32 nrComponents = 0;
+    for (N32 p = 0; p < w * h; ++p) {
+        if (label[p] < 0 || seen[p])
+            continue;
+        ++nrComponents;
+        seen[p] = true;
+        stack.push_back(p);
+        while (!stack.empty()) {
+            N32 const q = stack.back();
+            stack.pop_back();
+            for (N32 dy = -1; dy <= 1; ++dy)
+                for (N32 dx = -1; dx <= 1; ++dx) {
+                    N32 const x = q % w + dx, y = q / w + dy;
+                    if ((dx != 0 && dy != 0 && conn == Blobs::Connect4)
+                        || x < 0 || x >= w || y < 0 || y >= h || label[y * w + x] < 0)
+                        continue;
+                    if (label[y * w + x] != label[p])
+                        return false;
+                    if (!seen[y * w + x]) {
+                        seen[y * w + x] = true;
+                        stack.push_back(y * w + x);
+                    }
+                }
+        }
+    }
+    return nrComponents == blobs.size();
+}
+
+IPL_ANON_NS_END
+
+void
+RegionSetTest::setUp()
+{
+    srand(time(NULL));
+}
+
+Region
+RegionSetTest::randomRegion()
+{
+    int const x = rand()%100,
+        y = rand()%100,
+        r = rand()%40 + 1;
+    Region const c = Region(Circle(PointF64(x, y), r));
+    return c.unions(Region(Rect(PointF64(y, x), PointF64(r, rand()%20 + 1),
+                                Angle(rand()%90, Angle::InDeg))));
+}
+
+Region
+RegionSetTest::randomLargeRegion()
+{
+    vector<Region> circles;
+    for (int i = 0; i < 300; ++i)
+        circles.push_back(Region(Circle(PointF64(rand()%1200, rand()%1200),
+                                        rand()%50 + 1)));
+    return Region::unionAll(circles.begin(), circles.end());
+}
+
+PictImg<UN8>
+RegionSetTest::randomNoise()
+{
+    PictImg<UN8> img(rand()%600 + 1, rand()%100 + 1);
+    WinP const win(rand()%img.width(), rand()%img.height(),
+                   img.width() - 1, img.height() - 1);
+    for (N16 y = 0; y < img.height(); ++y)
+        for (N16 x = 0; x < img.width(); ++x)
+            img(x, y) = win.includes(PointN16(x, y)) ? rand()%256 : 0;
+    return img;
+}
+
+void
+RegionSetTest::testAreas()
+{
+    for (int i = 0; i < testIterations; ++i) {
+        Region const a = randomRegion(),
+            b = randomRegion();
+        N32 const inter = area(a.intersect(b)),
+            un = area(a.unions(b));
+        std::ostringstream msg;
+        msg << a << " and " << b;
+        CPPUNIT_ASSERT_EQUAL_MESSAGE(msg.str(), inter, a.intersectArea(b));
+        CPPUNIT_ASSERT_EQUAL_MESSAGE(msg.str(), un, a.unionArea(b));
+        CPPUNIT_ASSERT_EQUAL_MESSAGE(msg.str(), un - inter, a.xorArea(b));
+        CPPUNIT_ASSERT_EQUAL_MESSAGE(msg.str(), un - inter, b.xorArea(a));
+        CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(msg.str(),
+                                             static_cast<F64>(inter)/un,
+                                             a.iou(b), 1e-12);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, a.iou(a), 1e-12);
+        CPPUNIT_ASSERT_EQUAL(area(a), a.unionArea(Region()));
+        CPPUNIT_ASSERT_EQUAL(N32(0), a.intersectArea(Region()));
+    }
+    CPPUNIT_ASSERT_EQUAL(0.0, Region().iou(Region()));
+}
+
+void
+RegionSetTest::testSetOperations()
+{
+    for (int i = 0; i < testIterations; ++i) {
+        Region const a = randomRegion(),
+            b = randomRegion();
+        std::ostringstream msg;
+        msg << a << " and " << b;
+        WinP const bb = a.unions(b).boundingBox();
+        WinP const win(bb.upperLeft().x_ - 2, bb.upperLeft().y_ - 2,
+                       bb.lowerRight().x_ + 2, bb.lowerRight().y_ + 2);
+
+        Region const un = a.unions(b),
+            inter = a.intersect(b),
+            diff = a.subtract(b),
+            sym = a.symmetricDifference(b),
+            comp = a.complement(&win);
+        CPPUNIT_ASSERT_MESSAGE(msg.str(), un.validate());
+        CPPUNIT_ASSERT_MESSAGE(msg.str(), inter.validate());
+        CPPUNIT_ASSERT_MESSAGE(msg.str(), diff.validate());
+        CPPUNIT_ASSERT_MESSAGE(msg.str(), sym.validate());
+        CPPUNIT_ASSERT_MESSAGE(msg.str(), comp.validate());
+        CPPUNIT_ASSERT_MESSAGE(msg.str(),
+            samePixels(un, a, b, win, [](bool p, bool q) { return p || q; }));
+        CPPUNIT_ASSERT_MESSAGE(msg.str(),
+            samePixels(inter, a, b, win, [](bool p, bool q) { return p && q; }));
+        CPPUNIT_ASSERT_MESSAGE(msg.str(),
+            samePixels(diff, a, b, win, [](bool p, bool q) { return p && !q; }));
+        CPPUNIT_ASSERT_MESSAGE(msg.str(),
+            samePixels(sym, a, b, win, [](bool p, bool q) { return p != q; }));
+        CPPUNIT_ASSERT_MESSAGE(msg.str(),
+            samePixels(comp, a, b, win, [](bool p, bool) { return !p; }));
+        CPPUNIT_ASSERT_EQUAL_MESSAGE(msg.str(), a.xorArea(b), area(sym));
+    }
+    Region const a = randomRegion();
+    CPPUNIT_ASSERT_EQUAL(area(a), area(a.symmetricDifference(Region())));
+    CPPUNIT_ASSERT_EQUAL(N32(0), area(a.symmetricDifference(a)));
+    CPPUNIT_ASSERT_EQUAL(N32(0), area(a.subtract(a)));
+}
+
+void
+RegionSetTest::testNaryOperations()
+{
+    for (int i = 0; i < testIterations; ++i) {
+        // a common part, such that the intersection is not empty
+        Region const common(WinP(20, 30, 80 + i, 40 + i));
+        vector<Region> regs;
+        Region un, inter;
+        int const n = rand()%10 + 1;
+        for (int k = 0; k < n; ++k) {
+            regs.push_back(randomRegion().unions(common));
+            un = un.unions(regs.back());
+            inter = k ? inter.intersect(regs.back()) : regs.back();
+        }
+        Region const unAll = Region::unionAll(regs.begin(), regs.end()),
+            interAll = Region::intersectAll(regs.begin(), regs.end());
+        CPPUNIT_ASSERT(unAll.validate());
+        CPPUNIT_ASSERT(interAll.validate());
+        CPPUNIT_ASSERT_EQUAL(un.nrRbos(), unAll.nrRbos());
+        CPPUNIT_ASSERT_EQUAL(N32(0), un.xorArea(unAll));
+        CPPUNIT_ASSERT_EQUAL(inter.nrRbos(), interAll.nrRbos());
+        CPPUNIT_ASSERT_EQUAL(N32(0), inter.xorArea(interAll));
+
+        // the Regions of an iterator yielding temporaries are copied
+        auto const first = boost::make_transform_iterator(regs.cbegin(), CopyRegion()),
+            last = boost::make_transform_iterator(regs.cend(), CopyRegion());
+        CPPUNIT_ASSERT(sameRbos(unAll, Region::unionAll(first, last)));
+        CPPUNIT_ASSERT(sameRbos(interAll, Region::intersectAll(first, last)));
+    }
+    vector<Region> regs;
+    CPPUNIT_ASSERT(Region::unionAll(regs.begin(), regs.end()).empty());
+    CPPUNIT_ASSERT(Region::intersectAll(regs.begin(), regs.end()).empty());
+    regs.push_back(randomRegion());
+    regs.push_back(Region());
+    CPPUNIT_ASSERT(Region::intersectAll(regs.begin(), regs.end()).empty());
+    CPPUNIT_ASSERT_EQUAL(N32(0), regs[0].xorArea(Region::unionAll(regs.begin(), regs.end())));
+}
+
+void
+RegionSetTest::testParallelOperations()
+{
+    Executor ex(4);
+    for (int i = 0; i < testIterations / 4; ++i) {
+        Region const a = randomLargeRegion(),
+            b = randomLargeRegion();
+        std::ostringstream msg;
+        msg << a.nrRbos() << " and " << b.nrRbos() << " Rbo's";
+        CPPUNIT_ASSERT_MESSAGE(msg.str(), sameRbos(a.unions(b), a.unions(b, ex)));
+        CPPUNIT_ASSERT_MESSAGE(msg.str(), sameRbos(a.intersect(b), a.intersect(b, ex)));
+        CPPUNIT_ASSERT_MESSAGE(msg.str(), sameRbos(a.complement(0), a.complement(0, ex)));
+        WinP const win(rand()%400, rand()%400, rand()%400 + 800, rand()%400 + 800);
+        CPPUNIT_ASSERT_MESSAGE(msg.str(), sameRbos(a.complement(&win),
+                                                   a.complement(&win, ex)));
+        Region c(a), d(a);
+        CPPUNIT_ASSERT_MESSAGE(msg.str(), sameRbos(c.clip(win), d.clip(win, ex)));
+        // small Regions are processed serially
+        Region const e = randomRegion();
+        CPPUNIT_ASSERT(sameRbos(e.unions(a), e.unions(a, ex)));
+        CPPUNIT_ASSERT(sameRbos(e.intersect(a), e.intersect(a, ex)));
+        CPPUNIT_ASSERT(sameRbos(e.complement(0), e.complement(0, ex)));
+    }
+}
+
+void
+RegionSetTest::testMappedRegion()
+{
+    char const * const fn[] = { "test_region_set_a.rgn", "test_region_set_b.rgn" };
+    for (int i = 0; i < testIterations; ++i) {
+        Region const a = randomLargeRegion().translate(PointN16(-600, -600)),
+            b = randomRegion();
+        MappedRegion::save(a, fn[0]);
+        MappedRegion::save(b, fn[1]);
+        MappedRegion const ma(fn[0]), mb(fn[1]);
+        CPPUNIT_ASSERT(ma.validate() && mb.validate());
+        CPPUNIT_ASSERT(sameRbos(a, ma.region()));
+        CPPUNIT_ASSERT(a.boundingBox() == ma.boundingBox());
+
+        CPPUNIT_ASSERT(sameRbos(a.unions(b), ma.unions(b)));
+        CPPUNIT_ASSERT(sameRbos(a.unions(b), ma.unions(mb)));
+        CPPUNIT_ASSERT(sameRbos(a.intersect(b), ma.intersect(b)));
+        CPPUNIT_ASSERT(sameRbos(a.intersect(b), ma.intersect(mb)));
+        CPPUNIT_ASSERT(sameRbos(a.intersect(b), mb.intersect(ma)));
+
+        WinP const win(rand()%400 - 600, rand()%400 - 600,
+                       rand()%400 - 100, rand()%400 - 100);
+        CPPUNIT_ASSERT(sameRbos(Region(a).clip(win), ma.clip(win)));
+        N32 const y0 = rand()%1300 - 650, y1 = y0 + rand()%100;
+        CPPUNIT_ASSERT(sameRbos(Region(a).clip(WinP(-700, y0, 700, y1)),
+                                ma.rows(y0, y1)));
+        for (int k = 0; k < 1000; ++k) {
+            PointN16 const pt(rand()%1300 - 650, rand()%1300 - 650);
+            CPPUNIT_ASSERT_EQUAL(a.includes(pt), ma.includes(pt));
+        }
+    }
+
+    MappedRegion::save(Region(), fn[0]);
+    MappedRegion const empty(fn[0]);
+    CPPUNIT_ASSERT(empty.empty() && empty.validate());
+    CPPUNIT_ASSERT(empty.region().empty());
+    CPPUNIT_ASSERT_THROW(empty.boundingBox(), EmptyRegionError);
+
+    // a truncated file
+    {
+        ofstream os(fn[1], ios::binary | ios::trunc);
+        os << "IPLREGN\n";
+    }
+    CPPUNIT_ASSERT_THROW(MappedRegion m(fn[1]), IoError);
+    CPPUNIT_ASSERT_THROW(MappedRegion m("test_region_set_none.rgn"), IoError);
+    remove(fn[0]);
+    remove(fn[1]);
+}
+
+void
+RegionSetTest::testPackedRegion()
+{
+    Region const B(Circle(PointF64(2, -3), 4));
+    for (int i = 0; i < testIterations; ++i) {
+        Region const a = randomLargeRegion().translate(PointN16(-600, -600)),
+            b = randomRegion();
+        PackedRegion const pa(a), pb(b);
+        CPPUNIT_ASSERT(pa.validate() && pb.validate());
+        CPPUNIT_ASSERT(sameRbos(a, pa.region()));
+        CPPUNIT_ASSERT(sameRbos(b, pb.region()));
+        // a union of circles packs about 6x
+        CPPUNIT_ASSERT(pa.size() * 5 < a.nrRbos() * sizeof(Rbo));
+        CPPUNIT_ASSERT_EQUAL(a.nrRbos(), N32(distance(pa.begin(), pa.end())));
+
+        CPPUNIT_ASSERT(sameRbos(a.unions(b), pa.unions(b)));
+        CPPUNIT_ASSERT(sameRbos(a.unions(b), pb.unions(a)));
+        CPPUNIT_ASSERT(sameRbos(a.intersect(b), pa.intersect(b)));
+        CPPUNIT_ASSERT(sameRbos(a.intersect(b), pb.intersect(a)));
+        CPPUNIT_ASSERT(sameRbos(a.erode2cut(B), pa.erode(B)));
+        CPPUNIT_ASSERT(sameRbos(b.erode2cut(B), pb.erode(B)));
+
+        N32 const y0 = rand()%1300 - 650, y1 = y0 + rand()%100;
+        CPPUNIT_ASSERT(sameRbos(Region(a).clip(WinP(-700, y0, 700, y1)),
+                                pa.rows(y0, y1)));
+        for (int k = 0; k < 1000; ++k) {
+            PointN16 const pt(rand()%1300 - 650, rand()%1300 - 650);
+            CPPUNIT_ASSERT_EQUAL(a.includes(pt), pa.includes(pt));
+        }
+    }
+
+    PackedRegion const empty = PackedRegion(Region());
+    CPPUNIT_ASSERT(empty.empty() && empty.validate());
+    CPPUNIT_ASSERT(empty.begin() == empty.end());
+    CPPUNIT_ASSERT(empty.unions(B).nrRbos() == B.nrRbos());
+    CPPUNIT_ASSERT(empty.intersect(B).empty());
+    CPPUNIT_ASSERT_THROW(empty.boundingBox(), EmptyRegionError);
+}
+
+void
+RegionSetTest::testHybridRegion()
+{
+    for (int i = 0; i < testIterations; ++i) {
+        PictImg<UN8> const img = randomNoise();
+        Region const noise(img, 128, 255),
+            a = randomRegion().unions(noise),
+            b = i % 2 ? randomRegion() : Region(randomNoise(), 0, 100);
+        HybridRegion const ha(a), hb(b), hn(img, 128, 255);
+        CPPUNIT_ASSERT(ha.validate() && hb.validate() && hn.validate());
+        CPPUNIT_ASSERT(sameRbos(a, ha.region()));
+        CPPUNIT_ASSERT(sameRbos(noise, hn.region()));
+        CPPUNIT_ASSERT_EQUAL(area(a), ha.area());
+        if (noise.nrRbos() > 1000)
+            CPPUNIT_ASSERT(hn.nrBitmapRows() > 0 && hn.size() < noise.nrRbos() * sizeof(Rbo));
+
+        CPPUNIT_ASSERT(sameRbos(a.unions(b), ha.unions(hb).region()));
+        CPPUNIT_ASSERT(sameRbos(a.intersect(b), ha.intersect(hb).region()));
+        CPPUNIT_ASSERT(sameRbos(a.subtract(b), ha.subtract(hb).region()));
+        CPPUNIT_ASSERT(sameRbos(b.subtract(a), hb.subtract(ha).region()));
+        CPPUNIT_ASSERT(sameRbos(b.intersect(noise), hb.intersect(hn).region()));
+        // an empty range, although pixels equal both bounds
+        N32 const hi = rand()%255;
+        HybridRegion const hempty(img, hi + 1, hi);
+        CPPUNIT_ASSERT(hempty.validate());
+        CPPUNIT_ASSERT(sameRbos(Region(img, hi + 1, hi), hempty.region()));
+        CPPUNIT_ASSERT_EQUAL(0, hempty.area());
+        for (int k = 0; k < 1000; ++k) {
+            PointN16 const pt(rand()%700 - 50, rand()%300 - 50);
+            CPPUNIT_ASSERT_EQUAL(a.includes(pt), ha.includes(pt));
+        }
+    }
+    HybridRegion const empty;
+    CPPUNIT_ASSERT(empty.empty() && empty.region().empty());
+    CPPUNIT_ASSERT(empty.unions(empty).empty());
+}
+
+void
+RegionSetTest::testBlobs()
+{
+    Executor ex(4);
+    for (int i = 0; i < testIterations / 2; ++i) {
+        Region const reg = i % 2 ? randomLargeRegion() : Region(randomNoise(), 160, 255);
+        Blobs::Connectivity const conns[] = { Blobs::Connect4, Blobs::Connect8 };
+        for (auto conn : conns) {
+            Blobs const blobs(reg, conn);
+            CPPUNIT_ASSERT(blobs.validate());
+            CPPUNIT_ASSERT(sameAsFloodFill(blobs, reg, conn));
+            CPPUNIT_ASSERT(sameRbos(reg, Region::unionAll(blobs.begin(), blobs.end())));
+            for (N32 k = 1; k < blobs.size(); ++k)
+                CPPUNIT_ASSERT(*blobs[k - 1].begin() < *blobs[k].begin());
+
+            vector<N32> labels;
+            CPPUNIT_ASSERT_EQUAL(blobs.size(), Blobs::labelRuns(reg, labels, conn, ex));
+            CPPUNIT_ASSERT(labels == blobs.labels());
+            Blobs const parallel(reg, conn, ex);
+            CPPUNIT_ASSERT_EQUAL(blobs.size(), parallel.size());
+
+            if (!blobs.empty()) {
+                Rbo const & r = *blobs[blobs.size() - 1].begin();
+                CPPUNIT_ASSERT_EQUAL(blobs.size() - 1, blobs.find(r.start()));
+            }
+        }
+        CPPUNIT_ASSERT(Blobs(reg, Blobs::Connect4).size() >= Blobs(reg, Blobs::Connect8).size());
+    }
+    // two diagonal pixels
+    Region const diagonal = Region(WinP(0, 0, 0, 0)).unions(Region(WinP(1, 1, 1, 1)));
+    CPPUNIT_ASSERT_EQUAL(2, Blobs(diagonal, Blobs::Connect4).size());
+    CPPUNIT_ASSERT_EQUAL(1, Blobs(diagonal, Blobs::Connect8).size());
+    CPPUNIT_ASSERT_EQUAL(-1, Blobs(diagonal).find(PointN16(1, 0)));
+    CPPUNIT_ASSERT(Blobs(Region()).empty());
+}
+
+void
+RegionSetTest::testShapeFeatures()
+{
+    for (int i = 0; i < testIterations / 2; ++i) {
+        Region const reg = i % 2 ? randomRegion() : Region(randomNoise(), 160, 255);
+        if (reg.empty())
+            continue;
+
+        // moments and perimeter pixel by pixel
+        WinP const & bb = reg.boundingBox();
+        F64 a = 0, sx = 0, sy = 0, sxx = 0, sxy = 0, syy = 0, perimeter = 0;
+        for (N16 y = bb.upperLeft().y_; y <= bb.lowerRight().y_; ++y)
+            for (N16 x = bb.upperLeft().x_; x <= bb.lowerRight().x_; ++x) {
+                if (!reg.includes(PointN16(x, y)))
+                    continue;
+                a += 1;
+                sx += x;
+                sy += y;
+                sxx += F64(x) * x;
+                sxy += F64(x) * y;
+                syy += F64(y) * y;
+                PointN16 const nb[] = { PointN16(x - 1, y), PointN16(x + 1, y),
+                                        PointN16(x, y - 1), PointN16(x, y + 1) };
+                for (auto & pt : nb)
+                    perimeter += reg.includes(pt) ? 0 : 1;
+            }
+        PointF64 center;
+        CPPUNIT_ASSERT_EQUAL(N32(a), reg.areaCenter(center));
+        CPPUNIT_ASSERT_EQUAL(area(reg), reg.area());
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(sx / a, center.x_, 1e-9);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(sy / a, center.y_, 1e-9);
+        CPPUNIT_ASSERT_EQUAL(perimeter, reg.perimeter());
+
+        Region::Moments const mom = reg.moments();
+        CPPUNIT_ASSERT_EQUAL(N32(a), mom.area_);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(sxx / a - center.x_ * center.x_, mom.m20_, 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(sxy / a - center.x_ * center.y_, mom.m11_, 1e-6);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(syy / a - center.y_ * center.y_, mom.m02_, 1e-6);
+        CPPUNIT_ASSERT(mom.majorRadius() >= mom.minorRadius());
+
+        // Euler number: components minus the holes, which are the components
+        // of the complement without the outer one
+        WinP const universe(bb.upperLeft().x_ - 1, bb.upperLeft().y_ - 1,
+                            bb.lowerRight().x_ + 1, bb.lowerRight().y_ + 1);
+        Region const background = reg.complement(&universe);
+        CPPUNIT_ASSERT_EQUAL(Blobs(reg, Blobs::Connect8).size()
+                             - Blobs(background, Blobs::Connect4).size() + 1,
+                             reg.eulerNumber(Blobs::Connect8));
+        CPPUNIT_ASSERT_EQUAL(Blobs(reg, Blobs::Connect4).size()
+                             - Blobs(background, Blobs::Connect8).size() + 1,
+                             reg.eulerNumber(Blobs::Connect4));
+    }
+
+    // a square ring of 8 pixels, its moments and translation invariance
+    Region const ring = Region(WinP(0, 0, 2, 2)).subtract(Region(WinP(1, 1, 1, 1)));
+    CPPUNIT_ASSERT_EQUAL(8, ring.area());
+    CPPUNIT_ASSERT_EQUAL(16.0, ring.perimeter());
+    CPPUNIT_ASSERT_EQUAL(0, ring.eulerNumber());
+    CPPUNIT_ASSERT_EQUAL(PointF64(1, 1), ring.center());
+    Region const moved = ring.getTranslate(PointN16(20000, -30000));
+    CPPUNIT_ASSERT_EQUAL(PointF64(20001, -29999), moved.center());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.75, moved.moments().m20_, 1e-12);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, moved.moments().m11_, 1e-12);
+
+    Region rect(WinP(0, 0, 9, 1));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, rect.moments().orientation(), 1e-12);
+    CPPUNIT_ASSERT_EQUAL(20, rect.area());
+    rect.add(Rbo(PointN16(0, 3), 5));
+    CPPUNIT_ASSERT_EQUAL(25, rect.area());
+    CPPUNIT_ASSERT_EQUAL(2, rect.eulerNumber());
+
+    CPPUNIT_ASSERT_EQUAL(0, Region().area());
+    CPPUNIT_ASSERT_EQUAL(0.0, Region().perimeter());
+    CPPUNIT_ASSERT_EQUAL(0, Region().eulerNumber());
+    CPPUNIT_ASSERT_THROW(Region().center(), EmptyRegionError);
+    CPPUNIT_ASSERT_THROW(Region().moments(), EmptyRegionError);
+    CPPUNIT_ASSERT_THROW(ring.eulerNumber(6), ParameterError);
+}
+
+void
+RegionSetTest::testAttributeFilters()
+{
+    for (int i = 0; i < testIterations / 2; ++i) {
+        Region const reg = i % 2 ? randomLargeRegion() : Region(randomNoise(), 100, 255);
+        N32 const minArea = rand()%20 + 1;
+        Blobs::Connectivity const conns[] = { Blobs::Connect4, Blobs::Connect8 };
+        for (auto conn : conns) {
+            Blobs const blobs(reg, conn);
+            vector<Region> large, wide, elongated;
+            for (auto & b : blobs) {
+                if (b.area() >= minArea)
+                    large.push_back(b);
+                if (b.boundingBox().width() >= 3 && b.boundingBox().height() <= 2)
+                    wide.push_back(b);
+                // many small blobs have an elongation of exactly 0.5
+                F64 const elongation = b.shapeFeature(Region::ShapeFeatureElongation);
+                Region::Moments const mom = b.moments();
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(mom.majorRadius() > 0
+                                             ? 1 - mom.minorRadius() / mom.majorRadius() : 0,
+                                             elongation, 1e-9);
+                if (elongation >= 0.5 && elongation <= 1)
+                    elongated.push_back(b);
+            }
+            CPPUNIT_ASSERT(sameRbos(Region::unionAll(large.begin(), large.end()),
+                                    reg.areaOpen(minArea, conn)));
+            CPPUNIT_ASSERT(sameRbos(Region::unionAll(wide.begin(), wide.end()),
+                                    reg.selectShape(Region::ShapeFeatureWidth, 3, 1e9, conn)
+                                    .selectShape(Region::ShapeFeatureHeight, 0, 2, conn)));
+            CPPUNIT_ASSERT(sameRbos(Region::unionAll(elongated.begin(), elongated.end()),
+                                    reg.selectShape(Region::ShapeFeatureElongation, 0.5, 1, conn)));
+
+            // the filled holes are small components of the complement
+            Region const closed = reg.areaClose(minArea, conn);
+            CPPUNIT_ASSERT(closed.validate());
+            CPPUNIT_ASSERT(sameRbos(reg, reg.intersect(closed)));
+            Blobs::Connectivity const dual = conn == Blobs::Connect8 ? Blobs::Connect4
+                                                                     : Blobs::Connect8;
+            Blobs const filled(closed.subtract(reg), dual);
+            for (auto & h : filled)
+                CPPUNIT_ASSERT(h.area() < minArea);
+            if (reg.empty())
+                continue;
+            WinP const & bb = reg.boundingBox();
+            WinP const universe(bb.upperLeft().x_ - 1, bb.upperLeft().y_ - 1,
+                                bb.lowerRight().x_ + 1, bb.lowerRight().y_ + 1);
+            Blobs const holes(closed.complement(&universe), dual);
+            N32 const outside = holes.find(universe.upperLeft());
+            for (N32 k = 0; k < holes.size(); ++k)
+                CPPUNIT_ASSERT(k == outside || holes[k].area() >= minArea);
+            Region const full = reg.areaClose(numeric_limits<N32>::max(), conn);
+            CPPUNIT_ASSERT_EQUAL(Blobs(full, conn).size(), full.eulerNumber(conn));
+        }
+    }
+    // a ring with a hole of one pixel and a single pixel apart
+    Region const ring = Region(WinP(0, 0, 2, 2)).subtract(Region(WinP(1, 1, 1, 1)))
+        .unions(Region(WinP(5, 0, 5, 0)));
+    CPPUNIT_ASSERT_EQUAL(8, ring.areaOpen(2).area());
+    CPPUNIT_ASSERT_EQUAL(10, ring.areaClose(2).area());
+    CPPUNIT_ASSERT_EQUAL(9, ring.areaClose(1).area());
+    CPPUNIT_ASSERT(ring.areaOpen(10).empty());
+    CPPUNIT_ASSERT(Region().areaClose(10).empty());
+    CPPUNIT_ASSERT_THROW(ring.areaOpen(2, 6), ParameterError);
+    CPPUNIT_ASSERT_EQUAL(3.0, ring.shapeFeature(Region::ShapeFeatureHeight));
+    CPPUNIT_ASSERT_THROW(Region().shapeFeature(Region::ShapeFeatureArea), EmptyRegionError);
+}
+
+void
+RegionSetTest::testLabelledRegion()
+{
+    for (int i = 0; i < testIterations / 2; ++i) {
+        // overlapping and touching rectangles, the earlier ones on top
+        vector<Region> rects;
+        for (int k = 0; k < 8; ++k) {
+            N16 const x = rand()%50, y = rand()%50;
+            rects.push_back(Region(WinP(x, y, x + rand()%15, y + rand()%15)));
+        }
+        LabelledRegion const objs(rects);
+        CPPUNIT_ASSERT(objs.validate());
+        CPPUNIT_ASSERT_EQUAL(N32(rects.size()), objs.nrLabels());
+        CPPUNIT_ASSERT(sameRbos(Region::unionAll(rects.begin(), rects.end()), objs.region()));
+        vector<Region> const parts = objs.split();
+        for (size_t k = 0; k < rects.size(); ++k)
+            CPPUNIT_ASSERT(sameRbos(rects[k].subtract(Region::unionAll(rects.begin(), rects.begin() + k)),
+                                    parts[k]));
+
+        Region const B = i % 2 ? Region::generateStructuringElement(Region::StructuringElementDiamond, 2)
+            : Region(WinP(-1, 0, 2, 1));
+        vector<Region> dilated, eroded;
+        for (auto & p : parts) {
+            dilated.push_back(p.dilate(B));
+            eroded.push_back(p.erode2cut(B));
+        }
+        LabelledRegion::Conflict const conflicts[] = { LabelledRegion::ConflictSeparate,
+                                                       LabelledRegion::ConflictLowestLabel };
+        for (auto conflict : conflicts) {
+            LabelledRegion const res = objs.dilate(B, conflict);
+            CPPUNIT_ASSERT(res.validate());
+            vector<Region> const resParts = res.split();
+            for (N16 y = -5; y < 75; ++y)
+                for (N16 x = -5; x < 75; ++x) {
+                    PointN16 const pt(x, y);
+                    CPPUNIT_ASSERT_EQUAL(dilatedOwner(parts, dilated, pt, conflict),
+                                         labelAt(resParts, pt));
+                }
+        }
+        LabelledRegion const res = objs.erode(B);
+        CPPUNIT_ASSERT(res.validate());
+        for (size_t k = 0; k < parts.size(); ++k)
+            CPPUNIT_ASSERT(sameRbos(eroded[k], res.region(k)));
+
+        // the blobs of a noisy picture
+        Region const reg(randomNoise(), 100, 255);
+        Blobs const blobs(reg, Blobs::Connect4);
+        LabelledRegion const labelled(blobs);
+        CPPUNIT_ASSERT(sameRbos(reg, labelled.region()));
+        CPPUNIT_ASSERT_EQUAL(blobs.size(), labelled.nrLabels());
+        for (N32 k = 0; k < blobs.size(); ++k)
+            CPPUNIT_ASSERT(sameRbos(blobs[k], labelled.region(k)));
+    }
+    // two touching squares stay apart
+    vector<Region> squares;
+    squares.push_back(Region(WinP(0, 0, 4, 4)));
+    squares.push_back(Region(WinP(5, 0, 9, 4)));
+    LabelledRegion const touching(squares);
+    Region const B(WinP(-1, -1, 1, 1));
+    CPPUNIT_ASSERT_EQUAL(N32(10), touching.nrRbos());
+    CPPUNIT_ASSERT(sameRbos(Region(WinP(1, 1, 3, 3)), touching.erode(B).region(0)));
+    // the corners reached by both are left out
+    CPPUNIT_ASSERT(sameRbos(Region(WinP(-1, -1, 3, 5)).unions(Region(WinP(4, 0, 4, 4))),
+                            touching.dilate(B).region(0)));
+    CPPUNIT_ASSERT(sameRbos(Region(WinP(6, -1, 10, 5)).unions(Region(WinP(5, 0, 5, 4))),
+                            touching.dilate(B).region(1)));
+    CPPUNIT_ASSERT(sameRbos(Region(WinP(-1, -1, 5, 5)).subtract(Region(WinP(5, 0, 5, 4))),
+                            touching.dilate(B, LabelledRegion::ConflictLowestLabel).region(0)));
+    CPPUNIT_ASSERT(touching.erode(Region()).labels() == touching.labels());
+    CPPUNIT_ASSERT(LabelledRegion().dilate(B).empty());
+}
+
+int test_region_set(int, char*[])
+{
+    std::ofstream of("test_region_set.xml");
+    CppUnit::TextTestRunner runner;
+    if (localTesting()) {
+        runner.setOutputter(new CppUnit::CompilerOutputter(&runner.result(),
+                                                           std::cerr));
+    } else {
+        runner.setOutputter(new CppUnit::XmlOutputter(&runner.result(), of));
+    }
+    runner.addTest(RegionSetTest::suite());
+    return runner.run() ? 0 : 1;
+}